@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "annealing_solver.h"
+
+namespace sdkg {
+
+    namespace {
+        typedef uint64_t mask_t;
+        typedef std::chrono::steady_clock steady_clock;
+
+        /// One thread's search state.
+        class Annealer {
+            private:
+                short m_n, m_box;
+                vector<uint8_t> m_cells;             //!< Row-major values.
+                vector<bool> m_fixed;                //!< Givens and forced locations.
+                vector<vector<int>> m_free;          //!< Free locations of every box.
+                vector<uint16_t> m_row_count;        //!< # of each digit per row, [row * (n + 1) + digit].
+                vector<uint16_t> m_col_count;        //!< Same per column.
+                int m_cost = 0;
+                std::mt19937_64 m_rng;
+                bool m_consistent = true;
+
+                inline short line_of( int cell ) const { return (short) (cell / m_n); }
+                inline short column_of( int cell ) const { return (short) (cell % m_n); }
+                inline uint16_t & row_count( short line, short digit ) { return m_row_count[line * (m_n + 1) + digit]; }
+                inline uint16_t & col_count( short column, short digit ) { return m_col_count[column * (m_n + 1) + digit]; }
+
+                /// Fixes the locations with a single candidate (naked singles) and the digits with a single
+                /// location left in a unit (hidden singles), until neither applies.
+                void propagate() {
+                    mask_t all = m_n == 64 ? ~mask_t{0} : (mask_t{1} << m_n) - 1;
+                    vector<mask_t> rows(m_n), cols(m_n), boxes(m_n);
+                    auto box_of = [this](int cell) { return (line_of(cell) / m_box) * m_box + column_of(cell) / m_box; };
+                    auto fix = [&](int cell, mask_t bit) {
+                        m_cells[cell] = (uint8_t) (__builtin_ctzll(bit) + 1);
+                        m_fixed[cell] = true;
+                        rows[line_of(cell)] |= bit;
+                        cols[column_of(cell)] |= bit;
+                        boxes[box_of(cell)] |= bit;
+                    };
+                    for (int cell{0}; cell < m_n * m_n; cell++) {
+                        if (m_cells[cell] == 0) continue;
+                        mask_t bit = mask_t{1} << (m_cells[cell] - 1);
+                        if ((rows[line_of(cell)] | cols[column_of(cell)] | boxes[box_of(cell)]) & bit) m_consistent = false;
+                        fix(cell, bit);
+                    }
+                    // cells of every unit: rows, columns, then boxes
+                    vector<vector<int>> units(3 * m_n);
+                    for (int cell{0}; cell < m_n * m_n; cell++) {
+                        units[line_of(cell)].push_back(cell);
+                        units[m_n + column_of(cell)].push_back(cell);
+                        units[2 * m_n + box_of(cell)].push_back(cell);
+                    }
+                    vector<mask_t> cand(m_n * m_n);
+                    for (bool changed = true; changed and m_consistent; ) {
+                        changed = false;
+                        for (int cell{0}; cell < m_n * m_n and m_consistent; cell++) {
+                            cand[cell] = 0;
+                            if (m_cells[cell] != 0) continue;
+                            cand[cell] = all & ~(rows[line_of(cell)] | cols[column_of(cell)] | boxes[box_of(cell)]);
+                            if (cand[cell] == 0) m_consistent = false;
+                            else if ((cand[cell] & (cand[cell] - 1)) == 0) {
+                                fix(cell, cand[cell]);
+                                changed = true;
+                            }
+                        }
+                        if (changed) continue;
+                        for (const vector<int> &unit : units) {
+                            // digits seen once and more than once among the unit's candidates
+                            mask_t once = 0, twice = 0;
+                            for (int cell : unit) {
+                                twice |= once & cand[cell];
+                                once |= cand[cell];
+                            }
+                            for (mask_t single = once & ~twice; single; single &= single - 1) {
+                                mask_t bit = single & -single;
+                                for (int cell : unit) {
+                                    if (m_cells[cell] != 0 or not (cand[cell] & bit)) continue;
+                                    if (m_fixed[cell]) continue;
+                                    fix(cell, bit);
+                                    changed = true;
+                                }
+                            }
+                            if (changed) break;     // candidates are stale now
+                        }
+                    }
+                }
+
+                /// Fills the free locations of every box with a random permutation of its missing digits.
+                void random_fill() {
+                    for (short b{0}; b < m_n; b++) {
+                        vector<bool> present(m_n + 1);
+                        int top = (b / m_box) * m_box, left = (b % m_box) * m_box;
+                        for (int k{0}; k < m_n; k++) {
+                            int cell = (top + k / m_box) * m_n + left + k % m_box;
+                            if (m_fixed[cell]) present[m_cells[cell]] = true;
+                        }
+                        vector<uint8_t> missing;
+                        for (short d{1}; d <= m_n; d++) if (not present[d]) missing.push_back((uint8_t) d);
+                        std::shuffle(missing.begin(), missing.end(), m_rng);
+                        // a box with clashing givens has fewer free locations than missing digits
+                        for (size_t k{0}; k < m_free[b].size(); k++) m_cells[m_free[b][k]] = k < missing.size() ? missing[k] : 1;
+                    }
+                    std::fill(m_row_count.begin(), m_row_count.end(), 0);
+                    std::fill(m_col_count.begin(), m_col_count.end(), 0);
+                    for (int cell{0}; cell < m_n * m_n; cell++) {
+                        row_count(line_of(cell), m_cells[cell])++;
+                        col_count(column_of(cell), m_cells[cell])++;
+                    }
+                    m_cost = 0;
+                    for (short i{0}; i < m_n; i++) {
+                        for (short d{1}; d <= m_n; d++) m_cost += (row_count(i, d) == 0) + (col_count(i, d) == 0);
+                    }
+                }
+
+                /// Cost change of moving `from` out of and `to` into a unit, given its counts.
+                static inline int unit_delta( uint16_t from_count, uint16_t to_count ) {
+                    return (from_count == 1 ? 1 : 0) - (to_count == 0 ? 1 : 0);
+                }
+
+                int swap_delta( int a, int b ) {
+                    short va = m_cells[a], vb = m_cells[b];
+                    short la = line_of(a), lb = line_of(b), ca = column_of(a), cb = column_of(b);
+                    int delta = 0;
+                    if (la != lb) {
+                        delta += unit_delta(row_count(la, va), row_count(la, vb));
+                        delta += unit_delta(row_count(lb, vb), row_count(lb, va));
+                    }
+                    if (ca != cb) {
+                        delta += unit_delta(col_count(ca, va), col_count(ca, vb));
+                        delta += unit_delta(col_count(cb, vb), col_count(cb, va));
+                    }
+                    return delta;
+                }
+
+                void apply_swap( int a, int b, int delta ) {
+                    short va = m_cells[a], vb = m_cells[b];
+                    short la = line_of(a), lb = line_of(b), ca = column_of(a), cb = column_of(b);
+                    row_count(la, va)--; row_count(la, vb)++;
+                    row_count(lb, vb)--; row_count(lb, va)++;
+                    col_count(ca, va)--; col_count(ca, vb)++;
+                    col_count(cb, vb)--; col_count(cb, va)++;
+                    m_cells[a] = (uint8_t) vb;
+                    m_cells[b] = (uint8_t) va;
+                    m_cost += delta;
+                }
+
+                /// Picks two free locations of a random box with at least two of them.
+                bool random_pair( const vector<short> &boxes, int &a, int &b ) {
+                    const vector<int> &free = m_free[boxes[m_rng() % boxes.size()]];
+                    size_t i = m_rng() % free.size(), j = m_rng() % (free.size() - 1);
+                    if (j >= i) j++;
+                    a = free[i];
+                    b = free[j];
+                    return true;
+                }
+
+            public:
+                Annealer( const LargeBoard &puzzle, uint64_t seed )
+                    : m_n{puzzle.size()}, m_box{puzzle.box()}, m_cells(puzzle.cells()), m_fixed(puzzle.cells()),
+                      m_free(puzzle.size()), m_row_count((size_t) m_n * (m_n + 1)), m_col_count((size_t) m_n * (m_n + 1)),
+                      m_rng{seed} {
+                    for (int cell{0}; cell < m_n * m_n; cell++) {
+                        m_cells[cell] = (uint8_t) puzzle.at(line_of(cell), column_of(cell));
+                        m_fixed[cell] = m_cells[cell] != 0;
+                    }
+                    propagate();
+                    for (int cell{0}; cell < m_n * m_n; cell++) {
+                        if (not m_fixed[cell]) m_free[puzzle.box_of(line_of(cell), column_of(cell))].push_back(cell);
+                    }
+                }
+
+                /// Anneals until solved, `stop` is set or the deadline passes. Returns true if solved.
+                bool run( const AnnealingSolver::Options &opt, const std::atomic<bool> &stop, steady_clock::time_point deadline,
+                          size_t &moves, size_t &restarts, vector<uint8_t> &best_cells, int &best_cost ) {
+                    vector<short> movable;
+                    size_t n_free = 0;
+                    for (short b{0}; b < m_n; b++) {
+                        if (m_free[b].size() >= 2) movable.push_back(b);
+                        n_free += m_free[b].size();
+                    }
+                    random_fill();
+                    best_cells = m_cells;
+                    best_cost = m_cost;
+                    if (m_cost == 0 or movable.empty() or not m_consistent) return m_cost == 0 and m_consistent;
+
+                    size_t chain = std::max<size_t>(n_free * n_free / 4, 1000);
+                    std::uniform_real_distribution<double> unit{ 0.0, 1.0 };
+                    while (true) {
+                        // starting temperature: spread of the cost changes of random moves
+                        double sum = 0, sum_sq = 0;
+                        int a, b;
+                        for (int k{0}; k < 200; k++) {
+                            random_pair(movable, a, b);
+                            double d = swap_delta(a, b);
+                            sum += d;
+                            sum_sq += d * d;
+                        }
+                        double temperature = std::max(std::sqrt(std::max(sum_sq / 200 - (sum / 200) * (sum / 200), 0.0)), 0.5);
+                        int run_best = m_cost;
+                        size_t stale = 0;
+                        while (stale < opt.stale_chains) {
+                            for (size_t k{0}; k < chain; k++) {
+                                random_pair(movable, a, b);
+                                int delta = swap_delta(a, b);
+                                if (delta <= 0 or unit(m_rng) < std::exp(-delta / temperature)) {
+                                    apply_swap(a, b, delta);
+                                    if (m_cost < best_cost) {
+                                        best_cost = m_cost;
+                                        best_cells = m_cells;
+                                        if (m_cost == 0) {
+                                            moves += k + 1;
+                                            return true;
+                                        }
+                                    }
+                                }
+                            }
+                            moves += chain;
+                            if (stop.load(std::memory_order_relaxed) or steady_clock::now() >= deadline) return false;
+                            stale = m_cost < run_best ? 0 : stale + 1;
+                            run_best = std::min(run_best, m_cost);
+                            temperature *= opt.cooling;
+                        }
+                        // stuck in a local minimum: start over
+                        restarts++;
+                        random_fill();
+                    }
+                }
+        };
+    }
+
+    AnnealingSolver::AnnealingSolver(const LargeBoard &puzzle, const Options &opt) : m_puzzle{puzzle}, m_opt{opt} {}
+
+    AnnealingSolver::Result AnnealingSolver::solve() const {
+        unsigned threads = m_opt.threads != 0 ? m_opt.threads : std::max(1u, std::thread::hardware_concurrency());
+        auto start = steady_clock::now();
+        auto deadline = start + std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(m_opt.time_limit));
+        std::atomic<bool> stop{ false };
+        std::mutex mutex;
+        Result result;
+        result.board = m_puzzle;
+
+        auto search = [&](unsigned t) {
+            Annealer annealer{ m_puzzle, m_opt.seed + t };
+            size_t moves = 0, restarts = 0;
+            vector<uint8_t> best;
+            int best_cost = 0;
+            bool solved = annealer.run(m_opt, stop, deadline, moves, restarts, best, best_cost);
+            if (solved) stop = true;
+            std::lock_guard<std::mutex> lock(mutex);
+            result.moves += moves;
+            result.restarts += restarts;
+            if (result.solved or (result.cost >= 0 and best_cost >= result.cost)) return;
+            result.solved = solved;
+            result.cost = best_cost;
+            short n = m_puzzle.size();
+            for (int cell{0}; cell < n * n; cell++) result.board.set((short) (cell / n), (short) (cell % n), best[cell]);
+        };
+
+        vector<std::thread> workers;
+        for (unsigned t{1}; t < threads; t++) workers.emplace_back(search, t);
+        search(0);
+        for (std::thread &worker : workers) worker.join();
+        result.seconds = std::chrono::duration<double>(steady_clock::now() - start).count();
+        // a zero cost board with clashing givens is not a solution
+        result.solved = result.solved and result.board.is_solved();
+        return result;
+    }
+}
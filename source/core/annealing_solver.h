@@ -0,0 +1,65 @@
+#ifndef SUDOKU_ANNEALING_SOLVER_H
+#define SUDOKU_ANNEALING_SOLVER_H
+#include <cstddef>
+#include <cstdint>
+#include "large_board.h"
+
+/*!
+ *  Stochastic local search for large boards (16x16, 25x25 and beyond), where
+ *  exhaustive backtracking blows up.
+ *
+ *  The givens, plus the locations they force (naked singles), stay fixed.
+ *  Every box is filled with a permutation of its missing digits, so boxes are
+ *  always correct; the cost is the number of digits missing from the rows and
+ *  columns, and a move swaps two free locations of a box. Keeping one count
+ *  per (row, digit) and (column, digit) makes the cost change of a swap a few
+ *  lookups on at most two rows and two columns.
+ *
+ *  Moves follow a simulated annealing schedule: worse moves are accepted with
+ *  probability `exp(-delta / T)`, and T shrinks by `cooling` after each chain
+ *  of moves. A run whose best cost does not improve for `stale_chains` chains
+ *  starts over from a new random fill. Every thread runs independent restarts
+ *  with its own seed; the first one reaching cost 0 stops the others.
+ *
+ *  How to use it:
+ *  ```c++
+ *      AnnealingSolver::Options opt;
+ *      opt.time_limit = 30;
+ *      AnnealingSolver::Result r = AnnealingSolver(puzzle, opt).solve();
+ *      if (r.solved) use(r.board);
+ *  ```
+ */
+
+namespace sdkg {
+
+    class AnnealingSolver {
+        public:
+            struct Options {
+                unsigned threads = 0;           //!< Independent searches, 0 = one per core.
+                double time_limit = 10;         //!< Seconds before giving up.
+                double cooling = 0.99;          //!< Temperature factor applied after each chain.
+                size_t stale_chains = 80;       //!< Chains without a new best cost before restarting.
+                uint64_t seed = 1;              //!< Thread `t` searches with seed + t.
+            };
+
+            struct Result {
+                bool solved = false;
+                LargeBoard board;               //!< The solution, or the best board found.
+                int cost = -1;                  //!< Digits missing from rows and columns in `board`, 0 if solved.
+                size_t moves = 0;               //!< Swaps evaluated, all threads together.
+                size_t restarts = 0;            //!< Fresh fills after stalling, all threads together.
+                double seconds = 0;
+            };
+
+        private:
+            LargeBoard m_puzzle;
+            Options m_opt;
+
+        public:
+            AnnealingSolver( const LargeBoard &puzzle, const Options &opt );
+
+            Result solve() const;
+    };
+}
+
+#endif //SUDOKU_ANNEALING_SOLVER_H
@@ -0,0 +1,162 @@
+#include <cstring>
+#include "batch_validator.h"
+#include "board_geometry.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SDKG_X86 1
+#endif
+
+namespace sdkg {
+
+    namespace {
+        constexpr short N_CELLS{ BoardGeometry::N_CELLS };
+        constexpr short N_UNITS{ BoardGeometry::N_UNITS };
+        constexpr uint16_t ALL_DIGITS{ 0x3FE };
+
+        /// Writes, per lane, the OR of the repeated digits and a non-zero value if some unit misses a digit.
+        typedef void (*kernel_t)( const BatchValidator::Lanes &, uint16_t *, uint16_t * );
+
+        void kernel_scalar(const BatchValidator::Lanes &lanes, uint16_t *dup, uint16_t *missing) {
+            uint16_t acc[BatchValidator::LANES];
+            std::memset(dup, 0, BatchValidator::LANES * sizeof(uint16_t));
+            std::memset(missing, 0, BatchValidator::LANES * sizeof(uint16_t));
+            for (short u{0}; u < N_UNITS; u++) {
+                std::memset(acc, 0, sizeof acc);
+                for (short k{0}; k < Config::SB_SIZE; k++) {
+                    const uint16_t *m = lanes.cells[GEOMETRY.units[u][k]];
+                    for (size_t l{0}; l < BatchValidator::LANES; l++) {
+                        dup[l] |= acc[l] & m[l];
+                        acc[l] |= m[l];
+                    }
+                }
+                for (size_t l{0}; l < BatchValidator::LANES; l++) missing[l] |= acc[l] ^ ALL_DIGITS;
+            }
+        }
+
+#ifdef SDKG_X86
+        __attribute__((target("avx2")))
+        void kernel_avx2(const BatchValidator::Lanes &lanes, uint16_t *dup, uint16_t *missing) {
+            const __m256i all_digits = _mm256_set1_epi16((short) ALL_DIGITS);
+            for (size_t half{0}; half < BatchValidator::LANES; half += 16) {
+                __m256i v_dup = _mm256_setzero_si256(), v_missing = _mm256_setzero_si256();
+                for (short u{0}; u < N_UNITS; u++) {
+                    __m256i acc = _mm256_setzero_si256();
+                    for (short k{0}; k < Config::SB_SIZE; k++) {
+                        __m256i m = _mm256_load_si256((const __m256i *) &lanes.cells[GEOMETRY.units[u][k]][half]);
+                        v_dup = _mm256_or_si256(v_dup, _mm256_and_si256(acc, m));
+                        acc = _mm256_or_si256(acc, m);
+                    }
+                    v_missing = _mm256_or_si256(v_missing, _mm256_xor_si256(acc, all_digits));
+                }
+                _mm256_storeu_si256((__m256i *) (dup + half), v_dup);
+                _mm256_storeu_si256((__m256i *) (missing + half), v_missing);
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void kernel_avx512(const BatchValidator::Lanes &lanes, uint16_t *dup, uint16_t *missing) {
+            const __m512i all_digits = _mm512_set1_epi16((short) ALL_DIGITS);
+            __m512i v_dup = _mm512_setzero_si512(), v_missing = _mm512_setzero_si512();
+            for (short u{0}; u < N_UNITS; u++) {
+                __m512i acc = _mm512_setzero_si512();
+                for (short k{0}; k < Config::SB_SIZE; k++) {
+                    __m512i m = _mm512_load_si512((const void *) lanes.cells[GEOMETRY.units[u][k]]);
+                    v_dup = _mm512_or_si512(v_dup, _mm512_and_si512(acc, m));
+                    acc = _mm512_or_si512(acc, m);
+                }
+                v_missing = _mm512_or_si512(v_missing, _mm512_xor_si512(acc, all_digits));
+            }
+            _mm512_storeu_si512((void *) dup, v_dup);
+            _mm512_storeu_si512((void *) missing, v_missing);
+        }
+#endif
+
+        struct Kernel {
+            kernel_t run;
+            const char *name;
+        };
+
+        const Kernel & kernel() {
+            static const Kernel picked = []() -> Kernel {
+#ifdef SDKG_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) return { kernel_avx512, "avx512" };
+                if (__builtin_cpu_supports("avx2")) return { kernel_avx2, "avx2" };
+#endif
+                return { kernel_scalar, "scalar" };
+            }();
+            return picked;
+        }
+
+        /// Digit bit of every byte value, 0 for empty and out of range values.
+        struct MaskTable {
+            uint16_t mask[256];
+            uint8_t out_of_range[256];
+        };
+
+        constexpr MaskTable make_mask_table() {
+            MaskTable t{};
+            for (int v{0}; v < 256; v++) {
+                auto value = (int8_t) v;
+                bool in_range = value >= 0 and value <= Config::SUDOKU_BIGGEST_NUM;
+                t.mask[v] = in_range ? (uint16_t) ((1u << value) & ALL_DIGITS) : 0;
+                t.out_of_range[v] = in_range ? 0 : 1;
+            }
+            return t;
+        }
+
+        constexpr MaskTable MASKS = make_mask_table();
+    }
+
+    const char * BatchValidator::kernel_name() {
+        return kernel().name;
+    }
+
+    BatchValidator::Result BatchValidator::validate(const Lanes &lanes, size_t n) {
+        alignas(64) uint16_t dup[LANES], missing[LANES];
+        kernel().run(lanes, dup, missing);
+        Result result;
+        for (size_t l{0}; l < n; l++) {
+            if (dup[l] != 0 or (lanes.out_of_range >> l) & 1u) continue;
+            result.consistent |= 1u << l;
+            if (missing[l] == 0) result.complete |= 1u << l;
+        }
+        return result;
+    }
+
+    BatchValidator::Result BatchValidator::validate(const SBoard *boards, size_t n) {
+        Lanes lanes;
+        if (n > LANES) n = LANES;
+        if (n < LANES) std::memset(lanes.cells, 0, sizeof lanes.cells);
+        for (size_t l{0}; l < n; l++) {
+            uint8_t bad = 0;
+            for (short k{0}; k < N_CELLS; k++) {
+                short value = boards[l].at(GEOMETRY.line[k], GEOMETRY.column[k]);
+                // values that do not fit a byte are out of range as well
+                auto byte = (uint8_t) ((value < -128 or value > 127) ? 0x80 : value);
+                lanes.cells[k][l] = MASKS.mask[byte];
+                bad |= MASKS.out_of_range[byte];
+            }
+            lanes.out_of_range |= (uint32_t) bad << l;
+        }
+        return validate(lanes, n);
+    }
+
+    BatchValidator::Result BatchValidator::validate(const int8_t *cells, size_t n) {
+        Lanes lanes;
+        if (n > LANES) n = LANES;
+        if (n < LANES) std::memset(lanes.cells, 0, sizeof lanes.cells);
+        // location-major, so each row of lanes.cells is written contiguously
+        const auto *bytes = (const uint8_t *) cells;
+        uint8_t bad[LANES]{};
+        for (short k{0}; k < N_CELLS; k++) {
+            for (size_t l{0}; l < n; l++) {
+                uint8_t value = bytes[l * N_CELLS + k];
+                lanes.cells[k][l] = MASKS.mask[value];
+                bad[l] |= MASKS.out_of_range[value];
+            }
+        }
+        for (size_t l{0}; l < n; l++) lanes.out_of_range |= (uint32_t) bad[l] << l;
+        return validate(lanes, n);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SUDOKU_BATCH_VALIDATOR_H
+#define SUDOKU_BATCH_VALIDATOR_H
+#include <cstddef>
+#include <cstdint>
+#include "sudoku_board.h"
+
+/*!
+ *  Validates up to 32 boards at once.
+ *
+ *  The boards are transposed into a structure of arrays: for every location,
+ *  one 16-bit lane per board holding the digit as a bit (`1 << digit`, 0 for
+ *  an empty location). A unit (row, column or box) is then checked for all
+ *  boards at the same time by OR-ing its nine locations, while AND-ing each
+ *  location with the running OR catches repeated digits.
+ *
+ *  The kernel uses AVX-512 (32 lanes per register) or AVX2 (16 lanes) when
+ *  the CPU supports them, and a portable scalar loop otherwise.
+ */
+
+namespace sdkg {
+
+    class BatchValidator {
+        public:
+            static constexpr size_t LANES{ 32 };    //!< Maximum # of boards per batch.
+
+            /// Bit `i` of each mask refers to the i-th board of the batch.
+            struct Result {
+                uint32_t consistent = 0;    //!< Values in [0, 9] and no digit repeated in a row, column or box.
+                uint32_t complete = 0;      //!< Consistent and every location filled, i.e. a solved board.
+            };
+
+            /// The boards stored as bit masks, one lane per board.
+            struct Lanes {
+                alignas(64) uint16_t cells[Config::SB_SIZE * Config::SB_SIZE][LANES];
+                uint32_t out_of_range = 0;  //!< Boards with a value outside [0, 9].
+            };
+
+            // Validates `n` (<= LANES) boards. Values are taken as they are, so hidden (negative) values are invalid.
+            static Result validate( const SBoard *boards, size_t n );
+
+            // Same, for `n` boards packed as 81 consecutive row-major values each.
+            static Result validate( const int8_t *cells, size_t n );
+
+            // Runs the unit checks over already transposed boards.
+            static Result validate( const Lanes &lanes, size_t n );
+
+            // Name of the kernel picked for this CPU: "avx512", "avx2" or "scalar".
+            static const char * kernel_name();
+    };
+}
+
+#endif //SUDOKU_BATCH_VALIDATOR_H
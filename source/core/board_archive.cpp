@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+using std::ifstream;
+using std::ofstream;
+#include <stdexcept>
+#include <thread>
+#include "board_archive.h"
+#include "board_geometry.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr char MAGIC[4]{ 'S', 'D', 'K', 'A' };
+        constexpr size_t HEADER_SIZE{ 24 };
+        constexpr short N_CELLS{ BoardGeometry::N_CELLS };
+        constexpr size_t BITMAP_SIZE{ 11 };
+        constexpr short SOLUTION_BIT{ N_CELLS };
+
+        void put_u16( vector<uint8_t> &out, uint16_t v ) {
+            for (int i{0}; i < 2; i++) out.push_back((uint8_t) (v >> (8 * i)));
+        }
+        void put_u32( vector<uint8_t> &out, uint32_t v ) {
+            for (int i{0}; i < 4; i++) out.push_back((uint8_t) (v >> (8 * i)));
+        }
+        void put_u64( vector<uint8_t> &out, uint64_t v ) {
+            for (int i{0}; i < 8; i++) out.push_back((uint8_t) (v >> (8 * i)));
+        }
+        uint64_t get_uint( const uint8_t *in, int n_bytes ) {
+            uint64_t v = 0;
+            for (int i{0}; i < n_bytes; i++) v |= (uint64_t) in[i] << (8 * i);
+            return v;
+        }
+    }
+
+    void BoardArchive::encode_board(BoardView sb, bool keep_solution, vector<uint8_t> &out) {
+        uint8_t bitmap[BITMAP_SIZE]{};
+        uint8_t nibbles[N_CELLS];
+        short n_nibbles = 0;
+        bool has_solution = keep_solution;
+
+        for (short k{0}; k < N_CELLS; k++) {
+            short value = sb.at(GEOMETRY.line[k], GEOMETRY.column[k]);
+            if (value > 0) {
+                bitmap[k / 8] |= (uint8_t) (1u << (k % 8));
+                nibbles[n_nibbles++] = (uint8_t) value;
+            } else if (value == 0) {
+                has_solution = false;   // clue-only board
+            }
+        }
+        if (has_solution) {
+            bitmap[SOLUTION_BIT / 8] |= (uint8_t) (1u << (SOLUTION_BIT % 8));
+            for (short k{0}; k < N_CELLS; k++) {
+                short value = sb.at(GEOMETRY.line[k], GEOMETRY.column[k]);
+                if (value < 0) nibbles[n_nibbles++] = (uint8_t) -value;
+            }
+        }
+        out.insert(out.end(), bitmap, bitmap + BITMAP_SIZE);
+        for (short n{0}; n < n_nibbles; n += 2) {
+            uint8_t high = (n + 1 < n_nibbles) ? nibbles[n + 1] : 0;
+            out.push_back((uint8_t) (nibbles[n] | (high << 4)));
+        }
+    }
+
+    const uint8_t * BoardArchive::decode_board(const uint8_t *in, SBoard &sb) {
+        const uint8_t *bitmap = in;
+        const uint8_t *digits = in + BITMAP_SIZE;
+        bool has_solution = bitmap[SOLUTION_BIT / 8] & (1u << (SOLUTION_BIT % 8));
+        short n = 0;
+        auto next_digit = [&digits, &n]() {
+            auto digit = (short) ((n % 2 == 0) ? (digits[n / 2] & 0x0F) : (digits[n / 2] >> 4));
+            n++;
+            return digit;
+        };
+
+        for (short k{0}; k < N_CELLS; k++) {
+            bool is_clue = bitmap[k / 8] & (1u << (k % 8));
+            sb.set_loc(GEOMETRY.line[k], GEOMETRY.column[k], is_clue ? next_digit() : 0);
+        }
+        if (has_solution) {
+            for (short k{0}; k < N_CELLS; k++) {
+                short line = GEOMETRY.line[k], column = GEOMETRY.column[k];
+                if (sb.at(line, column) == 0) sb.set_loc(line, column, (short) -next_digit());
+            }
+        }
+        return digits + (n + 1) / 2;
+    }
+
+    bool BoardArchive::is_archive(const string &path) {
+        ifstream file{path, std::ios::binary};
+        char magic[sizeof MAGIC];
+        return file.read(magic, sizeof magic) and std::memcmp(magic, MAGIC, sizeof MAGIC) == 0;
+    }
+
+    void BoardArchive::write(const string &path, const BoardPool &boards, bool keep_solutions,
+                             uint32_t boards_per_block) {
+        if (boards_per_block == 0) throw std::invalid_argument("BoardArchive::write -> boards per block must be positive\n");
+        auto num_blocks = (uint32_t) ((boards.size() + boards_per_block - 1) / boards_per_block);
+
+        vector<uint8_t> body;
+        vector<uint64_t> offsets;
+        uint64_t body_start = HEADER_SIZE + 8 * ((uint64_t) num_blocks + 1);
+        boards.scan(0, boards.size(), [&]( size_t b, BoardView sb ) {
+            if (b % boards_per_block == 0) offsets.push_back(body_start + body.size());
+            encode_board(sb, keep_solutions, body);
+        });
+        offsets.push_back(body_start + body.size());
+
+        vector<uint8_t> head(MAGIC, MAGIC + sizeof MAGIC);
+        put_u16(head, VERSION);
+        put_u16(head, 0);   // flags, reserved for future encodings
+        put_u32(head, (uint32_t) boards.size());
+        put_u32(head, boards_per_block);
+        put_u32(head, num_blocks);
+        put_u32(head, 0);
+        for (uint64_t offset : offsets) put_u64(head, offset);
+
+        ofstream file{path, std::ios::binary | std::ios::trunc};
+        if (not file) throw std::runtime_error("Archive file could not be created!\n");
+        file.write((const char *) head.data(), (std::streamsize) head.size());
+        file.write((const char *) body.data(), (std::streamsize) body.size());
+        if (not file) throw std::runtime_error("Archive file could not be written!\n");
+    }
+
+    BoardArchive::BoardArchive(const string &path) : m_path{path} {
+        ifstream file{path, std::ios::binary};
+        uint8_t head[HEADER_SIZE];
+        if (not file.read((char *) head, HEADER_SIZE) or std::memcmp(head, MAGIC, sizeof MAGIC) != 0) {
+            throw std::runtime_error("File is not a puzzle archive!\n");
+        }
+        if (get_uint(head + 4, 2) != VERSION) throw std::runtime_error("Unsupported puzzle archive version!\n");
+        m_num_boards = (uint32_t) get_uint(head + 8, 4);
+        m_boards_per_block = (uint32_t) get_uint(head + 12, 4);
+        auto num_blocks = (uint32_t) get_uint(head + 16, 4);
+        if (m_boards_per_block == 0 or
+            num_blocks != (m_num_boards + (uint64_t) m_boards_per_block - 1) / m_boards_per_block) {
+            throw std::runtime_error("Corrupted puzzle archive header!\n");
+        }
+
+        // sizes come from the file, check them against its length before allocating anything
+        file.seekg(0, std::ios::end);
+        auto file_size = (uint64_t) file.tellg();
+        file.seekg((std::streamoff) HEADER_SIZE);
+        uint64_t body_start = HEADER_SIZE + 8 * ((uint64_t) num_blocks + 1);
+        if (body_start > file_size) throw std::runtime_error("Corrupted puzzle archive index!\n");
+
+        vector<uint8_t> index(8 * ((size_t) num_blocks + 1));
+        if (not file.read((char *) index.data(), (std::streamsize) index.size())) {
+            throw std::runtime_error("Corrupted puzzle archive index!\n");
+        }
+        m_block_offsets.resize(num_blocks + 1);
+        for (size_t b{0}; b <= num_blocks; b++) {
+            m_block_offsets[b] = get_uint(&index[8 * b], 8);
+            if (m_block_offsets[b] < body_start or m_block_offsets[b] > file_size) {
+                throw std::runtime_error("Corrupted puzzle archive index!\n");
+            }
+        }
+        for (size_t b{0}; b < num_blocks; b++) {
+            // every board takes at least the bitmap
+            uint64_t block_boards = std::min<uint64_t>(m_boards_per_block, m_num_boards - b * m_boards_per_block);
+            if (m_block_offsets[b + 1] < m_block_offsets[b] + block_boards * BITMAP_SIZE) {
+                throw std::runtime_error("Corrupted puzzle archive index!\n");
+            }
+        }
+    }
+
+    vector<uint8_t> BoardArchive::read_block(uint32_t block_idx) const {
+        ifstream file{m_path, std::ios::binary};
+        vector<uint8_t> block(m_block_offsets[block_idx + 1] - m_block_offsets[block_idx]);
+        file.seekg((std::streamoff) m_block_offsets[block_idx]);
+        if (not file.read((char *) block.data(), (std::streamsize) block.size())) {
+            throw std::runtime_error("Truncated puzzle archive!\n");
+        }
+        // room for the worst case board, so a corrupted block cannot make the decoder read past the end
+        block.resize(block.size() + BITMAP_SIZE + N_CELLS / 2 + 1, 0);
+        return block;
+    }
+
+    SBoard BoardArchive::board(size_t board_idx) const {
+        if (board_idx >= m_num_boards) {
+            throw std::out_of_range("BoardArchive::board -> Invalid board index: " + std::to_string(board_idx) + "\n");
+        }
+        auto block_idx = (uint32_t) (board_idx / m_boards_per_block);
+        vector<uint8_t> block = read_block(block_idx);
+        const uint8_t *in = block.data();
+        const uint8_t *end = block.data() + (m_block_offsets[block_idx + 1] - m_block_offsets[block_idx]);
+        SBoard sb;
+        for (size_t k{0}; k <= board_idx % m_boards_per_block; k++) {
+            if (in >= end) throw std::runtime_error("Corrupted puzzle archive block!\n");
+            in = decode_board(in, sb);
+        }
+        return sb;
+    }
+
+    vector<SBoard> BoardArchive::read_all(unsigned threads) const {
+        vector<SBoard> boards(m_num_boards);
+        auto num_blocks = (uint32_t) (m_block_offsets.size() - 1);
+        if (num_blocks == 0) return boards;
+
+        // one read for the whole body, then every thread decodes its own blocks
+        ifstream file{m_path, std::ios::binary};
+        vector<uint8_t> body(m_block_offsets.back() - m_block_offsets.front() + BITMAP_SIZE + N_CELLS / 2 + 1, 0);
+        file.seekg((std::streamoff) m_block_offsets.front());
+        if (not file.read((char *) body.data(), (std::streamsize) (m_block_offsets.back() - m_block_offsets.front()))) {
+            throw std::runtime_error("Truncated puzzle archive!\n");
+        }
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, num_blocks);
+        std::atomic<bool> corrupted{ false };
+        auto decode_blocks = [&](uint32_t first, uint32_t step) {
+            for (uint32_t b{first}; b < num_blocks; b += step) {
+                const uint8_t *in = body.data() + (m_block_offsets[b] - m_block_offsets.front());
+                const uint8_t *block_end = body.data() + (m_block_offsets[b + 1] - m_block_offsets.front());
+                size_t last = std::min<size_t>((size_t) (b + 1) * m_boards_per_block, m_num_boards);
+                for (size_t k{(size_t) b * m_boards_per_block}; k < last; k++) {
+                    // the padding after the body absorbs the overrun of a single board
+                    if (in >= block_end) { corrupted = true; return; }
+                    in = decode_board(in, boards[k]);
+                }
+            }
+        };
+        vector<std::thread> workers;
+        for (unsigned t{1}; t < threads; t++) workers.emplace_back(decode_blocks, t, threads);
+        decode_blocks(0, threads);
+        for (std::thread &worker : workers) worker.join();
+        if (corrupted) throw std::runtime_error("Corrupted puzzle archive block!\n");
+        return boards;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SUDOKU_BOARD_ARCHIVE_H
+#define SUDOKU_BOARD_ARCHIVE_H
+#include <cstdint>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include "sudoku_board.h"
+#include "board_pool.h"
+
+/*!
+ *  Compact binary puzzle archive.
+ *
+ *  Layout (all integers little-endian):
+ *
+ *  + Header, 24 bytes: magic "SDKA", version (u16), flags (u16), # of boards (u32),
+ *    boards per block (u32), # of blocks (u32), reserved (u32).
+ *  + Block index: the file offset (u64) of every block, plus the end offset of the last one.
+ *  + Blocks: boards packed back to back. A block never refers to another one, so blocks can be
+ *    decoded in any order, by different threads, and a board is reached by decoding its block only.
+ *
+ *  A packed board is an 88-bit bitmap (11 bytes) followed by 4-bit digits (nibbles):
+ *
+ *  + Bits [0, 80] of the bitmap tell which locations are clues, in row-major order.
+ *    Bit 81 tells the board carries its solution.
+ *  + The digits of the clues follow, in row-major order; then, if the solution is carried,
+ *    the digits of the hidden locations. The last byte is padded with a zero nibble.
+ *
+ *  A board with 25 clues takes 24 bytes without its solution and 52 bytes with it, against
+ *  roughly 250 bytes in the text format. Boards without solution are loaded as clue-only
+ *  boards, and have their solution derived when needed.
+ */
+
+namespace sdkg {
+
+    class BoardArchive {
+        public:
+            static constexpr uint16_t VERSION{ 1 };
+            static constexpr uint32_t DEFAULT_BOARDS_PER_BLOCK{ 4096 };
+
+        private:
+            string m_path;                    //!< Archive file.
+            uint32_t m_num_boards = 0;
+            uint32_t m_boards_per_block = 0;
+            vector<uint64_t> m_block_offsets; //!< Offset of each block, plus the end of the last one.
+
+            static void encode_board( BoardView sb, bool keep_solution, vector<uint8_t> &out );
+            static const uint8_t * decode_board( const uint8_t *in, SBoard &sb );
+
+            // Reads the raw bytes of a block.
+            vector<uint8_t> read_block( uint32_t block_idx ) const;
+
+        public:
+            // Opens an archive, reading its header and block index.
+            explicit BoardArchive( const string &path );
+
+            // Tells if the file starts with the archive magic number.
+            static bool is_archive( const string &path );
+
+            // Writes boards to a new archive, dropping the solutions unless keep_solutions is set.
+            static void write( const string &path, const BoardPool &boards, bool keep_solutions=true,
+                               uint32_t boards_per_block=DEFAULT_BOARDS_PER_BLOCK );
+
+            inline size_t size() const { return m_num_boards; }
+
+            // Decodes a single board, reading only the block that contains it.
+            SBoard board( size_t board_idx ) const;
+
+            // Decodes every board, spreading the blocks over `threads` threads (0 = one per core).
+            vector<SBoard> read_all( unsigned threads=0 ) const;
+    };
+}
+
+#endif //SUDOKU_BOARD_ARCHIVE_H
@@ -0,0 +1,75 @@
+#ifndef SUDOKU_BOARD_GEOMETRY_H
+#define SUDOKU_BOARD_GEOMETRY_H
+#include <cstdint>
+#include "config.h"
+
+/*!
+ *  Board geometry tables, computed by the compiler.
+ *
+ *  Locations are numbered row-major, `cell = line * 9 + column`. Units are
+ *  numbered rows first (0-8), then columns (9-17), then boxes (18-26), boxes
+ *  being numbered row-major as well. The tables are constant data: nothing
+ *  runs at startup and lookups replace the divisions and modulos of the
+ *  board loops.
+ *
+ *  How to use it:
+ *  ```c++
+ *      for (uint8_t peer : GEOMETRY.peers[cell]) { ... }   // the 20 cells sharing a unit with `cell`
+ *      short box = GEOMETRY.box[cell];
+ *  ```
+ */
+
+namespace sdkg {
+
+    struct BoardGeometry {
+        static constexpr short N_CELLS{ Config::SB_SIZE * Config::SB_SIZE };
+        static constexpr short N_UNITS{ 3 * Config::SB_SIZE };
+        static constexpr short N_PEERS{ 20 };
+        static constexpr short BOX_SIZE{ 3 };
+
+        uint8_t line[N_CELLS];                      //!< Row of a cell.
+        uint8_t column[N_CELLS];                    //!< Column of a cell.
+        uint8_t box[N_CELLS];                       //!< Box of a cell.
+        uint8_t units[N_UNITS][Config::SB_SIZE];    //!< Cells of every unit: rows, columns, then boxes.
+        uint8_t cell_units[N_CELLS][3];             //!< Row, column and box unit of a cell.
+        uint32_t unit_mask[N_CELLS];                //!< Bit `u` set if the cell belongs to unit `u`.
+        uint8_t peers[N_CELLS][N_PEERS];            //!< Other cells sharing a unit with a cell, ascending.
+        bool box_start[Config::SB_SIZE];            //!< Row (or column) index starting a new box band.
+
+        static constexpr short cell_of( short l, short c ) { return (short) (l * Config::SB_SIZE + c); }
+    };
+
+    constexpr BoardGeometry make_board_geometry() {
+        BoardGeometry g{};
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            auto l = (uint8_t) (cell / Config::SB_SIZE), c = (uint8_t) (cell % Config::SB_SIZE);
+            auto b = (uint8_t) ((l / BoardGeometry::BOX_SIZE) * BoardGeometry::BOX_SIZE + c / BoardGeometry::BOX_SIZE);
+            g.line[cell] = l;
+            g.column[cell] = c;
+            g.box[cell] = b;
+            g.cell_units[cell][0] = l;
+            g.cell_units[cell][1] = (uint8_t) (Config::SB_SIZE + c);
+            g.cell_units[cell][2] = (uint8_t) (2 * Config::SB_SIZE + b);
+            g.unit_mask[cell] = (1u << g.cell_units[cell][0]) | (1u << g.cell_units[cell][1]) | (1u << g.cell_units[cell][2]);
+        }
+        short filled[BoardGeometry::N_UNITS]{};
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            for (uint8_t u : g.cell_units[cell]) g.units[u][filled[u]++] = (uint8_t) cell;
+        }
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            short n = 0;
+            for (short other{0}; other < BoardGeometry::N_CELLS; other++) {
+                if (other != cell and (g.unit_mask[cell] & g.unit_mask[other]) != 0) g.peers[cell][n++] = (uint8_t) other;
+            }
+        }
+        for (short i{0}; i < Config::SB_SIZE; i++) g.box_start[i] = i % BoardGeometry::BOX_SIZE == 0;
+        return g;
+    }
+
+    inline constexpr BoardGeometry GEOMETRY = make_board_geometry();
+
+    static_assert(GEOMETRY.peers[0][BoardGeometry::N_PEERS - 1] == 72, "last peer of the first cell is the column end");
+    static_assert(GEOMETRY.units[2 * Config::SB_SIZE + 4][0] == 30, "the center box starts at line 3, column 3");
+}
+
+#endif //SUDOKU_BOARD_GEOMETRY_H
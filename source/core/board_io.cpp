@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+using std::string;
+#include "board_io.h"
+
+namespace sdkg {
+
+    namespace {
+        inline bool is_space( char ch ) { return ch == ' ' or ch == '\t' or ch == '\r'; }
+
+        bool is_blank( const string &line ) {
+            return std::all_of(line.begin(), line.end(), is_space);
+        }
+
+        /// A whole board in a single line, e.g. "4..8.1...", with '.' or '0' for unknown locations.
+        bool is_single_line_board( const string &line ) {
+            return line.size() >= Config::SB_SIZE * Config::SB_SIZE and
+                   std::all_of(line.begin(), line.begin() + Config::SB_SIZE * Config::SB_SIZE,
+                               [](char ch) { return ch == '.' or (ch >= '0' and ch <= '9'); });
+        }
+
+        /// Reads the first nine whitespace separated integers of a line into a board row.
+        bool parse_row( const string &line, short row, SBoard &sb ) {
+            const char *cur = line.data(), *end = line.data() + line.size();
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                while (cur < end and is_space(*cur)) cur++;
+                if (cur < end and *cur == '+') cur++;
+                short value = 0;
+                auto [next, error] = std::from_chars(cur, end, value);
+                // the whole token must be the number, "5x" or a value that overflows is not a location
+                if (error != std::errc() or (next < end and not is_space(*next))) return false;
+                sb.set_loc(row, j, value);
+                cur = next;
+            }
+            return true;
+        }
+
+        /// Skips the rest of a malformed board, up to the empty line that ends it.
+        void skip_board( std::istream &in ) {
+            string line;
+            while (getline(in, line) and not is_blank(line)) { /* skip */ }
+        }
+    }
+
+    read_status_e try_read_board(std::istream &in, SBoard &sb) {
+        string input;
+        // skip the empty lines separating boards
+        do {
+            if (not getline(in, input)) return END_OF_INPUT;
+        } while (is_blank(input));
+
+        if (is_single_line_board(input)) {
+            for (short k{0}; k < Config::SB_SIZE * Config::SB_SIZE; k++) {
+                sb.set_loc((short) (k / Config::SB_SIZE), (short) (k % Config::SB_SIZE),
+                           (short) (input[k] == '.' ? 0 : input[k] - '0'));
+            }
+            return BOARD_READ;
+        }
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            // a board cut short by the end of the input or by an empty line
+            if (i > 0 and (not getline(in, input) or is_blank(input))) return BOARD_MALFORMED;
+            if (not parse_row(input, i, sb)) {
+                skip_board(in);
+                return BOARD_MALFORMED;
+            }
+        }
+        return BOARD_READ;
+    }
+
+    bool read_board(std::istream &in, SBoard &sb) {
+        read_status_e status = try_read_board(in, sb);
+        if (status == BOARD_MALFORMED) throw std::invalid_argument("Malformed board in the input!\n");
+        return status == BOARD_READ;
+    }
+
+    void write_board(std::ostream &out, const SBoard &sb) {
+        char text[MAX_BOARD_TEXT];
+        out.write(text, (std::streamsize) format_board(sb, text));
+    }
+
+    size_t format_board(const SBoard &sb, char *out) {
+        char *start = out;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                if (j > 0) *out++ = ' ';
+                short value = sb.at(i, j);
+                if (value >= 0 and value <= 9) {
+                    *out++ = (char) ('0' + value);
+                } else if (value < 0 and value >= -9) {
+                    *out++ = '-';
+                    *out++ = (char) ('0' - value);
+                } else {
+                    out = std::to_chars(out, out + MAX_VALUE_TEXT, value).ptr;  // not a board value, written as is
+                }
+            }
+            *out++ = '\n';
+        }
+        *out++ = '\n';
+        return (size_t) (out - start);
+    }
+}
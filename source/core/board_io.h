@@ -0,0 +1,60 @@
+#ifndef SUDOKU_BOARD_IO_H
+#define SUDOKU_BOARD_IO_H
+#include <istream>
+#include <ostream>
+#include "sudoku_board.h"
+
+/*!
+ *  Text format of the puzzle files.
+ *
+ *  A board is either nine lines of nine whitespace separated numbers, or a
+ *  single line with 81 characters where '.' or '0' is an unknown location.
+ *  Boards are separated by (at least) one empty line. Positive values are
+ *  the clues, negative values are hidden locations whose absolute value is
+ *  the solution, and 0 is a hidden location with unknown solution.
+ */
+
+namespace sdkg {
+
+    /// Outcome of try_read_board.
+    enum read_status_e {
+        BOARD_READ,         //!< A board was read.
+        BOARD_MALFORMED,    //!< A board was skipped: bad number, short row or missing lines.
+        END_OF_INPUT        //!< No board left.
+    };
+
+    /// Reads the next board from a text stream, never throwing on bad input.
+    /*!
+     * @param in  The input stream, positioned anywhere before the next board.
+     * @param sb  Receives the board values exactly as written (clues, negatives and zeros).
+     * @return    BOARD_MALFORMED leaves the stream after the bad board (its empty line), so reading
+     *            can go on with the next one; `sb` is partially written then.
+     */
+    read_status_e try_read_board( std::istream &in, SBoard &sb );
+
+    /// Reads the next board from a text stream.
+    /*!
+     * @param in  The input stream, positioned anywhere before the next board.
+     * @param sb  Receives the board values exactly as written (clues, negatives and zeros).
+     * @return    false if the stream ended before another board was found.
+     * @throws    std::invalid_argument if the board is malformed (the stream is left as try_read_board does).
+     */
+    bool read_board( std::istream &in, SBoard &sb );
+
+    /// Writes a board in the nine-lines text format, followed by an empty line.
+    void write_board( std::ostream &out, const SBoard &sb );
+
+    /// Longest text of a location value ("-32768"), only reached by values outside [-9, 9].
+    constexpr size_t MAX_VALUE_TEXT{ 6 };
+
+    /// Longest text of a board: nine lines of nine values, each followed by a space or a '\n', plus the empty line.
+    constexpr size_t MAX_BOARD_TEXT{ Config::SB_SIZE * Config::SB_SIZE * (MAX_VALUE_TEXT + 1) + 1 };
+
+    /// Formats a board like write_board into a buffer of at least MAX_BOARD_TEXT chars.
+    /*!
+     * @return The # of chars written.
+     */
+    size_t format_board( const SBoard &sb, char *out );
+}
+
+#endif //SUDOKU_BOARD_IO_H
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include "board_pool.h"
+#include "sudoku_board.h"
+
+namespace sdkg {
+
+    bool BoardView::has_blanks() const {
+        return std::memchr(m_cells, 0, BoardPool::BOARD_BYTES) != nullptr;
+    }
+
+    void BoardView::copy_to(SBoard &sb) const {
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) sb.set_loc(i, j, at(i, j));
+        }
+    }
+
+    void BoardPool::reserve(size_t n) {
+        if (n <= m_capacity) return;
+        // aligned_alloc wants a multiple of the alignment
+        size_t bytes = (n * BOARD_BYTES + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        auto *cells = (int8_t *) std::aligned_alloc(ALIGNMENT, bytes);
+        if (cells == nullptr) throw std::bad_alloc();
+        if (m_size > 0) std::memcpy(cells, m_cells.get(), m_size * BOARD_BYTES);
+        m_cells.reset(cells);
+        m_capacity = n;
+    }
+
+    bool BoardPool::fits(const SBoard &sb) {
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                if (sb.at(i, j) < INT8_MIN or sb.at(i, j) > INT8_MAX) return false;
+            }
+        }
+        return true;
+    }
+
+    void BoardPool::push_back(const SBoard &sb) {
+        if (not fits(sb)) throw std::invalid_argument("BoardPool::push_back -> Value does not fit a byte\n");
+        if (m_size == m_capacity) reserve(std::max<size_t>(64, 2 * m_capacity));
+        int8_t *cells = m_cells.get() + m_size * BOARD_BYTES;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) *cells++ = (int8_t) sb.at(i, j);
+        }
+        m_size++;
+    }
+
+    void BoardPool::append(const BoardPool &other) {
+        if (other.empty()) return;
+        reserve(m_size + other.m_size);
+        std::memcpy(m_cells.get() + m_size * BOARD_BYTES, other.m_cells.get(), other.m_size * BOARD_BYTES);
+        m_size += other.m_size;
+    }
+
+    BoardView BoardPool::at(size_t idx) const {
+        if (idx >= m_size) throw std::out_of_range("BoardPool::at -> Invalid board index: " + std::to_string(idx) + "\n");
+        return (*this)[idx];
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef SUDOKU_BOARD_POOL_H
+#define SUDOKU_BOARD_POOL_H
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include "config.h"
+
+/*!
+ *  Contiguous storage for the boards of a puzzle file.
+ *
+ *  Every board takes 81 consecutive bytes, row-major, in a single 64-byte
+ *  aligned buffer: half the size of an SBoard, no allocation per board, and
+ *  the very packing of BatchValidator's byte input, so boards are validated
+ *  where they lie. Values must fit a byte; boards read from a puzzle file are
+ *  in [-9, 9].
+ *
+ *  Boards are read through a BoardView, a pointer to the bytes of one board,
+ *  so nothing gets copied. `scan` walks a range of boards prefetching a few
+ *  boards ahead, which keeps sequential passes over a big pool bound by the
+ *  memory bandwidth instead of the memory latency.
+ *
+ *  How to use it:
+ *  ```c++
+ *      BoardPool pool;
+ *      pool.push_back(sb);
+ *      pool.scan(0, pool.size(), [&]( size_t idx, BoardView board ) { use(board.at(4, 4)); });
+ *  ```
+ */
+
+namespace sdkg {
+
+    class SBoard;
+
+    /// Read-only view of a board stored in a BoardPool, valid until the pool grows.
+    class BoardView {
+        private:
+            const int8_t *m_cells;
+
+        public:
+            explicit BoardView( const int8_t *cells ) : m_cells{cells} {/*empty*/}
+
+            inline short at( short line, short column ) const { return m_cells[line * Config::SB_SIZE + column]; }
+
+            // The 81 values, row-major.
+            inline const int8_t * cells() const { return m_cells; }
+
+            // Tells if some location holds 0 (a clue-only board).
+            bool has_blanks() const;
+
+            // Writes the board to an SBoard, for the code that needs one to work on (solvers).
+            void copy_to( SBoard &sb ) const;
+    };
+
+    class BoardPool {
+        public:
+            static constexpr size_t BOARD_BYTES{ Config::SB_SIZE * Config::SB_SIZE };
+            static constexpr size_t ALIGNMENT{ 64 };            //!< Cache line size.
+            static constexpr size_t PREFETCH_DISTANCE{ 16 };    //!< Boards prefetched ahead by `scan`.
+
+        private:
+            struct Free {
+                void operator()( int8_t *cells ) const { std::free(cells); }
+            };
+
+            std::unique_ptr<int8_t[], Free> m_cells;
+            size_t m_size = 0;
+            size_t m_capacity = 0;
+
+        public:
+            BoardPool() = default;
+            BoardPool( BoardPool && ) = default;
+            BoardPool & operator=( BoardPool && ) = default;
+            BoardPool & operator=( const BoardPool & ) = delete;
+            BoardPool( const BoardPool & ) = delete;
+
+            // Makes room for `n` boards, so no view gets invalidated until then.
+            void reserve( size_t n );
+
+            // Appends a board. Throws std::invalid_argument if a value does not fit a byte.
+            void push_back( const SBoard &sb );
+
+            // Appends every board of another pool, in its order, with a single copy.
+            void append( const BoardPool &other );
+
+            // Tells if every value of a board fits a byte, i.e. push_back accepts it.
+            static bool fits( const SBoard &sb );
+
+            inline void clear() { m_size = 0; }
+            inline size_t size() const { return m_size; }
+            inline bool empty() const { return m_size == 0; }
+
+            inline BoardView operator[]( size_t idx ) const { return BoardView{ m_cells.get() + idx * BOARD_BYTES }; }
+
+            // Same as operator[], throwing std::out_of_range for a bad index.
+            BoardView at( size_t idx ) const;
+
+            // Bytes of the boards from `first` on, packed as BatchValidator takes them.
+            inline const int8_t * data( size_t first=0 ) const { return m_cells.get() + first * BOARD_BYTES; }
+
+            // Hints the CPU to bring a board into the caches (81 bytes span at most 3 cache lines).
+            inline void prefetch( size_t idx ) const {
+                const int8_t *cells = data(idx);
+                __builtin_prefetch(cells, 0, 0);
+                __builtin_prefetch(cells + ALIGNMENT, 0, 0);
+                __builtin_prefetch(cells + BOARD_BYTES - 1, 0, 0);
+            }
+
+            // Calls `visit( idx, BoardView )` for the boards in [first, last), prefetching ahead.
+            template < typename Visit >
+            void scan( size_t first, size_t last, Visit visit ) const {
+                for (size_t idx{first}; idx < last; idx++) {
+                    if (idx + PREFETCH_DISTANCE < last) prefetch(idx + PREFETCH_DISTANCE);
+                    visit(idx, (*this)[idx]);
+                }
+            }
+    };
+}
+
+#endif //SUDOKU_BOARD_POOL_H
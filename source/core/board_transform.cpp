@@ -0,0 +1,116 @@
+#include <stdexcept>
+#include <utility>
+#include <vector>
+using std::vector;
+#include "board_transform.h"
+#include "../utils/split.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr short LAST{ Config::SB_SIZE - 1 };
+
+        /// splitmix64: tiny, fast and good enough to shuffle a few permutations.
+        class SplitMix {
+            private:
+                uint64_t m_state;
+            public:
+                explicit SplitMix( uint64_t seed ) : m_state{seed} {}
+                uint64_t next() {
+                    uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+                    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                    return z ^ (z >> 31);
+                }
+                unsigned below( unsigned n ) { return (unsigned) (next() % n); }
+        };
+
+        template <typename T, size_t N>
+        void shuffle( T (&values)[N], SplitMix &rng ) {
+            for (size_t i{N - 1}; i > 0; i--) std::swap(values[i], values[rng.below((unsigned) i + 1)]);
+        }
+
+        /// Line order keeping bands together: a band permutation, then a row permutation per band.
+        void group_permutation( bool groups, bool members, SplitMix &rng, short (&order)[Config::SB_SIZE] ) {
+            short group[BoardGeometry::BOX_SIZE]{ 0, 1, 2 };
+            if (groups) shuffle(group, rng);
+            for (short g{0}; g < BoardGeometry::BOX_SIZE; g++) {
+                short member[BoardGeometry::BOX_SIZE]{ 0, 1, 2 };
+                if (members) shuffle(member, rng);
+                for (short m{0}; m < BoardGeometry::BOX_SIZE; m++) {
+                    order[g * BoardGeometry::BOX_SIZE + m] = (short) (group[g] * BoardGeometry::BOX_SIZE + member[m]);
+                }
+            }
+        }
+    }
+
+    BoardTransform::BoardTransform() {
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) m_source[cell] = (uint8_t) cell;
+        for (short d{0}; d <= Config::SUDOKU_BIGGEST_NUM; d++) m_digit[d] = d;
+    }
+
+    BoardTransform BoardTransform::random(uint64_t seed, unsigned kinds) {
+        SplitMix rng{ seed };
+        BoardTransform t;
+        if (kinds & RELABEL) {
+            short digits[Config::SUDOKU_BIGGEST_NUM]{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+            shuffle(digits, rng);
+            for (short d{1}; d <= Config::SUDOKU_BIGGEST_NUM; d++) t.m_digit[d] = digits[d - 1];
+        }
+        short rows[Config::SB_SIZE], columns[Config::SB_SIZE];
+        group_permutation(kinds & BANDS, kinds & ROWS, rng, rows);
+        group_permutation(kinds & STACKS, kinds & COLUMNS, rng, columns);
+        unsigned turns = (kinds & ROTATE) ? rng.below(4) : 0;
+        bool transpose = (kinds & TRANSPOSE) and rng.below(2) == 1;
+
+        // Map every output location back to the input: undo the transposition, then the
+        // clockwise turns, then the row/column permutations.
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            short line = GEOMETRY.line[cell], column = GEOMETRY.column[cell];
+            if (transpose) std::swap(line, column);
+            for (unsigned k{0}; k < turns; k++) {
+                short previous_line = (short) (LAST - column);
+                column = line;
+                line = previous_line;
+            }
+            t.m_source[cell] = (uint8_t) BoardGeometry::cell_of(rows[line], columns[column]);
+        }
+        return t;
+    }
+
+    uint64_t BoardTransform::variant_seed(uint64_t seed, uint64_t puzzle, uint64_t variant) {
+        uint64_t z = seed ^ (puzzle * 0x9E3779B97F4A7C15ull) ^ (variant * 0xC2B2AE3D27D4EB4Full);
+        z = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCDull;
+        return z ^ (z >> 33);
+    }
+
+    unsigned BoardTransform::parse_kinds(const string &list) {
+        static const std::pair<const char *, kind_e> NAMES[] = {
+            { "relabel", RELABEL }, { "bands", BANDS }, { "stacks", STACKS }, { "rows", ROWS },
+            { "columns", COLUMNS }, { "rotate", ROTATE }, { "transpose", TRANSPOSE }, { "all", ALL },
+        };
+        unsigned kinds = 0;
+        for (const string &name : split(list, ',')) {
+            if (name.empty()) continue;
+            bool known = false;
+            for (const auto &entry : NAMES) {
+                if (name != entry.first) continue;
+                kinds |= entry.second;
+                known = true;
+            }
+            if (not known) throw std::invalid_argument("Unknown transform \"" + name + "\"");
+        }
+        return kinds;
+    }
+
+    void BoardTransform::apply(const SBoard &in, SBoard &out) const {
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            uint8_t source = m_source[cell];
+            short value = in.at(GEOMETRY.line[source], GEOMETRY.column[source]);
+            short magnitude = value < 0 ? (short) -value : value;
+            // out of range values are moved, not relabeled, so a bad board stays bad
+            short digit = magnitude <= Config::SUDOKU_BIGGEST_NUM ? m_digit[magnitude] : magnitude;
+            out.set_loc(GEOMETRY.line[cell], GEOMETRY.column[cell], value < 0 ? (short) -digit : digit);
+        }
+    }
+}
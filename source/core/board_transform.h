@@ -0,0 +1,61 @@
+#ifndef SUDOKU_BOARD_TRANSFORM_H
+#define SUDOKU_BOARD_TRANSFORM_H
+#include <cstdint>
+#include <string>
+using std::string;
+#include "sudoku_board.h"
+#include "board_geometry.h"
+
+/*!
+ *  Validity preserving board transformations, used to derive variants of a
+ *  puzzle: digit relabeling, band/stack permutations, row/column permutations
+ *  inside a band/stack, rotations and transposition.
+ *
+ *  Every combination is folded into a single table, the source location of
+ *  each location, plus a digit map, so applying a transform is 81 lookups.
+ *  Signs are kept: a clue stays a clue and a hidden location stays hidden.
+ *
+ *  Random transforms are built from a 64-bit seed with a small splitmix
+ *  generator, so the variant made from a given seed never depends on the
+ *  order (or the thread) it was generated in.
+ */
+
+namespace sdkg {
+
+    class BoardTransform {
+        public:
+            /// Transformation kinds, combined as a bit mask.
+            enum kind_e : unsigned {
+                RELABEL   = 1u << 0,    //!< Digits mapped by a random permutation of 1-9.
+                BANDS     = 1u << 1,    //!< Bands (groups of three rows) shuffled.
+                STACKS    = 1u << 2,    //!< Stacks (groups of three columns) shuffled.
+                ROWS      = 1u << 3,    //!< Rows shuffled inside their band.
+                COLUMNS   = 1u << 4,    //!< Columns shuffled inside their stack.
+                ROTATE    = 1u << 5,    //!< Rotated by 0, 90, 180 or 270 degrees.
+                TRANSPOSE = 1u << 6,    //!< Mirrored along the main diagonal, half the time.
+                ALL       = (1u << 7) - 1
+            };
+
+        private:
+            uint8_t m_source[BoardGeometry::N_CELLS];   //!< Location of the input read by each output location.
+            short m_digit[Config::SUDOKU_BIGGEST_NUM + 1];  //!< New digit of each digit, 0 maps to 0.
+
+        public:
+            /// The identity transform.
+            BoardTransform();
+
+            // A random combination of the given kinds, fully determined by `seed`.
+            static BoardTransform random( uint64_t seed, unsigned kinds );
+
+            // Seed of the `variant`-th variant of the `puzzle`-th puzzle of a run started with `seed`.
+            static uint64_t variant_seed( uint64_t seed, uint64_t puzzle, uint64_t variant );
+
+            // Parses a comma separated list of kind names ("relabel,rows,...", or "all"). Throws std::invalid_argument.
+            static unsigned parse_kinds( const string &list );
+
+            // Writes the transformed `in` to `out` (they must be different boards).
+            void apply( const SBoard &in, SBoard &out ) const;
+    };
+}
+
+#endif //SUDOKU_BOARD_TRANSFORM_H
@@ -0,0 +1,94 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include "checkpoint.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr const char *MAGIC{ "sudoku-checkpoint 1" };
+
+        [[noreturn]] void fail( const string &what, const string &path ) {
+            throw std::runtime_error("checkpoint: " + what + " \"" + path + "\": " + std::strerror(errno));
+        }
+
+        [[noreturn]] void fail_closing( int fd, const string &what, const string &path ) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            fail(what, path);
+        }
+
+        string directory_of( const string &path ) {
+            size_t slash = path.find_last_of('/');
+            if (slash == string::npos) return ".";
+            return slash == 0 ? "/" : path.substr(0, slash);
+        }
+    }
+
+    bool Checkpoint::load(const string &path, Checkpoint &cp) {
+        std::ifstream file{ path };
+        if (not file) return false;
+        string line, key;
+        if (not std::getline(file, line) or line != MAGIC) {
+            throw std::runtime_error("checkpoint: \"" + path + "\" is not a checkpoint file");
+        }
+        cp = Checkpoint();
+        while (std::getline(file, line)) {
+            std::istringstream fields{ line };
+            fields >> key;
+            if (key == "job") {
+                std::getline(fields >> std::ws, cp.job);
+            } else if (key == "input_offset") {
+                fields >> cp.input_offset;
+            } else if (key == "output_offset") {
+                fields >> cp.output_offset;
+            } else if (key == "records") {
+                fields >> cp.records;
+            } else if (key == "counter") {
+                string name;
+                uint64_t value = 0;
+                fields >> name >> value;
+                cp.counters[name] = value;
+            }
+            if (fields.fail()) throw std::runtime_error("checkpoint: bad line in \"" + path + "\": " + line);
+        }
+        return true;
+    }
+
+    void Checkpoint::save(const string &path) const {
+        std::ostringstream oss;
+        oss << MAGIC << "\n"
+            << "job " << job << "\n"
+            << "input_offset " << input_offset << "\n"
+            << "output_offset " << output_offset << "\n"
+            << "records " << records << "\n";
+        for (const auto &counter : counters) oss << "counter " << counter.first << " " << counter.second << "\n";
+        string text = oss.str();
+
+        string tmp = path + ".tmp";
+        int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) fail("cannot create", tmp);
+        for (size_t done{0}; done < text.size(); ) {
+            ssize_t n = write(fd, text.data() + done, text.size() - done);
+            if (n < 0 and errno == EINTR) continue;
+            if (n <= 0) fail_closing(fd, "cannot write", tmp);
+            done += (size_t) n;
+        }
+        if (fsync(fd) != 0) fail_closing(fd, "cannot sync", tmp);
+        close(fd);
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) fail("cannot rename to", path);
+
+        // the rename itself is only durable once the directory is
+        string dir = directory_of(path);
+        int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir_fd < 0) fail("cannot open directory", dir);
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SUDOKU_CHECKPOINT_H
+#define SUDOKU_CHECKPOINT_H
+#include <cstdint>
+#include <map>
+#include <string>
+using std::string;
+
+/*!
+ *  Progress of a long batch job, saved so a killed job resumes where it left off.
+ *
+ *  A checkpoint records how far the input was consumed, how much output is
+ *  durable, and the job's aggregate counters. It is a short text file that
+ *  is replaced atomically: written aside, fsync'ed, renamed over the old one
+ *  and the directory fsync'ed, so after a crash either the old or the new
+ *  checkpoint is on disk, never a torn one. The job must make its output
+ *  durable (up to `output_offset`) before saving.
+ *
+ *  How to use it:
+ *  ```c++
+ *      Checkpoint cp;
+ *      if (Checkpoint::load(path, cp) and cp.job == job) { ... seek input and output ... }
+ *      cp.input_offset = ...; cp.counters["solved"] += n;
+ *      cp.save(path);
+ *  ```
+ */
+
+namespace sdkg {
+
+    struct Checkpoint {
+        string job;                             //!< Describes the job (mode, input, options); a resumed run must match.
+        uint64_t input_offset = 0;              //!< Input bytes consumed, the next record starts here.
+        uint64_t output_offset = 0;             //!< Output bytes made durable; anything after it is discarded on resume.
+        uint64_t records = 0;                   //!< Input records processed.
+        std::map<string, uint64_t> counters;    //!< Aggregate counters of the job, by name (no spaces).
+
+        // Reads a checkpoint. Returns false if there is none; throws std::runtime_error if it is unreadable.
+        static bool load( const string &path, Checkpoint &cp );
+
+        // Atomically replaces the checkpoint at `path`. Throws std::runtime_error on I/O errors.
+        void save( const string &path ) const;
+    };
+}
+
+#endif //SUDOKU_CHECKPOINT_H
@@ -13,6 +13,7 @@ namespace sdkg {
        static constexpr short SB_CHAR_WIDTH{ 24 };
        static constexpr short SUDOKU_SMALLEST_NUM{ 1 };
        static constexpr short SUDOKU_BIGGEST_NUM{ 9 };
+       static constexpr short SOLVE_AHEAD{ 3 };    //!< # of upcoming boards solved in the background.
 
     };
 
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "corpus_stats.h"
+#include "board_geometry.h"
+#include "sudoku_solver.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr short N_CELLS{ CorpusStats::N_CELLS };
+        constexpr short LAST{ Config::SB_SIZE - 1 };
+
+        inline uint64_t rotl( uint64_t x, int r ) { return (x << r) | (x >> (64 - r)); }
+
+        /// 64-bit hash of the 81 values of a board (murmur-style mixing of 8-byte words).
+        uint64_t hash_cells( const uint8_t (&cells)[N_CELLS] ) {
+            constexpr uint64_t K1{ 0x87C37B91114253D5ull }, K2{ 0x4CF5AD432745937Full };
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (size_t at{0}; at < sizeof cells; at += sizeof(uint64_t)) {
+                uint64_t word = 0;
+                std::memcpy(&word, cells + at, std::min(sizeof(uint64_t), sizeof cells - at));
+                h ^= rotl(word * K1, 31) * K2;
+                h = rotl(h, 27) * 5 + 0x52DCE729;
+            }
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ull;
+            return h ^ (h >> 33);
+        }
+
+        /// Where a location goes under each symmetry, in the order of symmetry_e.
+        inline short image( short cell, size_t symmetry ) {
+            short l = GEOMETRY.line[cell], c = GEOMETRY.column[cell];
+            switch (symmetry) {
+                case 0: return BoardGeometry::cell_of((short) (LAST - l), (short) (LAST - c));
+                case 1: return BoardGeometry::cell_of(c, (short) (LAST - l));
+                case 2: return BoardGeometry::cell_of((short) (LAST - l), c);
+                case 3: return BoardGeometry::cell_of(l, (short) (LAST - c));
+                case 4: return BoardGeometry::cell_of(c, l);
+                default: return BoardGeometry::cell_of((short) (LAST - c), (short) (LAST - l));
+            }
+        }
+
+        void write_json_array( std::ostream &out, const uint64_t *values, size_t n ) {
+            out << "[";
+            for (size_t k{0}; k < n; k++) out << (k > 0 ? ", " : "") << values[k];
+            out << "]";
+        }
+    }
+
+    void CorpusStats::Sketch::add(uint64_t hash) {
+        size_t idx = hash >> (64 - SKETCH_BITS);
+        // rank of the first 1 bit in the rest of the hash; the sentinel bounds it
+        auto rank = (uint8_t) (__builtin_clzll((hash << SKETCH_BITS) | (1ull << (SKETCH_BITS - 1))) + 1);
+        registers[idx] = std::max(registers[idx], rank);
+    }
+
+    void CorpusStats::Sketch::merge(const Sketch &other) {
+        for (size_t r{0}; r < sizeof registers; r++) registers[r] = std::max(registers[r], other.registers[r]);
+    }
+
+    double CorpusStats::Sketch::estimate() const {
+        constexpr double M{ 1u << SKETCH_BITS };
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t r : registers) {
+            sum += std::ldexp(1.0, -r);
+            zeros += r == 0;
+        }
+        double estimate = 0.7213 / (1 + 1.079 / M) * M * M / sum;
+        // few distinct values: linear counting of the empty registers is exact enough
+        if (estimate <= 2.5 * M and zeros > 0) estimate = M * std::log(M / (double) zeros);
+        return estimate;
+    }
+
+    void CorpusStats::add(const SBoard &board) {
+        for (short cell{0}; cell < N_CELLS; cell++) {
+            short value = board.at(GEOMETRY.line[cell], GEOMETRY.column[cell]);
+            if (value > Config::SB_SIZE or value < -Config::SB_SIZE) {
+                m_malformed++;
+                return;
+            }
+        }
+        bool clue[N_CELLS];
+        uint8_t cells[N_CELLS], relabeled[N_CELLS];
+        uint8_t label[Config::SB_SIZE + 1]{};
+        uint8_t next_label = 1;
+        short clues = 0;
+        short unit_givens[BoardGeometry::N_UNITS]{};
+        for (short cell{0}; cell < N_CELLS; cell++) {
+            short value = board.at(GEOMETRY.line[cell], GEOMETRY.column[cell]);
+            clue[cell] = value > 0;
+            cells[cell] = relabeled[cell] = 0;
+            if (not clue[cell]) continue;
+            clues++;
+            m_digits[value]++;
+            for (uint8_t u : GEOMETRY.cell_units[cell]) unit_givens[u]++;
+            // digits renamed in order of first appearance: boards equal up to a relabeling get the same cells
+            if (label[value] == 0) label[value] = next_label++;
+            cells[cell] = (uint8_t) value;
+            relabeled[cell] = label[value];
+        }
+        m_boards++;
+        m_clues[clues]++;
+        for (short u{0}; u < BoardGeometry::N_UNITS; u++) m_unit_givens[u / Config::SB_SIZE][unit_givens[u]]++;
+        m_symmetry[symmetry_class(clue)]++;
+        m_distinct.add(hash_cells(cells));
+        m_distinct_relabeled.add(hash_cells(relabeled));
+
+        if (not m_solve) return;
+        SudokuSolver solver{ board };
+        size_t found = solver.is_consistent() ? solver.count_solutions(2) : 0;
+        m_solutions[found == 0 ? NO_SOLUTION : found == 1 ? UNIQUE : SEVERAL]++;
+        uint64_t guesses = solver.stats().guesses;
+        size_t bucket = guesses == 0 ? 0 : (size_t) (64 - __builtin_clzll(guesses));
+        m_effort[std::min(bucket, N_EFFORT_BUCKETS - 1)]++;
+        m_guesses += guesses;
+        m_max_guesses = std::max(m_max_guesses, guesses);
+        m_nodes += solver.stats().nodes;
+    }
+
+    void CorpusStats::merge(const CorpusStats &other) {
+        auto add_all = []( uint64_t *into, const uint64_t *from, size_t n ) {
+            for (size_t k{0}; k < n; k++) into[k] += from[k];
+        };
+        m_boards += other.m_boards;
+        m_malformed += other.m_malformed;
+        add_all(m_clues, other.m_clues, N_CELLS + 1);
+        add_all(m_digits, other.m_digits, Config::SB_SIZE + 1);
+        for (size_t kind{0}; kind < 3; kind++) add_all(m_unit_givens[kind], other.m_unit_givens[kind], Config::SB_SIZE + 1);
+        add_all(m_symmetry, other.m_symmetry, N_SYMMETRY_CLASSES);
+        add_all(m_solutions, other.m_solutions, N_SOLUTION_KINDS);
+        add_all(m_effort, other.m_effort, N_EFFORT_BUCKETS);
+        m_guesses += other.m_guesses;
+        m_max_guesses = std::max(m_max_guesses, other.m_max_guesses);
+        m_nodes += other.m_nodes;
+        m_distinct.merge(other.m_distinct);
+        m_distinct_relabeled.merge(other.m_distinct_relabeled);
+    }
+
+    uint8_t CorpusStats::symmetry_class(const bool (&clue)[N_CELLS]) {
+        uint8_t symmetries = 0;
+        for (size_t s{0}; s < N_SYMMETRIES; s++) {
+            bool kept = true;
+            for (short cell{0}; cell < N_CELLS and kept; cell++) kept = clue[cell] == clue[image(cell, s)];
+            if (kept) symmetries |= (uint8_t) (1u << s);
+        }
+        return symmetries;
+    }
+
+    string CorpusStats::symmetry_name(size_t symmetry_class) {
+        static constexpr const char *NAMES[N_SYMMETRIES]{
+            "rotate-180", "rotate-90", "mirror-lines", "mirror-columns", "diagonal", "anti-diagonal"
+        };
+        string name;
+        for (size_t s{0}; s < N_SYMMETRIES; s++) {
+            if ((symmetry_class & (1u << s)) == 0) continue;
+            if (not name.empty()) name += '+';
+            name += NAMES[s];
+        }
+        return name.empty() ? "none" : name;
+    }
+
+    double CorpusStats::mean_clues() const {
+        uint64_t sum = 0;
+        for (short n{0}; n <= N_CELLS; n++) sum += (uint64_t) n * m_clues[n];
+        return m_boards != 0 ? (double) sum / (double) m_boards : 0.0;
+    }
+
+    double CorpusStats::mean_guesses() const {
+        return m_boards != 0 ? (double) m_guesses / (double) m_boards : 0.0;
+    }
+
+    double CorpusStats::duplicate_rate(bool relabeled) const {
+        if (m_boards == 0) return 0.0;
+        double distinct = std::min((relabeled ? m_distinct_relabeled : m_distinct).estimate(), (double) m_boards);
+        return 1.0 - distinct / (double) m_boards;
+    }
+
+    void CorpusStats::write_csv(std::ostream &out) const {
+        static constexpr const char *UNIT_KINDS[3]{ "rows", "columns", "boxes" };
+        static constexpr const char *SOLUTION_KINDS[N_SOLUTION_KINDS]{ "none", "unique", "several" };
+        out << "metric,key,value\n"
+            << "boards,all," << m_boards << "\n"
+            << "boards,malformed," << m_malformed << "\n";
+        for (short n{0}; n <= N_CELLS; n++) {
+            if (m_clues[n] != 0) out << "clues," << n << "," << m_clues[n] << "\n";
+        }
+        for (short d{1}; d <= Config::SB_SIZE; d++) out << "digit," << d << "," << m_digits[d] << "\n";
+        for (size_t kind{0}; kind < 3; kind++) {
+            for (short n{0}; n <= Config::SB_SIZE; n++) {
+                out << "givens_per_" << UNIT_KINDS[kind] << "," << n << "," << m_unit_givens[kind][n] << "\n";
+            }
+        }
+        for (size_t c{0}; c < N_SYMMETRY_CLASSES; c++) {
+            if (m_symmetry[c] != 0) out << "symmetry," << symmetry_name(c) << "," << m_symmetry[c] << "\n";
+        }
+        if (m_solve) {
+            for (size_t k{0}; k < N_SOLUTION_KINDS; k++) out << "solutions," << SOLUTION_KINDS[k] << "," << m_solutions[k] << "\n";
+            for (size_t b{0}; b < N_EFFORT_BUCKETS; b++) {
+                // key: the most guesses of the bucket
+                if (m_effort[b] != 0) out << "guesses_at_most," << (b == 0 ? 0 : (1ull << b) - 1) << "," << m_effort[b] << "\n";
+            }
+            out << "guesses,mean," << mean_guesses() << "\n"
+                << "guesses,max," << m_max_guesses << "\n"
+                << "nodes,mean," << (m_boards != 0 ? (double) m_nodes / (double) m_boards : 0.0) << "\n";
+        }
+        out << "duplicate_rate,exact," << duplicate_rate(false) << "\n"
+            << "duplicate_rate,relabeled," << duplicate_rate(true) << "\n";
+    }
+
+    void CorpusStats::write_json(std::ostream &out) const {
+        out << "{\n  \"boards\": " << m_boards << ",\n  \"malformed\": " << m_malformed << ",\n"
+            << "  \"clues\": {\"mean\": " << mean_clues() << ", \"histogram\": {";
+        bool first = true;
+        for (short n{0}; n <= N_CELLS; n++) {
+            if (m_clues[n] == 0) continue;
+            out << (first ? "" : ", ") << "\"" << n << "\": " << m_clues[n];
+            first = false;
+        }
+        out << "}},\n  \"digits\": ";
+        write_json_array(out, m_digits + 1, Config::SB_SIZE);
+        out << ",\n  \"givens_per_unit\": {\"rows\": ";
+        write_json_array(out, m_unit_givens[0], Config::SB_SIZE + 1);
+        out << ", \"columns\": ";
+        write_json_array(out, m_unit_givens[1], Config::SB_SIZE + 1);
+        out << ", \"boxes\": ";
+        write_json_array(out, m_unit_givens[2], Config::SB_SIZE + 1);
+        out << "},\n  \"symmetry\": {";
+        first = true;
+        for (size_t c{0}; c < N_SYMMETRY_CLASSES; c++) {
+            if (m_symmetry[c] == 0) continue;
+            out << (first ? "" : ", ") << "\"" << symmetry_name(c) << "\": " << m_symmetry[c];
+            first = false;
+        }
+        out << "},\n";
+        if (m_solve) {
+            size_t last = N_EFFORT_BUCKETS;
+            while (last > 1 and m_effort[last - 1] == 0) last--;
+            out << "  \"solver\": {\"no_solution\": " << m_solutions[NO_SOLUTION] << ", \"unique\": " << m_solutions[UNIQUE]
+                << ", \"several\": " << m_solutions[SEVERAL] << ", \"mean_guesses\": " << mean_guesses()
+                << ", \"max_guesses\": " << m_max_guesses << ", \"mean_nodes\": "
+                << (m_boards != 0 ? (double) m_nodes / (double) m_boards : 0.0) << ",\n"
+                << "             \"guesses_log2_histogram\": ";
+            write_json_array(out, m_effort, last);
+            out << "},\n";
+        }
+        out << "  \"duplicate_rate\": {\"exact\": " << duplicate_rate(false) << ", \"relabeled\": "
+            << duplicate_rate(true) << "}\n}\n";
+    }
+}
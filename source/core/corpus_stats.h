@@ -0,0 +1,118 @@
+#ifndef SUDOKU_CORPUS_STATS_H
+#define SUDOKU_CORPUS_STATS_H
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+using std::string;
+#include "sudoku_board.h"
+
+/*!
+ *  Statistics of a puzzle corpus, to audit puzzle files and feeds.
+ *
+ *  Every board added is counted into fixed-size histograms:
+ *
+ *  + clues per board, and clues of every digit;
+ *  + clues per unit (row, column, box);
+ *  + symmetry class of the clue pattern: which of the 180 and 90 degree
+ *    rotations, mirrors and diagonal reflections leave it unchanged;
+ *  + solver effort: solutions (none, unique, several) and guesses, counted
+ *    up to the second solution like a uniqueness check;
+ *  + distinct boards, as is and up to a relabeling of the digits, estimated
+ *    with HyperLogLog sketches (within ~1%, in 16 KiB whatever the corpus
+ *    size), giving the duplicate rates.
+ *
+ *  Nothing grows with the # of boards, so corpora larger than RAM are
+ *  streamed through, and stats of separate parts (threads, files) merge
+ *  into the stats of the whole.
+ *
+ *  How to use it:
+ *  ```c++
+ *      CorpusStats part;                   // one per thread
+ *      while (read_board(in, sb)) part.add(sb);
+ *      total.merge(part);
+ *      total.write_json(std::cout);
+ *  ```
+ */
+
+namespace sdkg {
+
+    class CorpusStats {
+        public:
+            static constexpr short N_CELLS{ Config::SB_SIZE * Config::SB_SIZE };
+            static constexpr size_t N_EFFORT_BUCKETS{ 32 };     //!< Bucket k > 0 counts guesses in [2^(k-1), 2^k).
+            static constexpr unsigned SKETCH_BITS{ 14 };        //!< 2^14 HyperLogLog registers, ~0.8% error.
+
+            /// Symmetries of a clue pattern, a class is any combination of them.
+            enum symmetry_e : uint8_t {
+                ROTATE_180 = 1,
+                ROTATE_90 = 2,
+                MIRROR_LINES = 4,       //!< Top-bottom reflection.
+                MIRROR_COLUMNS = 8,     //!< Left-right reflection.
+                DIAGONAL = 16,          //!< Transposition.
+                ANTI_DIAGONAL = 32,
+                N_SYMMETRIES = 6
+            };
+            static constexpr size_t N_SYMMETRY_CLASSES{ 1u << N_SYMMETRIES };
+
+            /// Outcome of the uniqueness check.
+            enum solutions_e : uint8_t { NO_SOLUTION = 0, UNIQUE, SEVERAL, N_SOLUTION_KINDS };
+
+        private:
+            /// HyperLogLog distinct count sketch.
+            struct Sketch {
+                uint8_t registers[1u << SKETCH_BITS]{};
+
+                void add( uint64_t hash );
+                void merge( const Sketch &other );
+                double estimate() const;
+            };
+
+            bool m_solve;
+            uint64_t m_boards = 0;
+            uint64_t m_malformed = 0;
+            uint64_t m_clues[N_CELLS + 1]{};                        //!< Boards by # of clues.
+            uint64_t m_digits[Config::SB_SIZE + 1]{};               //!< Clues by digit.
+            uint64_t m_unit_givens[3][Config::SB_SIZE + 1]{};       //!< Rows, columns and boxes by # of clues.
+            uint64_t m_symmetry[N_SYMMETRY_CLASSES]{};              //!< Boards by symmetry class.
+            uint64_t m_solutions[N_SOLUTION_KINDS]{};
+            uint64_t m_effort[N_EFFORT_BUCKETS]{};                  //!< Boards by guesses, log2 buckets.
+            uint64_t m_guesses = 0;
+            uint64_t m_max_guesses = 0;
+            uint64_t m_nodes = 0;
+            Sketch m_distinct;
+            Sketch m_distinct_relabeled;
+
+        public:
+            // `solve` = false skips the solver effort, by far the most expensive part.
+            explicit CorpusStats( bool solve=true ) : m_solve{solve} {}
+
+            // Counts a board; positive values are its clues, anything else is to find.
+            // A board with values outside [-9, 9] counts as malformed.
+            void add( const SBoard &board );
+            inline void add_malformed() { m_malformed++; }
+
+            // Adds the counts of stats made from another part of the corpus.
+            void merge( const CorpusStats &other );
+
+            static uint8_t symmetry_class( const bool (&clue)[N_CELLS] );
+            // Names of the symmetries of a class joined by '+', e.g. "rotate-180+mirror-lines", or "none".
+            static string symmetry_name( size_t symmetry_class );
+
+            inline uint64_t boards() const { return m_boards; }
+            inline uint64_t malformed() const { return m_malformed; }
+            inline uint64_t clues( short n ) const { return m_clues[n]; }
+            inline uint64_t solutions( solutions_e kind ) const { return m_solutions[kind]; }
+            inline uint64_t max_guesses() const { return m_max_guesses; }
+            double mean_clues() const;
+            double mean_guesses() const;
+            // Share of the boards that repeat an earlier one, as is or up to a relabeling of the digits.
+            double duplicate_rate( bool relabeled ) const;
+
+            // Writes every histogram as `metric,key,value` lines, or as a JSON object.
+            void write_csv( std::ostream &out ) const;
+            void write_json( std::ostream &out ) const;
+    };
+}
+
+#endif //SUDOKU_CORPUS_STATS_H
@@ -0,0 +1,271 @@
+#include "cp_solver.h"
+
+namespace sdkg {
+
+    namespace {
+        /// Position of a location among the 9 locations of one of its units (k = 0 row, 1 column, 2 box).
+        inline short position_in_unit( short cell, short k ) {
+            switch (k) {
+                case 0: return GEOMETRY.column[cell];
+                case 1: return GEOMETRY.line[cell];
+                default: return (short) ((GEOMETRY.line[cell] % BoardGeometry::BOX_SIZE) * BoardGeometry::BOX_SIZE
+                                         + GEOMETRY.column[cell] % BoardGeometry::BOX_SIZE);
+            }
+        }
+
+        /// The Luby sequence 1 1 2 1 1 2 4 1 1 2 ..., i from 1.
+        size_t luby( size_t i ) {
+            size_t size = 1;
+            while (size < i + 1) size = 2 * size + 1;
+            while (size > 1) {
+                size /= 2;
+                if (i > size) i -= size;
+                else if (i == size) return (size + 1) / 2;
+            }
+            return 1;
+        }
+
+        constexpr size_t RESTART_BASE{ 100 };   //!< Failures per Luby unit between restarts.
+    }
+
+    CpSolver::CpSolver(const SBoard &puzzle) {
+        for (mask_t &dom : m_state.dom) dom = ALL_DIGITS;
+        for (unsigned &w : m_weight) w = 1;
+        // with every domain full any two positions support every digit
+        for (auto &unit : m_watch) {
+            for (auto &watch : unit) {
+                watch[0] = 0;
+                watch[1] = 1;
+            }
+        }
+        for (short cell{0}; cell < N_CELLS; cell++) {
+            short digit = puzzle.at(GEOMETRY.line[cell], GEOMETRY.column[cell]);
+            if (digit < Config::SUDOKU_SMALLEST_NUM) continue;
+            if (digit > Config::SUDOKU_BIGGEST_NUM) {
+                m_consistent = false;
+                continue;
+            }
+            remove(cell, (mask_t) (ALL_DIGITS & ~(1u << digit)), -1);
+        }
+        m_state.dirty = (1u << N_UNITS) - 1;
+        m_consistent = m_consistent and propagate();
+    }
+
+    bool CpSolver::remove(short cell, mask_t digits, short unit) {
+        digits &= m_state.dom[cell];
+        if (digits == 0) return true;
+        m_state.dom[cell] &= (mask_t) ~digits;
+        if (m_removed[cell] == 0) m_queue[m_queued++] = cell;
+        m_removed[cell] |= digits;
+        m_state.dirty |= GEOMETRY.unit_mask[cell];
+        if (m_state.dom[cell] != 0) return true;
+        if (unit >= 0) m_weight[unit]++;
+        return false;
+    }
+
+    bool CpSolver::propagate_removal(short cell, mask_t removed) {
+        mask_t dom = m_state.dom[cell];
+        if ((dom & (dom - 1)) == 0) {
+            // fixed: nobody else in its units may take the digit
+            for (uint8_t peer : GEOMETRY.peers[cell]) {
+                if ((m_state.dom[peer] & dom) == 0) continue;
+                m_stats.propagations++;
+                if (not remove(peer, dom, (short) __builtin_ctz(GEOMETRY.unit_mask[cell] & GEOMETRY.unit_mask[peer]))) return false;
+            }
+        }
+        for (short k{0}; k < 3; k++) {
+            short unit = GEOMETRY.cell_units[cell][k], pos = position_in_unit(cell, k);
+            for (mask_t left = removed; left; left &= (mask_t) (left - 1)) {
+                auto digit = (short) __builtin_ctz(left);
+                auto bit = (mask_t) (1u << digit);
+                uint8_t *watch = m_watch[unit][digit];
+                if (watch[0] != pos and watch[1] != pos) continue;
+                short w = watch[0] == pos ? 0 : 1, other = watch[1 - w];
+                short next = 0;
+                while (next < Config::SB_SIZE and (next == other or (m_state.dom[GEOMETRY.units[unit][next]] & bit) == 0)) next++;
+                if (next < Config::SB_SIZE) {
+                    watch[w] = (uint8_t) next;
+                    continue;
+                }
+                // the other watch is the last location of the unit that may take the digit
+                short last = GEOMETRY.units[unit][other];
+                if ((m_state.dom[last] & bit) == 0) {
+                    m_weight[unit]++;
+                    return false;
+                }
+                if (m_state.dom[last] != bit) {
+                    m_stats.propagations++;
+                    remove(last, (mask_t) (m_state.dom[last] & ~bit), unit);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool CpSolver::filter_unit(short unit) {
+        const uint8_t *cells = GEOMETRY.units[unit];
+        mask_t dom[Config::SB_SIZE];
+        short var_of[Config::SB_SIZE + 1], digit_of[Config::SB_SIZE];
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            dom[i] = m_state.dom[cells[i]];
+            digit_of[i] = -1;
+            var_of[i + 1] = -1;
+        }
+        // maximum matching between the locations and the digits, by augmenting paths
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            mask_t visited = 0;
+            auto augment = [&]( auto &self, short var ) -> bool {
+                for (mask_t cand = (mask_t) (dom[var] & ~visited); cand; cand &= (mask_t) (cand - 1)) {
+                    auto digit = (short) __builtin_ctz(cand);
+                    visited |= (mask_t) (1u << digit);
+                    if (var_of[digit] < 0 or self(self, var_of[digit])) {
+                        var_of[digit] = var;
+                        digit_of[var] = digit;
+                        return true;
+                    }
+                }
+                return false;
+            };
+            if (not augment(augment, i)) {
+                m_weight[unit]++;
+                return false;
+            }
+        }
+        // the matching is perfect, so a digit is consistent with a location iff it is matched to it or
+        // matched to a location of the same strongly connected component (i -> j if i may take j's digit)
+        uint16_t reach[Config::SB_SIZE];
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            reach[i] = (uint16_t) (1u << i);
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                if (dom[i] & (1u << digit_of[j])) reach[i] |= (uint16_t) (1u << j);
+            }
+        }
+        for (short k{0}; k < Config::SB_SIZE; k++) {
+            for (short i{0}; i < Config::SB_SIZE; i++) {
+                if (reach[i] & (1u << k)) reach[i] |= reach[k];
+            }
+        }
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            mask_t allowed = 0;
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                if ((reach[i] & (1u << j)) and (reach[j] & (1u << i))) allowed |= (mask_t) (1u << digit_of[j]);
+            }
+            mask_t pruned = (mask_t) (dom[i] & ~allowed);
+            if (pruned == 0) continue;
+            m_stats.prunings += (size_t) __builtin_popcount(pruned);
+            remove(cells[i], pruned, unit);     // never empties the domain: the matched digit stays
+        }
+        return true;
+    }
+
+    bool CpSolver::propagate() {
+        while (true) {
+            bool ok = true;
+            while (ok and m_queued > 0) {
+                short cell = m_queue[--m_queued];
+                mask_t removed = m_removed[cell];
+                m_removed[cell] = 0;
+                ok = propagate_removal(cell, removed);
+            }
+            if (ok and m_state.dirty != 0) {
+                // the cheap rules reached their fixpoint, run the matching filter on one touched unit
+                auto unit = (short) __builtin_ctz(m_state.dirty);
+                m_state.dirty &= ~(1u << unit);
+                ok = filter_unit(unit);
+                if (ok) continue;
+            }
+            if (ok) return true;
+            while (m_queued > 0) m_removed[m_queue[--m_queued]] = 0;
+            m_stats.failures++;
+            return false;
+        }
+    }
+
+    short CpSolver::pick_cell() const {
+        short best = -1;
+        unsigned best_size = 0, best_weight = 1;
+        for (short cell{0}; cell < N_CELLS; cell++) {
+            auto size = (unsigned) __builtin_popcount(m_state.dom[cell]);
+            if (size <= 1) continue;
+            const uint8_t *units = GEOMETRY.cell_units[cell];
+            unsigned weight = m_weight[units[0]] + m_weight[units[1]] + m_weight[units[2]];
+            // size / weight < best_size / best_weight
+            if (best < 0 or size * best_weight < best_size * weight) {
+                best = cell;
+                best_size = size;
+                best_weight = weight;
+            }
+        }
+        return best;
+    }
+
+    CpSolver::search_e CpSolver::search_first() {
+        m_stats.nodes++;
+        short cell = pick_cell();
+        if (cell < 0) return FOUND;
+        auto bit = (mask_t) (m_state.dom[cell] & -m_state.dom[cell]);
+        State saved = m_state;
+        // binary branching: the location takes its smallest digit, or it does not
+        remove(cell, (mask_t) (m_state.dom[cell] & ~bit), -1);
+        if (propagate()) {
+            search_e found = search_first();
+            if (found != EXHAUSTED) return found;
+        }
+        m_state = saved;
+        if (m_fail_limit != 0 and m_stats.failures >= m_fail_limit) return RESTART;
+        remove(cell, bit, -1);
+        if (not propagate()) return EXHAUSTED;
+        return search_first();
+    }
+
+    size_t CpSolver::search_count(size_t limit) {
+        m_stats.nodes++;
+        short cell = pick_cell();
+        if (cell < 0) return 1;
+        auto bit = (mask_t) (m_state.dom[cell] & -m_state.dom[cell]);
+        State saved = m_state;
+        size_t count = 0;
+        remove(cell, (mask_t) (m_state.dom[cell] & ~bit), -1);
+        if (propagate()) count = search_count(limit);
+        m_state = saved;
+        if (limit != 0 and count >= limit) return count;
+        remove(cell, bit, -1);
+        if (propagate()) count += search_count(limit == 0 ? 0 : limit - count);
+        m_state = saved;
+        return count;
+    }
+
+    bool CpSolver::solve(SBoard &solution) {
+        if (not m_consistent) return false;
+        State root = m_state;
+        for (size_t run{1}; ; run++) {
+            m_fail_limit = m_stats.failures + RESTART_BASE * luby(run);
+            search_e found = search_first();
+            if (found == RESTART) {
+                m_state = root;
+                m_stats.restarts++;
+                continue;
+            }
+            m_fail_limit = 0;
+            if (found == FOUND) {
+                to_board(solution);
+                return true;
+            }
+            m_state = root;
+            return false;
+        }
+    }
+
+    size_t CpSolver::count_solutions(size_t limit) {
+        if (not m_consistent) return 0;
+        m_fail_limit = 0;
+        return search_count(limit);
+    }
+
+    void CpSolver::to_board(SBoard &sb) const {
+        for (short cell{0}; cell < N_CELLS; cell++) {
+            mask_t dom = m_state.dom[cell];
+            sb.set_loc(GEOMETRY.line[cell], GEOMETRY.column[cell], dom != 0 and (dom & (dom - 1)) == 0 ? (short) __builtin_ctz(dom) : 0);
+        }
+    }
+}
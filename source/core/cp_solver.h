@@ -0,0 +1,104 @@
+#ifndef SUDOKU_CP_SOLVER_H
+#define SUDOKU_CP_SOLVER_H
+#include <cstdint>
+#include <cstddef>
+#include "config.h"
+#include "sudoku_board.h"
+#include "board_geometry.h"
+
+/*!
+ *  Constraint programming solver for the 9x9 board, meant for the puzzles
+ *  where SudokuSolver's plain backtracking stalls.
+ *
+ *  Every location is a variable with a 9-bit domain and every unit is an
+ *  all-different constraint, propagated by three layers:
+ *  + a fixed location removes its digit from its peers (naked singles);
+ *  + each (unit, digit) pair watches two locations that may still take the
+ *    digit, like the two watched literals of a SAT clause: a removal only
+ *    costs work when it hits a watch, the watches never move back on
+ *    backtracking, and a single support left forces the digit (hidden single);
+ *  + Régin's matching-based filtering on the units touched since the last
+ *    fixpoint drops every digit that belongs to no perfect matching between
+ *    the unit's locations and digits (pairs, triples, ... at once).
+ *
+ *  Search branches on the location minimizing domain size / weighted degree
+ *  (dom/wdeg): every failure bumps the weight of the unit that failed, so the
+ *  search learns where the conflicts are. `solve` restarts on a Luby schedule
+ *  keeping the learned weights; `count_solutions` runs one exhaustive search.
+ *
+ *  Positive values of the input board are taken as givens, any value `<= 0`
+ *  (empty or hidden location) is a location the solver has to fill.
+ */
+
+namespace sdkg {
+
+    class CpSolver {
+        public:
+            /// Counters describing how much work the last search did.
+            struct Stats {
+                size_t nodes = 0;           //!< # of search nodes visited.
+                size_t failures = 0;        //!< # of dead ends found by propagation.
+                size_t propagations = 0;    //!< # of digits removed from domains by the singles rules.
+                size_t prunings = 0;        //!< # of digits removed by the matching-based filtering.
+                size_t restarts = 0;        //!< # of restarts of `solve`.
+            };
+
+            typedef uint16_t mask_t;    //!< Bit `d` set means digit `d` is still possible.
+
+        private:
+            static constexpr short N_CELLS{ BoardGeometry::N_CELLS };
+            static constexpr short N_UNITS{ BoardGeometry::N_UNITS };
+            static constexpr mask_t ALL_DIGITS{ 0x3FE };    //!< Bits 1 to 9 set.
+
+            /// Search state, copied on every branch (the watches are not part of it).
+            struct State {
+                mask_t dom[N_CELLS];        //!< Domain of every location.
+                uint32_t dirty = 0;         //!< Units whose domains changed since their last matching filter.
+            };
+
+            State m_state;
+            uint8_t m_watch[N_UNITS][Config::SB_SIZE + 1][2]{}; //!< Two positions in the unit watching each digit.
+            unsigned m_weight[N_UNITS]{};                       //!< Failures seen per unit (dom/wdeg).
+            short m_queue[N_CELLS]{};                           //!< Locations with pending removals.
+            mask_t m_removed[N_CELLS]{};                        //!< Digits removed and not processed yet.
+            short m_queued = 0;
+            bool m_consistent = true;                           //!< False if the givens already break the rules.
+            size_t m_fail_limit = 0;                            //!< Failures allowed before a restart, 0 = none.
+            Stats m_stats;
+
+            // Removes `digits` from a domain, returns false on an empty domain (blaming `unit`).
+            bool remove( short cell, mask_t digits, short unit );
+            // Runs the propagators to a fixpoint, returns false on a conflict.
+            bool propagate();
+            bool propagate_removal( short cell, mask_t removed );
+            bool filter_unit( short unit );
+
+            short pick_cell() const;
+
+            enum search_e { FOUND, EXHAUSTED, RESTART };
+            search_e search_first();
+            size_t search_count( size_t limit );
+
+        public:
+            explicit CpSolver( const SBoard &puzzle );
+
+            // Finds a solution, returns false if there is none.
+            bool solve( SBoard &solution );
+
+            // Counts solutions, stopping as soon as `limit` solutions were found (0 = all).
+            size_t count_solutions( size_t limit );
+
+            // Copies the fixed values to a board (empty locations are 0).
+            void to_board( SBoard &sb ) const;
+
+            // Tells if the givens do not break any rule, propagation included.
+            inline bool is_consistent() const { return m_consistent; }
+
+            inline const Stats & stats() const { return m_stats; }
+
+            // Domain of a location after the root propagation (or the last search).
+            inline mask_t domain( short line, short column ) const { return m_state.dom[BoardGeometry::cell_of(line, column)]; }
+    };
+}
+
+#endif //SUDOKU_CP_SOLVER_H
@@ -0,0 +1,147 @@
+#include "difficulty.h"
+#include "board_geometry.h"
+#include "sudoku_solver.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr short N_CELLS{ BoardGeometry::N_CELLS };
+        constexpr uint16_t ALL_DIGITS{ 0x3FE };     // bits 1 to 9
+
+        /// Fills the clues of a board with singles only, telling the hardest kind it needed.
+        class SinglesSolver {
+            private:
+                short m_cells[N_CELLS]{};
+                uint16_t m_used[BoardGeometry::N_UNITS]{};  //!< Digits placed in every unit.
+                short m_empty = 0;
+
+                inline uint16_t candidates( short cell ) const {
+                    const uint8_t *units = GEOMETRY.cell_units[cell];
+                    return (uint16_t) (ALL_DIGITS & ~(m_used[units[0]] | m_used[units[1]] | m_used[units[2]]));
+                }
+
+                void place( short cell, short digit ) {
+                    m_cells[cell] = digit;
+                    for (uint8_t u : GEOMETRY.cell_units[cell]) m_used[u] |= (uint16_t) (1u << digit);
+                    m_empty--;
+                }
+
+                static short digit_of( uint16_t mask ) { return (short) __builtin_ctz(mask); }
+
+                // Places every naked single found in one sweep; false if there was none (or a dead end).
+                bool naked_singles( bool &dead_end ) {
+                    bool placed = false;
+                    for (short cell{0}; cell < N_CELLS; cell++) {
+                        if (m_cells[cell] != 0) continue;
+                        uint16_t cand = candidates(cell);
+                        if (cand == 0) {
+                            dead_end = true;
+                            return false;
+                        }
+                        if ((cand & (cand - 1)) == 0) {
+                            place(cell, digit_of(cand));
+                            placed = true;
+                        }
+                    }
+                    return placed;
+                }
+
+                // Places the first hidden single found; false if there is none.
+                bool hidden_single() {
+                    for (const uint8_t *unit : GEOMETRY.units) {
+                        uint16_t once = 0, more = 0;
+                        for (short k{0}; k < Config::SB_SIZE; k++) {
+                            if (m_cells[unit[k]] != 0) continue;
+                            uint16_t cand = candidates(unit[k]);
+                            more |= once & cand;
+                            once |= cand;
+                        }
+                        uint16_t single = (uint16_t) (once & ~more);
+                        if (single == 0) continue;
+                        short digit = digit_of(single);
+                        for (short k{0}; k < Config::SB_SIZE; k++) {
+                            if (m_cells[unit[k]] == 0 and (candidates(unit[k]) & (1u << digit)) != 0) {
+                                place(unit[k], digit);
+                                return true;
+                            }
+                        }
+                    }
+                    return false;
+                }
+
+            public:
+                explicit SinglesSolver( BoardView board ) {
+                    m_empty = N_CELLS;
+                    for (short cell{0}; cell < N_CELLS; cell++) {
+                        short value = board.cells()[cell];
+                        if (value > 0) place(cell, value);
+                    }
+                }
+
+                inline short clues() const { return (short) (N_CELLS - m_empty); }
+
+                technique_e solve() {
+                    technique_e hardest = technique_e::NAKED_SINGLE;
+                    bool dead_end = false;
+                    while (m_empty > 0) {
+                        if (naked_singles(dead_end)) continue;
+                        if (dead_end or not hidden_single()) return technique_e::GUESSING;
+                        hardest = technique_e::HIDDEN_SINGLE;
+                    }
+                    return hardest;
+                }
+        };
+    }
+
+    DifficultyBuckets::DifficultyBuckets(const BoardPool &boards) {
+        boards.scan(0, boards.size(), [this]( size_t idx, BoardView board ) {
+            m_buckets[(size_t) classify(rate(board))].push_back((uint32_t) idx);
+        });
+    }
+
+    void DifficultyBuckets::append(const DifficultyBuckets &other, uint32_t offset) {
+        for (size_t l{0}; l < N_LEVELS; l++) {
+            for (uint32_t idx : other.m_buckets[l]) m_buckets[l].push_back(offset + idx);
+        }
+    }
+
+    DifficultyFeatures DifficultyBuckets::rate(BoardView board) {
+        DifficultyFeatures features;
+        SinglesSolver singles{ board };
+        features.clues = singles.clues();
+        features.hardest = singles.solve();
+        if (features.hardest == technique_e::GUESSING) {
+            SBoard puzzle, solution;
+            board.copy_to(puzzle);
+            SudokuSolver solver{ puzzle };
+            // past the hard limit the board is expert whatever the count: no need to finish the search
+            solver.set_guess_limit(HARD_MAX_GUESSES);
+            solver.solve(solution);
+            features.guesses = solver.stats().guesses;
+        }
+        return features;
+    }
+
+    difficulty_e DifficultyBuckets::classify(const DifficultyFeatures &features) {
+        if (features.hardest == technique_e::NAKED_SINGLE) {
+            return features.clues >= EASY_MIN_CLUES ? difficulty_e::EASY : difficulty_e::MEDIUM;
+        }
+        if (features.hardest == technique_e::HIDDEN_SINGLE) return difficulty_e::MEDIUM;
+        return features.guesses <= HARD_MAX_GUESSES ? difficulty_e::HARD : difficulty_e::EXPERT;
+    }
+
+    const char * DifficultyBuckets::name(difficulty_e level) {
+        static constexpr const char *NAMES[N_LEVELS]{ "easy", "medium", "hard", "expert" };
+        return NAMES[(size_t) level];
+    }
+
+    bool DifficultyBuckets::parse(const string &name, difficulty_e &level) {
+        for (size_t l{0}; l < N_LEVELS; l++) {
+            if (name == DifficultyBuckets::name((difficulty_e) l)) {
+                level = (difficulty_e) l;
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef SUDOKU_DIFFICULTY_H
+#define SUDOKU_DIFFICULTY_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include "board_pool.h"
+
+/*!
+ *  Puzzle difficulty, rated once when the boards are read.
+ *
+ *  Three cheap features describe how hard the clues of a board are:
+ *
+ *  + the # of clues;
+ *  + the hardest technique a human needs: naked singles (a location with a
+ *    single candidate), hidden singles (a digit with a single location in a
+ *    row, column or box), or more than singles, i.e. guessing;
+ *  + the # of guesses the backtracking solver makes (SudokuSolver stats).
+ *
+ *  They map to four levels, and `DifficultyBuckets` lists the boards of each
+ *  level, in file order, so the game serves a level in O(1).
+ *
+ *  How to use it:
+ *  ```c++
+ *      DifficultyBuckets buckets{ pool };
+ *      const vector<uint32_t> &hard = buckets.bucket(difficulty_e::HARD);
+ *  ```
+ */
+
+namespace sdkg {
+
+    /// Techniques, from the easiest.
+    enum class technique_e : uint8_t {
+        NAKED_SINGLE=0,     //!< Singles by location are enough.
+        HIDDEN_SINGLE,      //!< Singles by unit are needed.
+        GUESSING            //!< Singles get stuck: trial and error (or harder techniques).
+    };
+
+    /// Difficulty levels, from the easiest.
+    enum class difficulty_e : uint8_t {
+        EASY=0,             //!< Naked singles, plenty of clues.
+        MEDIUM,             //!< Hidden singles, or naked singles with few clues.
+        HARD,               //!< Some guessing.
+        EXPERT,             //!< Lots of guessing.
+        N_LEVELS
+    };
+
+    struct DifficultyFeatures {
+        short clues = 0;
+        technique_e hardest = technique_e::NAKED_SINGLE;
+        size_t guesses = 0;             //!< Solver guesses to the first solution, counted up to HARD_MAX_GUESSES + 1.
+    };
+
+    class DifficultyBuckets {
+        public:
+            static constexpr short EASY_MIN_CLUES{ 32 };       //!< Fewer clues make a naked singles board medium.
+            static constexpr size_t HARD_MAX_GUESSES{ 50 };    //!< More guesses make a guessing board expert.
+            static constexpr size_t N_LEVELS{ (size_t) difficulty_e::N_LEVELS };
+
+        private:
+            vector<uint32_t> m_buckets[N_LEVELS];  //!< Board indices of every level, ascending.
+
+        public:
+            DifficultyBuckets() = default;
+
+            // Rates every board of the pool. Positive values are the clues, anything else is to find.
+            explicit DifficultyBuckets( const BoardPool &boards );
+
+            // Adds the buckets of boards rated apart, whose indices start at `offset` in the pool.
+            // Offsets must grow from one call to the next, so the indices stay ascending.
+            void append( const DifficultyBuckets &other, uint32_t offset );
+
+            static DifficultyFeatures rate( BoardView board );
+            static difficulty_e classify( const DifficultyFeatures &features );
+
+            // Level names ("easy", ...), and back; parse returns false for an unknown name.
+            static const char * name( difficulty_e level );
+            static bool parse( const string &name, difficulty_e &level );
+
+            inline const vector<uint32_t> & bucket( difficulty_e level ) const { return m_buckets[(size_t) level]; }
+    };
+}
+
+#endif //SUDOKU_DIFFICULTY_H
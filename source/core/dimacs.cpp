@@ -0,0 +1,88 @@
+#include <sstream>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include "dimacs.h"
+#include "board_geometry.h"
+
+namespace sdkg {
+
+    size_t write_dimacs(std::ostream &out, const SBoard &sb) {
+        constexpr short N{ Config::SB_SIZE };
+        vector<vector<int>> clauses;
+        // "exactly one of vars": one clause for at least one, a pairwise clause for at most one
+        auto exactly_one = [&clauses]( const vector<int> &vars ) {
+            clauses.push_back(vars);
+            for (size_t a{0}; a < vars.size(); a++) {
+                for (size_t b{a + 1}; b < vars.size(); b++) clauses.push_back({ -vars[a], -vars[b] });
+            }
+        };
+        vector<int> vars(N);
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            for (short d{1}; d <= N; d++) vars[d - 1] = dimacs_var(GEOMETRY.line[cell], GEOMETRY.column[cell], d);
+            exactly_one(vars);
+        }
+        for (const auto &unit : GEOMETRY.units) {
+            for (short d{1}; d <= N; d++) {
+                for (short k{0}; k < N; k++) vars[k] = dimacs_var(GEOMETRY.line[unit[k]], GEOMETRY.column[unit[k]], d);
+                exactly_one(vars);
+            }
+        }
+        for (short i{0}; i < N; i++) {
+            for (short j{0}; j < N; j++) {
+                short digit = sb.at(i, j);
+                if (digit >= Config::SUDOKU_SMALLEST_NUM and digit <= Config::SUDOKU_BIGGEST_NUM) {
+                    clauses.push_back({ dimacs_var(i, j, digit) });
+                }
+            }
+        }
+
+        out << "c sudoku board, variable (line * 9 + column) * 9 + digit means the location holds the digit\n"
+            << "p cnf " << DIMACS_VARS << ' ' << clauses.size() << '\n';
+        for (const vector<int> &clause : clauses) {
+            for (int lit : clause) out << lit << ' ';
+            out << "0\n";
+        }
+        return clauses.size();
+    }
+
+    bool read_dimacs_model(std::istream &in, SBoard &sb) {
+        vector<bool> value(DIMACS_VARS + 1, false);
+        bool satisfiable = false;
+        string line;
+        while (getline(in, line)) {
+            std::istringstream tokens{ line };
+            string first;
+            if (not (tokens >> first)) continue;
+            if (first == "s" or first == "SAT" or first == "UNSAT") {
+                string status = first;
+                if (first == "s") tokens >> status;
+                if (status != "SATISFIABLE" and status != "SAT") return false;
+                satisfiable = true;
+                continue;
+            }
+            if (first == "c") continue;
+            // a "v" line, or a bare line of literals
+            if (first != "v") tokens.seekg(0);
+            int lit;
+            while (tokens >> lit) {
+                if (lit > 0 and lit <= DIMACS_VARS) value[lit] = true;
+            }
+        }
+        if (not satisfiable) return false;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                short digit = 0;
+                for (short d{1}; d <= Config::SB_SIZE; d++) {
+                    if (not value[dimacs_var(i, j, d)]) continue;
+                    if (digit != 0) return false;
+                    digit = d;
+                }
+                if (digit == 0) return false;
+                sb.set_loc(i, j, digit);
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SUDOKU_DIMACS_H
+#define SUDOKU_DIMACS_H
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include "config.h"
+#include "sudoku_board.h"
+
+/*!
+ *  CNF encoding of a board in the DIMACS format, to cross-check our solvers
+ *  with external SAT solvers.
+ *
+ *  Variable `(line * 9 + column) * 9 + digit` (1 to 729) is true when the
+ *  location holds the digit. The clauses are the usual extended encoding:
+ *  every location holds at least one and at most one digit, every unit holds
+ *  every digit at least once and at most once, plus one unit clause per
+ *  given (positive values only, hidden and empty locations are free).
+ *
+ *  How to use it:
+ *  ```shell
+ *      sudoku_cnf -b 0 puzzles.txt > p0.cnf && minisat p0.cnf p0.model
+ *      sudoku_cnf -b 0 --check p0.model puzzles.txt
+ *  ```
+ */
+
+namespace sdkg {
+
+    /// Variable of "location (line, column) holds digit".
+    constexpr int dimacs_var( short line, short column, short digit ) {
+        return (line * Config::SB_SIZE + column) * Config::SB_SIZE + digit;
+    }
+
+    /// # of variables of the encoding.
+    constexpr int DIMACS_VARS{ Config::SB_SIZE * Config::SB_SIZE * Config::SB_SIZE };
+
+    /// Writes the CNF of a board.
+    /*!
+     * @return The # of clauses written.
+     */
+    size_t write_dimacs( std::ostream &out, const SBoard &sb );
+
+    /// Reads a model printed by a SAT solver into a board.
+    /*!
+     * Accepts both the competition output ("s SATISFIABLE" and "v" lines) and
+     * the bare output of minisat ("SAT" then the literals).
+     * @return false if the solver found no model, or if the model does not put
+     *         exactly one digit in every location.
+     */
+    bool read_dimacs_model( std::istream &in, SBoard &sb );
+}
+
+#endif //SUDOKU_DIMACS_H
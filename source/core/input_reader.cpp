@@ -0,0 +1,52 @@
+#include <chrono>
+#include <poll.h>
+#include <unistd.h>
+#include "input_reader.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr int POLL_TIMEOUT_MS{ 100 };    //!< How often the thread checks it must stop.
+    }
+
+    InputReader::InputReader(sink_t sink, eof_t on_eof, int fd)
+        : m_fd{fd}, m_sink{std::move(sink)}, m_on_eof{std::move(on_eof)} {
+        m_thread = std::thread(&InputReader::work, this);
+    }
+
+    InputReader::~InputReader() {
+        m_stop = true;
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    bool InputReader::deliver(string &&line) {
+        while (not m_sink(std::move(line))) {
+            if (m_stop) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));  // consumer is behind, wait for room
+        }
+        return true;
+    }
+
+    void InputReader::work() {
+        string line;
+        char buffer[256];
+        pollfd pfd{ m_fd, POLLIN, 0 };
+        while (not m_stop) {
+            int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+            if (ready == 0) continue;
+            ssize_t n = (ready > 0) ? read(m_fd, buffer, sizeof buffer) : -1;
+            if (n < 0 and ready < 0) continue;      // interrupted by a signal, try again
+            if (n <= 0) {
+                // end of input: a pending partial line still counts as a line
+                if (not line.empty() and not deliver(std::move(line))) return;
+                m_on_eof();
+                return;
+            }
+            for (ssize_t i{0}; i < n; i++) {
+                if (buffer[i] != '\n') { line += buffer[i]; continue; }
+                if (not deliver(std::move(line))) return;
+                line.clear();
+            }
+        }
+    }
+}
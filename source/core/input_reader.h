@@ -0,0 +1,46 @@
+#ifndef SUDOKU_INPUT_READER_H
+#define SUDOKU_INPUT_READER_H
+#include <atomic>
+#include <functional>
+#include <string>
+using std::string;
+#include <thread>
+
+/*!
+ *  Reads lines from a file descriptor (the standard input by default) on a
+ *  dedicated thread and hands them to a sink, so the game loop never blocks
+ *  waiting for the user.
+ *
+ *  The thread waits with `poll()` and a short timeout, so it notices the
+ *  reader is being destroyed even when the user never types anything.
+ */
+
+namespace sdkg {
+
+    class InputReader {
+        public:
+            /// Receives a line (without the '\n'), returns false if it cannot take it right now.
+            typedef std::function<bool( string && )> sink_t;
+            /// Called once when the input ends.
+            typedef std::function<void()> eof_t;
+
+        private:
+            int m_fd;
+            sink_t m_sink;
+            eof_t m_on_eof;
+            std::atomic<bool> m_stop{ false };
+            std::thread m_thread;
+
+            void work();
+            // Hands a line to the sink, retrying while the sink is full. Returns false if stopped meanwhile.
+            bool deliver( string &&line );
+
+        public:
+            InputReader( sink_t sink, eof_t on_eof, int fd=0 );
+            ~InputReader();
+            InputReader & operator=( const InputReader & ) = delete;
+            InputReader( const InputReader & ) = delete;
+    };
+}
+
+#endif //SUDOKU_INPUT_READER_H
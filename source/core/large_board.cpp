@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "large_board.h"
+
+namespace sdkg {
+
+    LargeBoard::LargeBoard(short box) : m_box{box}, m_size{(short) (box * box)} {
+        if (box < 2 or box > MAX_BOX) {
+            throw std::invalid_argument("LargeBoard: box size must be in [2, " + std::to_string(MAX_BOX) + "]");
+        }
+        m_cells.assign((size_t) m_size * m_size, 0);
+    }
+
+    bool LargeBoard::is_solved() const {
+        vector<uint64_t> rows(m_size), cols(m_size), boxes(m_size);
+        for (short l{0}; l < m_size; l++) {
+            for (short c{0}; c < m_size; c++) {
+                short v = at(l, c);
+                if (v < 1 or v > m_size) return false;
+                uint64_t bit = uint64_t{1} << (v - 1);
+                if ((rows[l] | cols[c] | boxes[box_of(l, c)]) & bit) return false;
+                rows[l] |= bit;
+                cols[c] |= bit;
+                boxes[box_of(l, c)] |= bit;
+            }
+        }
+        return true;
+    }
+
+    LargeBoard LargeBoard::random_solution(short box, uint64_t seed) {
+        LargeBoard board{ box };
+        short n = board.m_size;
+        std::mt19937_64 rng{ seed };
+        vector<short> digits(n), rows(n), cols(n), bands(box), stacks(box);
+        std::iota(digits.begin(), digits.end(), 1);
+        std::shuffle(digits.begin(), digits.end(), rng);
+        std::iota(bands.begin(), bands.end(), 0);
+        std::shuffle(bands.begin(), bands.end(), rng);
+        std::iota(stacks.begin(), stacks.end(), 0);
+        std::shuffle(stacks.begin(), stacks.end(), rng);
+        // rows (and columns) keep their band, so the box structure survives the shuffle
+        for (short g{0}; g < box; g++) {
+            vector<short> in_band(box), in_stack(box);
+            std::iota(in_band.begin(), in_band.end(), 0);
+            std::shuffle(in_band.begin(), in_band.end(), rng);
+            std::iota(in_stack.begin(), in_stack.end(), 0);
+            std::shuffle(in_stack.begin(), in_stack.end(), rng);
+            for (short m{0}; m < box; m++) {
+                rows[g * box + m] = (short) (bands[g] * box + in_band[m]);
+                cols[g * box + m] = (short) (stacks[g] * box + in_stack[m]);
+            }
+        }
+        for (short l{0}; l < n; l++) {
+            for (short c{0}; c < n; c++) {
+                short r = rows[l], k = cols[c];
+                board.set(l, c, digits[(r * box + r / box + k) % n]);
+            }
+        }
+        return board;
+    }
+
+    LargeBoard LargeBoard::make_puzzle(double keep, uint64_t seed) const {
+        LargeBoard puzzle{ *this };
+        std::mt19937_64 rng{ seed };
+        std::bernoulli_distribution kept{ keep };
+        for (uint8_t &cell : puzzle.m_cells) {
+            if (not kept(rng)) cell = 0;
+        }
+        return puzzle;
+    }
+
+    LargeBacktracker::LargeBacktracker(const LargeBoard &puzzle, size_t node_budget, const std::atomic<bool> *stop)
+        : m_board{puzzle.box()}, m_rows(puzzle.size()), m_cols(puzzle.size()), m_boxes(puzzle.size()),
+          m_node_budget{node_budget}, m_stop{stop} {
+        short n = puzzle.size();
+        m_all = n == 64 ? ~mask_t{0} : (mask_t{1} << n) - 1;
+        for (short l{0}; l < n; l++) {
+            for (short c{0}; c < n; c++) {
+                short digit = puzzle.at(l, c);
+                if (digit == 0) continue;
+                // range first: the shift below is undefined for a digit past the mask's width
+                if (digit < 0 or digit > n) {
+                    m_consistent = false;
+                    continue;
+                }
+                mask_t bit = mask_t{1} << (digit - 1);
+                if ((m_rows[l] | m_cols[c] | m_boxes[puzzle.box_of(l, c)]) & bit) {
+                    m_consistent = false;
+                    continue;
+                }
+                place(l, c, digit);
+            }
+        }
+    }
+
+    void LargeBacktracker::place(short line, short column, short digit) {
+        mask_t bit = mask_t{1} << (digit - 1);
+        m_board.set(line, column, digit);
+        m_rows[line] |= bit;
+        m_cols[column] |= bit;
+        m_boxes[m_board.box_of(line, column)] |= bit;
+    }
+
+    void LargeBacktracker::unplace(short line, short column, short digit) {
+        mask_t bit = ~(mask_t{1} << (digit - 1));
+        m_board.set(line, column, 0);
+        m_rows[line] &= bit;
+        m_cols[column] &= bit;
+        m_boxes[m_board.box_of(line, column)] &= bit;
+    }
+
+    LargeBacktracker::status_e LargeBacktracker::search() {
+        if (++m_nodes > m_node_budget and m_node_budget != 0) return GAVE_UP;
+        if (m_stop != nullptr and (m_nodes & 1023) == 0 and m_stop->load(std::memory_order_relaxed)) return GAVE_UP;
+        short n = m_board.size(), best_l = -1, best_c = -1;
+        int best_count = n + 1;
+        mask_t best = 0;
+        for (short l{0}; l < n and best_count > 1; l++) {
+            for (short c{0}; c < n; c++) {
+                if (m_board.at(l, c) != 0) continue;
+                mask_t cand = m_all & ~(m_rows[l] | m_cols[c] | m_boxes[m_board.box_of(l, c)]);
+                int count = __builtin_popcountll(cand);
+                if (count < best_count) {
+                    best_count = count;
+                    best = cand;
+                    best_l = l;
+                    best_c = c;
+                    if (count <= 1) break;
+                }
+            }
+        }
+        if (best_l < 0) return SOLVED;
+        while (best) {
+            auto digit = (short) (__builtin_ctzll(best) + 1);
+            best &= best - 1;
+            place(best_l, best_c, digit);
+            status_e status = search();
+            if (status != UNSOLVABLE) return status;
+            unplace(best_l, best_c, digit);
+        }
+        return UNSOLVABLE;
+    }
+
+    LargeBacktracker::status_e LargeBacktracker::solve() {
+        return m_consistent ? search() : UNSOLVABLE;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef SUDOKU_LARGE_BOARD_H
+#define SUDOKU_LARGE_BOARD_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using std::vector;
+
+/*!
+ *  Sudoku board of any size: boxes of `b x b` locations, `N = b * b` rows,
+ *  columns and boxes, digits 1 to N (0 is an empty location). Used by the
+ *  solvers of large variants (16x16, 25x25, ...), where SBoard's fixed 9x9
+ *  layout does not apply.
+ *
+ *  LargeBacktracker is the exact reference solver for these boards: bit
+ *  masks per unit and minimum remaining values, like SudokuSolver, with a
+ *  node budget since it may run for ages on big boards.
+ */
+
+namespace sdkg {
+
+    class LargeBoard {
+        public:
+            static constexpr short MAX_BOX{ 8 };    //!< Largest box size, so digits fit a 64-bit mask.
+
+        private:
+            short m_box;                //!< Box side, b.
+            short m_size;               //!< Board side, N = b * b.
+            vector<uint8_t> m_cells;    //!< Row-major values, 0 = empty.
+
+        public:
+            /// An empty board with `box` x `box` boxes. Throws std::invalid_argument if box is not in [2, MAX_BOX].
+            explicit LargeBoard( short box=3 );
+
+            inline short box() const { return m_box; }
+            inline short size() const { return m_size; }
+            inline size_t cells() const { return m_cells.size(); }
+            inline short at( short line, short column ) const { return m_cells[line * m_size + column]; }
+            inline void set( short line, short column, short value ) { m_cells[line * m_size + column] = (uint8_t) value; }
+            inline short box_of( short line, short column ) const { return (short) ((line / m_box) * m_box + column / m_box); }
+
+            // Tells if every location is filled and no unit repeats a digit.
+            bool is_solved() const;
+
+            // A random solved board: a pattern solution with shuffled digits, bands, stacks, rows and columns.
+            static LargeBoard random_solution( short box, uint64_t seed );
+
+            // Empties a random `1 - keep` fraction of the locations.
+            LargeBoard make_puzzle( double keep, uint64_t seed ) const;
+    };
+
+    class LargeBacktracker {
+        public:
+            typedef uint64_t mask_t;
+
+            /// How a search ended.
+            enum status_e { SOLVED, UNSOLVABLE, GAVE_UP };
+
+        private:
+            LargeBoard m_board;
+            vector<mask_t> m_rows, m_cols, m_boxes;
+            mask_t m_all;
+            bool m_consistent = true;   //!< False if the givens already break the rules.
+            size_t m_nodes = 0;
+            size_t m_node_budget;
+            const std::atomic<bool> *m_stop;
+
+            void place( short line, short column, short digit );
+            void unplace( short line, short column, short digit );
+            status_e search();
+
+        public:
+            // `node_budget` = 0 means no limit; the search also gives up once `*stop` is set.
+            explicit LargeBacktracker( const LargeBoard &puzzle, size_t node_budget=0, const std::atomic<bool> *stop=nullptr );
+
+            // Fills the board; on SOLVED, board() holds the solution.
+            status_e solve();
+
+            inline const LargeBoard & board() const { return m_board; }
+            inline size_t nodes() const { return m_nodes; }
+    };
+}
+
+#endif //SUDOKU_LARGE_BOARD_H
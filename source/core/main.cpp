@@ -34,13 +34,22 @@
 #include <cstdlib> // EXIT_SUCCESS
 
 #include "sudoku_gm.h"
+#include "input_reader.h"
 
 int main( int argc, char ** argv )
 {
     sdkg::SudokuGame game;
 
+    // Escape codes only go to a terminal, not to a pipe or a log.
+    Color::enable_if_tty();
+
     // Set up simulation.
-    game.initialize( argc, argv );
+    if ( not game.initialize( argc, argv ) ) return EXIT_FAILURE;
+
+    // Lines typed by the user are read on their own thread and queued for the game loop.
+    sdkg::InputReader input(
+        [&game]( std::string &&line ) { return game.post_command( std::move(line) ); },
+        [&game]() { game.close_input(); } );
 
     // The Game Loop (Architecture)
     while( not game.game_over() )
@@ -48,6 +57,7 @@ int main( int argc, char ** argv )
         game.process_events();
         game.update();
         game.render();
+        game.idle();
     }
 
 
@@ -0,0 +1,220 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "metrics.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr int POLL_TIMEOUT_MS{ 100 };    //!< How often the server thread checks it must stop.
+
+        struct Descriptor {
+            const char *name;
+            const char *help;
+        };
+
+        constexpr Descriptor COUNTERS[Metrics::N_COUNTERS] = {
+            { "sudoku_matches_started_total",     "Matches where at least one command was entered." },
+            { "sudoku_matches_won_total",         "Matches completed without mistakes." },
+            { "sudoku_matches_lost_total",        "Matches completed with mistakes." },
+            { "sudoku_matches_abandoned_total",   "Started matches the player bailed out of." },
+            { "sudoku_commands_total",            "Commands entered while playing." },
+            { "sudoku_placements_total",          "Digits placed, undos excluded." },
+            { "sudoku_removals_total",            "Digits removed, undos excluded." },
+            { "sudoku_undos_total",               "Undo commands." },
+            { "sudoku_checks_total",              "Checks used." },
+            { "sudoku_invalid_placements_total",  "Placements breaking a row, column or box rule." },
+            { "sudoku_puzzles_generated_total",   "Puzzles queued by the puzzle feed generators." },
+            { "sudoku_puzzles_served_total",      "Puzzles taken from the puzzle feed; generated minus served is its fill level." },
+            { "sudoku_feed_misses_total",         "Takes that found the puzzle feed empty." },
+            { "sudoku_feed_stalls_total",         "Pushes that found the puzzle feed full." },
+        };
+
+        constexpr Descriptor HISTOGRAMS[Metrics::N_HISTOGRAMS] = {
+            { "sudoku_command_latency_seconds",   "Time from reading a command until the game waits for the next one." },
+            { "sudoku_match_duration_seconds",    "Time from the first command to the completed board." },
+        };
+
+        /// One thread's metrics. Written by its thread only, read by snapshots.
+        struct Shard {
+            std::atomic<uint64_t> counters[Metrics::N_COUNTERS]{};
+            LatencyHistogram histograms[Metrics::N_HISTOGRAMS];
+        };
+
+        /// Live shards, plus the totals of the threads that already exited.
+        struct Registry {
+            std::mutex mutex;
+            std::vector<Shard *> shards;
+            Metrics::Snapshot retired;
+        };
+
+        Registry & registry() {
+            static Registry *r = new Registry;  // never destroyed: threads may exit after static destruction starts
+            return *r;
+        }
+
+        void add_shard(Metrics::Snapshot &s, const Shard &shard) {
+            for (size_t c{0}; c < Metrics::N_COUNTERS; c++) s.counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+            for (size_t h{0}; h < Metrics::N_HISTOGRAMS; h++) s.histograms[h].add(shard.histograms[h]);
+        }
+
+        /// Registers the thread's shard on first use and folds it into the retired totals on exit.
+        struct ShardOwner {
+            std::unique_ptr<Shard> shard{ new Shard };
+
+            ShardOwner() {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.shards.push_back(shard.get());
+            }
+
+            ~ShardOwner() {
+                Registry &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                add_shard(r.retired, *shard);
+                for (size_t i{0}; i < r.shards.size(); i++) {
+                    if (r.shards[i] != shard.get()) continue;
+                    r.shards[i] = r.shards.back();
+                    r.shards.pop_back();
+                    break;
+                }
+            }
+        };
+
+        Shard & local_shard() {
+            thread_local ShardOwner owner;
+            return *owner.shard;
+        }
+
+        string format_bound(double seconds) {
+            std::ostringstream oss;
+            oss << seconds;
+            return oss.str();
+        }
+    }
+
+    void Metrics::add(counter_e counter, uint64_t n) {
+        std::atomic<uint64_t> &c = local_shard().counters[counter];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void Metrics::observe(histogram_e histogram, std::chrono::nanoseconds elapsed) {
+        local_shard().histograms[histogram].record(elapsed);
+    }
+
+    Metrics::Snapshot Metrics::snapshot() {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Snapshot s = r.retired;
+        for (const Shard *shard : r.shards) add_shard(s, *shard);
+        return s;
+    }
+
+    void Metrics::write_prometheus(std::ostream &os) {
+        Snapshot s = snapshot();
+        for (size_t c{0}; c < N_COUNTERS; c++) {
+            os << "# HELP " << COUNTERS[c].name << " " << COUNTERS[c].help << "\n"
+               << "# TYPE " << COUNTERS[c].name << " counter\n"
+               << COUNTERS[c].name << " " << s.counters[c] << "\n";
+        }
+        for (size_t h{0}; h < N_HISTOGRAMS; h++) {
+            const LatencyHistogram::Snapshot &hist = s.histograms[h];
+            const char *name = HISTOGRAMS[h].name;
+            os << "# HELP " << name << " " << HISTOGRAMS[h].help << "\n"
+               << "# TYPE " << name << " histogram\n";
+            uint64_t cumulative = 0;
+            for (size_t i{0}; i + 1 < LatencyHistogram::N_BUCKETS; i++) {
+                cumulative += hist.buckets[i];
+                os << name << "_bucket{le=\"" << format_bound(LatencyHistogram::bucket_bound(i)) << "\"} " << cumulative << "\n";
+            }
+            os << name << "_bucket{le=\"+Inf\"} " << hist.count << "\n"
+               << name << "_sum " << hist.sum_seconds() << "\n"
+               << name << "_count " << hist.count << "\n";
+        }
+    }
+
+    bool Metrics::export_file(const string &path) {
+        // write aside and rename, so a scraper never reads half a file
+        string tmp = path + ".tmp";
+        {
+            std::ofstream ofs{ tmp, std::ios::trunc };
+            if (not ofs) return false;
+            write_prometheus(ofs);
+            if (not ofs.flush()) return false;
+        }
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+    MetricsServer::MetricsServer(uint16_t port) {
+        m_socket = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_socket < 0) throw std::runtime_error(string{"metrics server: "} + std::strerror(errno));
+        int yes = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(m_socket, (sockaddr *) &addr, sizeof addr) < 0 or listen(m_socket, 8) < 0) {
+            string error = std::strerror(errno);
+            close(m_socket);
+            throw std::runtime_error("metrics server: cannot listen on port " + std::to_string(port) + ": " + error);
+        }
+        m_thread = std::thread(&MetricsServer::work, this);
+    }
+
+    MetricsServer::~MetricsServer() {
+        m_stop = true;
+        if (m_thread.joinable()) m_thread.join();
+        close(m_socket);
+    }
+
+    void MetricsServer::work() {
+        pollfd pfd{ m_socket, POLLIN, 0 };
+        while (not m_stop) {
+            if (poll(&pfd, 1, POLL_TIMEOUT_MS) <= 0) continue;
+            int client = accept(m_socket, nullptr, nullptr);
+            if (client < 0) continue;
+            answer(client);
+            close(client);
+        }
+    }
+
+    void MetricsServer::answer(int client) {
+        // only the request line matters, wait a little for it
+        char request[512];
+        pollfd pfd{ client, POLLIN, 0 };
+        ssize_t n = poll(&pfd, 1, POLL_TIMEOUT_MS) > 0 ? recv(client, request, sizeof request - 1, 0) : -1;
+        if (n <= 0) return;
+        request[n] = '\0';
+
+        string status = "200 OK", body;
+        if (std::strncmp(request, "GET /metrics ", 13) == 0 or std::strncmp(request, "GET / ", 6) == 0) {
+            std::ostringstream oss;
+            Metrics::write_prometheus(oss);
+            body = oss.str();
+        } else {
+            status = "404 Not Found";
+            body = "Not found, try /metrics\n";
+        }
+        string response = "HTTP/1.0 " + status + "\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\n"
+                          "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                          "Connection: close\r\n\r\n" + body;
+        for (size_t sent{0}; sent < response.size(); ) {
+            ssize_t w = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (w <= 0) return;
+            sent += (size_t) w;
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef SUDOKU_METRICS_H
+#define SUDOKU_METRICS_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+using std::string;
+#include <thread>
+
+#include "../lib/latency_histogram.h"
+
+/*!
+ *  Process wide game metrics: counters and latency histograms.
+ *
+ *  Every thread records into its own shard, so recording never locks nor
+ *  shares a cache line with another thread. Shards are only summed when a
+ *  snapshot is taken (an export or a scrape); the shard of a thread that
+ *  exits is folded into a retired total first.
+ *
+ *  Snapshots are written in the Prometheus text format, to a file or through
+ *  `MetricsServer`, a minimal HTTP endpoint serving `GET /metrics`.
+ */
+
+namespace sdkg {
+
+    class Metrics {
+        public:
+            /// Counters, all exported with a `_total` suffix.
+            enum counter_e : uint8_t {
+                MATCHES_STARTED=0,   //!< Matches where at least one command was entered.
+                MATCHES_WON,         //!< Matches completed without mistakes.
+                MATCHES_LOST,        //!< Matches completed with mistakes.
+                MATCHES_ABANDONED,   //!< Started matches the player bailed out of.
+                COMMANDS,            //!< Commands entered while playing, valid or not.
+                PLACEMENTS,          //!< Digits placed (undos excluded).
+                REMOVALS,            //!< Digits removed (undos excluded).
+                UNDOS,               //!< Undo commands.
+                CHECKS,              //!< Checks used.
+                INVALID_PLACEMENTS,  //!< Placements that broke a row, column or box rule.
+                PUZZLES_GENERATED,   //!< Puzzles queued by the PuzzleFeed generators.
+                PUZZLES_SERVED,      //!< Puzzles taken from a PuzzleFeed (generated - served = fill level).
+                FEED_MISSES,         //!< Takes that found the PuzzleFeed empty.
+                FEED_STALLS,         //!< Pushes that found the PuzzleFeed full, the generator backed off.
+                N_COUNTERS
+            };
+
+            /// Duration histograms, exported in seconds.
+            enum histogram_e : uint8_t {
+                COMMAND_LATENCY=0,   //!< From reading a command until the game waits for the next one.
+                MATCH_DURATION,      //!< From the first command to the completed board.
+                N_HISTOGRAMS
+            };
+
+            /// Sum of every shard at some point in time.
+            struct Snapshot {
+                uint64_t counters[N_COUNTERS]{};
+                LatencyHistogram::Snapshot histograms[N_HISTOGRAMS];
+            };
+
+            /// Adds `n` to a counter of the calling thread's shard.
+            static void add( counter_e counter, uint64_t n=1 );
+
+            /// Records a duration in a histogram of the calling thread's shard.
+            static void observe( histogram_e histogram, std::chrono::nanoseconds elapsed );
+
+            static Snapshot snapshot();
+
+            /// Writes a snapshot in the Prometheus text exposition format.
+            static void write_prometheus( std::ostream &os );
+
+            /// Writes a snapshot to a file, replacing it atomically. Returns false on I/O errors.
+            static bool export_file( const string &path );
+    };
+
+    /// Serves the metrics over HTTP on 127.0.0.1 from its own thread, until destroyed.
+    class MetricsServer {
+        private:
+            int m_socket = -1;
+            std::atomic<bool> m_stop{ false };
+            std::thread m_thread;
+
+            void work();
+            void answer( int client );
+
+        public:
+            /// Starts listening on `port`; throws std::runtime_error if the port cannot be bound.
+            explicit MetricsServer( uint16_t port );
+            ~MetricsServer();
+            MetricsServer & operator=( const MetricsServer & ) = delete;
+            MetricsServer( const MetricsServer & ) = delete;
+    };
+}
+
+#endif //SUDOKU_METRICS_H
@@ -0,0 +1,169 @@
+#include "player.h"
+#include "sudoku_solver.h"
+#include "board_geometry.h"
+
+namespace sdkg {
+
+    Player::Player(size_t matches, unsigned seed, size_t max_moves)
+        : m_rng{seed}, m_matches_left{matches}, m_max_moves{max_moves} {/*empty*/}
+
+    string Player::answer(Player::prompt_e prompt, const SBoardManager &sbm) {
+        if (prompt == prompt_e::MAIN_MENU) {
+            if (m_abandoning) return "2";                  // new game, leaving the current one
+            return (m_matches_left > 0) ? "1" : "3";      // play or quit
+        } else if (prompt == prompt_e::CONFIRM) {
+            if (m_abandoning) {
+                m_abandoning = false;
+                m_in_match = false;
+                m_stats.abandoned++;
+                m_matches_left--;
+            }
+            return "y";
+        } else if (prompt == prompt_e::MATCH_OVER) {
+            bool won = true;
+            for (short i{0}; i < Config::SB_SIZE; i++) {
+                for (short j{0}; j < Config::SB_SIZE; j++) {
+                    SBoardManager::loc_type_e code = sbm.decode_player_board_loc(i, j).first;
+                    if (code == SBoardManager::INVALID or code == SBoardManager::INCORRECT) won = false;
+                }
+            }
+            m_stats.matches++;
+            if (won) m_stats.wins++;
+            m_in_match = false;
+            if (m_matches_left > 0) m_matches_left--;
+            return "";
+        } else if (prompt == prompt_e::COMMAND) {
+            if (not m_in_match) {
+                m_in_match = true;
+                m_match_moves = 0;
+                on_new_match(sbm);
+            }
+            if (m_match_moves >= m_max_moves) {
+                m_abandoning = true;
+                return "";                                 // back to the main menu
+            }
+            m_match_moves++;
+            m_stats.moves++;
+            return next_move(sbm);
+        }
+        return "";
+    }
+
+    string Player::place_cmd(short line, short column, short digit) {
+        return "p " + std::to_string(line + 1) + " " + std::to_string(column + 1) + " " + std::to_string(digit);
+    }
+
+    string Player::remove_cmd(short line, short column) {
+        return "r " + std::to_string(line + 1) + " " + std::to_string(column + 1);
+    }
+
+    unsigned Player::valid_digits(const SBoardManager &sbm, short line, short column) {
+        unsigned used = 0;
+        for (uint8_t peer : GEOMETRY.peers[BoardGeometry::cell_of(line, column)]) {
+            used |= 1u << sbm.decode_player_board_loc(GEOMETRY.line[peer], GEOMETRY.column[peer]).second;
+        }
+        return 0x3FEu & ~used;
+    }
+
+    bool Player::random_empty_loc(const SBoardManager &sbm, short &line, short &column) {
+        short empties[Config::SB_SIZE * Config::SB_SIZE];
+        int n_empties = 0;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                if (sbm.decode_player_board_loc(i, j).first == SBoardManager::EMPTY) {
+                    empties[n_empties++] = (short) (i * Config::SB_SIZE + j);
+                }
+            }
+        }
+        if (n_empties == 0) return false;
+        short cell = empties[std::uniform_int_distribution<int>(0, n_empties - 1)(m_rng)];
+        line = (short) (cell / Config::SB_SIZE);
+        column = (short) (cell % Config::SB_SIZE);
+        return true;
+    }
+
+    short Player::random_digit(unsigned mask) {
+        if (mask == 0) {
+            return (short) std::uniform_int_distribution<int>(Config::SUDOKU_SMALLEST_NUM, Config::SUDOKU_BIGGEST_NUM)(m_rng);
+        }
+        int pick = std::uniform_int_distribution<int>(0, __builtin_popcount(mask) - 1)(m_rng);
+        while (pick--) mask &= mask - 1;
+        return (short) __builtin_ctz(mask);
+    }
+
+    string RandomPlayer::next_move(const SBoardManager &sbm) {
+        short line, column;
+        if (not random_empty_loc(sbm, line, column)) return "c";
+        return place_cmd(line, column, random_digit(valid_digits(sbm, line, column)));
+    }
+
+    void SolverPlayer::on_new_match(const SBoardManager &sbm) {
+        SBoard puzzle;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                std::pair<SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(i, j);
+                if (loc.first == SBoardManager::ORIGINAL) puzzle.set_loc(i, j, loc.second);
+            }
+        }
+        m_solved = SudokuSolver(puzzle).solve(m_solution);
+    }
+
+    string SolverPlayer::next_move(const SBoardManager &sbm) {
+        short line, column;
+        if (not m_solved) {
+            if (not random_empty_loc(sbm, line, column)) return "c";
+            return place_cmd(line, column, random_digit(valid_digits(sbm, line, column)));
+        }
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                std::pair<SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(i, j);
+                if (loc.first == SBoardManager::EMPTY) return place_cmd(i, j, m_solution.at(i, j));
+                if (loc.second != m_solution.at(i, j)) return remove_cmd(i, j);
+            }
+        }
+        return "c";
+    }
+
+    HumanLikePlayer::HumanLikePlayer(size_t matches, unsigned seed, size_t max_moves,
+                                     double mistake_rate, double undo_rate, double check_rate)
+        : SolverPlayer{matches, seed, max_moves},
+          m_mistake_rate{mistake_rate}, m_undo_rate{undo_rate}, m_check_rate{check_rate} {/*empty*/}
+
+    bool HumanLikePlayer::chance(double p) {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < p;
+    }
+
+    string HumanLikePlayer::next_move(const SBoardManager &sbm) {
+        if (not m_solved) return SolverPlayer::next_move(sbm);
+        if (m_last_was_mistake and chance(m_undo_rate)) {
+            m_last_was_mistake = false;
+            return "u";
+        }
+        m_last_was_mistake = false;
+        if (chance(m_check_rate)) return "c";
+
+        // A player that notices a wrong digit (or has nothing else left to fill) goes back to fix it.
+        short line, column;
+        bool has_empty = random_empty_loc(sbm, line, column);
+        if (not has_empty or chance(0.3)) {
+            for (short i{0}; i < Config::SB_SIZE; i++) {
+                for (short j{0}; j < Config::SB_SIZE; j++) {
+                    std::pair<SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(i, j);
+                    if (loc.first != SBoardManager::EMPTY and loc.second != m_solution.at(i, j)) {
+                        return remove_cmd(i, j);
+                    }
+                }
+            }
+        }
+        if (not has_empty) return "c";
+
+        short digit = m_solution.at(line, column);
+        if (chance(m_mistake_rate)) {
+            unsigned wrong = valid_digits(sbm, line, column) & ~(1u << digit);
+            if (wrong == 0) wrong = 0x3FEu & ~(1u << digit);
+            digit = random_digit(wrong);
+            m_last_was_mistake = true;
+        }
+        return place_cmd(line, column, digit);
+    }
+}
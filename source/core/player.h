@@ -0,0 +1,117 @@
+#ifndef SUDOKU_PLAYER_H
+#define SUDOKU_PLAYER_H
+#include <random>
+#include <string>
+using std::string;
+#include "sudoku_board.h"
+
+/*!
+ *  Scripted players used to drive a SudokuGame without a terminal.
+ *
+ *  A SudokuGame that has a Player attached asks it for every line it would
+ *  otherwise read from the standard input, so matches played by a bot go
+ *  through exactly the same menus, commands and board checks a human hits.
+ *
+ *  The base class answers the menus (start a match, acknowledge messages,
+ *  quit once the requested number of matches was played) and keeps the
+ *  match statistics. Each strategy only decides the next in-match command.
+ */
+
+namespace sdkg {
+
+    class Player {
+        public:
+            /// What the game is waiting for when it asks the player for a line.
+            enum class prompt_e {
+                CONTINUE,      //!< Just an 'enter' (welcome, help, check results).
+                MAIN_MENU,     //!< Main menu option.
+                CONFIRM,       //!< Confirmation to leave an ongoing match.
+                COMMAND,       //!< A match command (p, r, u, c or empty).
+                MATCH_OVER     //!< An 'enter' after the puzzle was completed.
+            };
+
+            /// Aggregated results of the matches played so far.
+            struct Stats {
+                size_t matches = 0;      //!< # of completed matches.
+                size_t wins = 0;         //!< # of completed matches that were won.
+                size_t abandoned = 0;    //!< # of matches given up after reaching the move limit.
+                size_t moves = 0;        //!< # of match commands issued.
+            };
+
+        protected:
+            std::mt19937 m_rng;             //!< Random engine, seeded per player for reproducible runs.
+
+        private:
+            size_t m_matches_left;          //!< # of matches still to play before quitting.
+            size_t m_max_moves;             //!< Move limit per match, the match is abandoned after it.
+            size_t m_match_moves = 0;       //!< # of moves in the current match.
+            bool m_in_match = false;        //!< Flag that indicates a match is being played.
+            bool m_abandoning = false;      //!< Flag that indicates the current match is being abandoned.
+            Stats m_stats;
+
+        protected:
+            /// Called when a new match starts, before the first command is requested.
+            virtual void on_new_match( const SBoardManager & ) { /* empty */ }
+
+            /// Returns the next match command, in the same syntax a user would type.
+            virtual string next_move( const SBoardManager &sbm ) = 0;
+
+            // Helpers shared by the strategies.
+            static string place_cmd( short line, short column, short digit );
+            static string remove_cmd( short line, short column );
+            // Digits that do not repeat on the row, column or box of a location, as a bit mask.
+            static unsigned valid_digits( const SBoardManager &sbm, short line, short column );
+            // Picks a random empty location, returns false if there is none.
+            bool random_empty_loc( const SBoardManager &sbm, short &line, short &column );
+            // Picks a random digit from a mask, or any digit if the mask is empty.
+            short random_digit( unsigned mask );
+
+        public:
+            explicit Player( size_t matches, unsigned seed, size_t max_moves=1000 );
+            virtual ~Player() = default;
+
+            // Answers a game prompt, this is what the game calls instead of reading the standard input.
+            string answer( prompt_e prompt, const SBoardManager &sbm );
+
+            inline const Stats & stats() const { return m_stats; }
+    };
+
+    /// Places random digits that are valid at the moment, never looking at the solution.
+    class RandomPlayer : public Player {
+        protected:
+            string next_move( const SBoardManager &sbm ) override;
+        public:
+            using Player::Player;
+    };
+
+    /// Solves the puzzle on its own and places every digit correctly.
+    class SolverPlayer : public Player {
+        protected:
+            SBoard m_solution;          //!< Solution found at the beginning of the match.
+            bool m_solved = false;      //!< Flag that indicates the solver found a solution.
+
+            void on_new_match( const SBoardManager &sbm ) override;
+            string next_move( const SBoardManager &sbm ) override;
+        public:
+            using Player::Player;
+    };
+
+    /// Knows the solution but makes mistakes, checks the board, undoes and fixes wrong plays.
+    class HumanLikePlayer : public SolverPlayer {
+        private:
+            double m_mistake_rate;      //!< Probability of placing a wrong digit.
+            double m_undo_rate;         //!< Probability of undoing right after a mistake.
+            double m_check_rate;        //!< Probability of spending a check on a move.
+            bool m_last_was_mistake = false;
+
+            bool chance( double p );
+
+        protected:
+            string next_move( const SBoardManager &sbm ) override;
+        public:
+            HumanLikePlayer( size_t matches, unsigned seed, size_t max_moves=1000,
+                             double mistake_rate=0.1, double undo_rate=0.5, double check_rate=0.02 );
+    };
+}
+
+#endif
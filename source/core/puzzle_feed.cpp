@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <numeric>
+#include "puzzle_feed.h"
+#include "board_transform.h"
+#include "metrics.h"
+#include "sudoku_solver.h"
+
+namespace sdkg {
+
+    PuzzleFeed::PuzzleFeed(const BoardPool &boards, vector<uint32_t> sources, unsigned generators, uint64_t seed)
+        : m_boards{boards}, m_sources{ std::move(sources) }, m_seed{seed} {
+        if (m_sources.empty()) {
+            m_sources.resize(m_boards.size());
+            std::iota(m_sources.begin(), m_sources.end(), 0);
+        }
+        if (m_sources.empty()) return;
+        generators = std::max(1u, generators);
+        for (unsigned g{0}; g < generators; g++) m_generators.emplace_back(&PuzzleFeed::generate, this, g, generators);
+    }
+
+    PuzzleFeed::~PuzzleFeed() {
+        m_stop = true;
+        for (std::thread &generator : m_generators) generator.join();
+    }
+
+    void PuzzleFeed::generate(unsigned generator, unsigned generators) {
+        std::map<uint32_t, SBoard> solved;      // sources that ship without their solution, solved once
+        SBoard board, puzzle;
+        // generator g makes the puzzles g, g + generators, g + 2 * generators...
+        for (uint64_t n{generator}; not m_stop; n += generators) {
+            uint64_t seed = BoardTransform::variant_seed(m_seed, n, 0);
+            uint32_t source = m_sources[seed % m_sources.size()];
+            BoardView view = m_boards[source];
+            if (not view.has_blanks()) {
+                view.copy_to(board);
+            } else if (solved.count(source) != 0) {
+                board = solved[source];
+            } else {
+                SBoard clues, solution;
+                view.copy_to(clues);
+                if (not SudokuSolver(clues).solve(solution)) continue;  // unplayable, valid clues without a solution
+                for (short i{0}; i < Config::SB_SIZE; i++) {
+                    for (short j{0}; j < Config::SB_SIZE; j++) {
+                        board.set_loc(i, j, clues.at(i, j) > 0 ? clues.at(i, j) : (short) -solution.at(i, j));
+                    }
+                }
+                solved[source] = board;
+            }
+            BoardTransform::random(seed, BoardTransform::ALL).apply(board, puzzle);
+
+            ReadyPuzzle ready;
+            for (short i{0}; i < Config::SB_SIZE; i++) {
+                for (short j{0}; j < Config::SB_SIZE; j++) ready.cells[i * Config::SB_SIZE + j] = (int8_t) puzzle.at(i, j);
+            }
+            // backpressure: a full feed puts the generator to sleep, longer and longer
+            unsigned backoff_us = MIN_BACKOFF_US;
+            while (not m_queue.try_push(ready)) {
+                if (m_stop) return;
+                m_stalls.fetch_add(1, std::memory_order_relaxed);
+                Metrics::add(Metrics::FEED_STALLS);
+                std::this_thread::sleep_for(std::chrono::microseconds(backoff_us));
+                backoff_us = std::min(2 * backoff_us, MAX_BACKOFF_US);
+            }
+            m_generated.fetch_add(1, std::memory_order_relaxed);
+            Metrics::add(Metrics::PUZZLES_GENERATED);
+        }
+    }
+
+    bool PuzzleFeed::try_take(ReadyPuzzle &puzzle) {
+        size_t fill = m_queue.size();
+        if (not m_queue.try_pop(puzzle)) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            Metrics::add(Metrics::FEED_MISSES);
+            return false;
+        }
+        m_fill_sum.fetch_add(fill, std::memory_order_relaxed);
+        m_served.fetch_add(1, std::memory_order_relaxed);
+        Metrics::add(Metrics::PUZZLES_SERVED);
+        return true;
+    }
+
+    PuzzleFeed::Stats PuzzleFeed::stats() const {
+        Stats s;
+        s.generated = m_generated.load(std::memory_order_relaxed);
+        s.served = m_served.load(std::memory_order_relaxed);
+        s.misses = m_misses.load(std::memory_order_relaxed);
+        s.stalls = m_stalls.load(std::memory_order_relaxed);
+        s.fill = m_queue.size();
+        s.mean_fill = s.served != 0 ? (double) m_fill_sum.load(std::memory_order_relaxed) / (double) s.served : 0.0;
+        return s;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef SUDOKU_PUZZLE_FEED_H
+#define SUDOKU_PUZZLE_FEED_H
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+using std::vector;
+#include "../lib/mpmc_queue.h"
+#include "board_pool.h"
+
+/*!
+ *  Ready-to-play puzzles, made by background generator threads.
+ *
+ *  A generator picks a board among the sources (e.g. a difficulty bucket),
+ *  solves it if it ships without its solution, turns it into a fresh puzzle
+ *  with a random validity preserving transform (see BoardTransform), and
+ *  queues it packed, its hidden locations carrying their solution. Players
+ *  take puzzles without ever waiting: `try_take` returns false when nothing
+ *  is ready, and the game plays a board of the file instead.
+ *
+ *  The queue is a bounded lock-free MPMC ring (MpmcQueue), so any number of
+ *  games or sessions take from one feed. When it is full, the generators
+ *  back off, sleeping longer and longer (backpressure): an idle feed costs
+ *  no CPU. The fill level, misses and stalls are counted in Metrics.
+ *
+ *  How to use it:
+ *  ```c++
+ *      PuzzleFeed feed{ sbm.get_boards(), bucket, 2 };
+ *      ReadyPuzzle puzzle;
+ *      if (feed.try_take(puzzle)) sbm.play_board(puzzle.view());
+ *  ```
+ */
+
+namespace sdkg {
+
+    /// A puzzle and its solution, packed as in a BoardPool: clues positive, hidden locations negative.
+    struct ReadyPuzzle {
+        int8_t cells[BoardPool::BOARD_BYTES];
+
+        inline BoardView view() const { return BoardView{ cells }; }
+    };
+
+    class PuzzleFeed {
+        public:
+            static constexpr size_t CAPACITY{ 256 };
+            static constexpr unsigned MIN_BACKOFF_US{ 50 };     //!< First sleep of a generator finding the feed full.
+            static constexpr unsigned MAX_BACKOFF_US{ 5000 };   //!< Longest sleep, doubling from the first.
+
+            /// Activity of the feed since it started.
+            struct Stats {
+                uint64_t generated = 0;     //!< Puzzles queued.
+                uint64_t served = 0;        //!< Puzzles taken.
+                uint64_t misses = 0;        //!< Takes that found the feed empty.
+                uint64_t stalls = 0;        //!< Pushes that found the feed full.
+                size_t fill = 0;            //!< Puzzles queued now.
+                double mean_fill = 0;       //!< Average fill level seen by the takes.
+            };
+
+        private:
+            static constexpr size_t CACHE_LINE{ 64 };
+
+            const BoardPool &m_boards;
+            vector<uint32_t> m_sources;                 //!< Indices of the boards puzzles are made from.
+            uint64_t m_seed;
+            MpmcQueue<ReadyPuzzle, CAPACITY> m_queue;
+            std::atomic<bool> m_stop{ false };
+            vector<std::thread> m_generators;
+            // Counters written by the generators and by the takers, on their own lines.
+            alignas(CACHE_LINE) std::atomic<uint64_t> m_generated{ 0 };
+            std::atomic<uint64_t> m_stalls{ 0 };
+            alignas(CACHE_LINE) std::atomic<uint64_t> m_served{ 0 };
+            std::atomic<uint64_t> m_misses{ 0 };
+            std::atomic<uint64_t> m_fill_sum{ 0 };
+
+            void generate( unsigned generator, unsigned generators );
+
+        public:
+            // Starts `generators` threads making puzzles from `sources`, indices of `boards` (all of them if empty).
+            // The boards must outlive the feed. Seeds make the puzzles of every generator reproducible.
+            PuzzleFeed( const BoardPool &boards, vector<uint32_t> sources, unsigned generators, uint64_t seed=42 );
+            ~PuzzleFeed();
+            PuzzleFeed & operator=( const PuzzleFeed & ) = delete;
+            PuzzleFeed( const PuzzleFeed & ) = delete;
+
+            // Takes a ready puzzle, from any thread; never waits, returns false if none is ready.
+            bool try_take( ReadyPuzzle &puzzle );
+
+            Stats stats() const;
+    };
+}
+
+#endif //SUDOKU_PUZZLE_FEED_H
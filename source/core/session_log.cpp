@@ -0,0 +1,241 @@
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include "session_log.h"
+
+namespace sdkg {
+
+    namespace {
+        constexpr char MAGIC[4]{ 'S', 'D', 'K', 'L' };
+        constexpr uint8_t END_TAG{ 0xFF };
+        constexpr uint8_t PUZZLE_TAG{ 0xFE };
+        constexpr uint16_t UNIQUENESS_FLAG{ 1 };
+        constexpr int DIFFICULTY_SHIFT{ 1 };
+        constexpr uint16_t DIFFICULTY_MASK{ 0x7 };
+        constexpr uint8_t MAX_PROMPT{ (uint8_t) Player::prompt_e::MATCH_OVER };
+
+        void put_uint( vector<uint8_t> &out, uint64_t v, int n_bytes ) {
+            for (int i{0}; i < n_bytes; i++) out.push_back((uint8_t) (v >> (8 * i)));
+        }
+        void put_varint( vector<uint8_t> &out, uint64_t v ) {
+            for (; v >= 0x80; v >>= 7) out.push_back((uint8_t) (v | 0x80));
+            out.push_back((uint8_t) v);
+        }
+
+        /// Reads the bytes of a log, telling whether it ended before a field (a log cut short).
+        class Reader {
+            private:
+                const vector<uint8_t> &m_bytes;
+                size_t m_pos = 0;
+
+            public:
+                explicit Reader( const vector<uint8_t> &bytes ) : m_bytes{bytes} {/*empty*/}
+
+                inline bool at_end() const { return m_pos == m_bytes.size(); }
+                inline size_t left() const { return m_bytes.size() - m_pos; }
+                inline size_t pos() const { return m_pos; }
+
+                bool get_uint( int n_bytes, uint64_t &v ) {
+                    if (left() < (size_t) n_bytes) return false;
+                    v = 0;
+                    for (int i{0}; i < n_bytes; i++) v |= (uint64_t) m_bytes[m_pos++] << (8 * i);
+                    return true;
+                }
+                bool get_varint( uint64_t &v ) {
+                    v = 0;
+                    for (int shift{0}; shift < 64; shift += 7) {
+                        if (at_end()) return false;
+                        uint8_t byte = m_bytes[m_pos++];
+                        v |= (uint64_t) (byte & 0x7F) << shift;
+                        if ((byte & 0x80) == 0) return true;
+                    }
+                    throw std::runtime_error("Corrupted session log!\n");
+                }
+                bool get_bytes( size_t n, string &s ) {
+                    if (left() < n) return false;
+                    s.assign((const char *) m_bytes.data() + m_pos, n);
+                    m_pos += n;
+                    return true;
+                }
+        };
+    }
+
+    SessionLog::SessionLog(const string &path, const Header &header)
+        : m_file{ path, std::ios::binary | std::ios::trunc }, m_last{ std::chrono::steady_clock::now() } {
+        if (not m_file) throw std::runtime_error("Session log \"" + path + "\" could not be created!\n");
+        m_buffer.assign(MAGIC, MAGIC + sizeof MAGIC);
+        put_uint(m_buffer, VERSION, 2);
+        uint16_t flags = (uint16_t) ((header.check_uniqueness ? UNIQUENESS_FLAG : 0) |
+                                     (((header.difficulty + 1) & DIFFICULTY_MASK) << DIFFICULTY_SHIFT));
+        put_uint(m_buffer, flags, 2);
+        put_uint(m_buffer, header.total_checks, 2);
+        put_uint(m_buffer, header.num_boards, 4);
+        put_uint(m_buffer, header.start_us, 8);
+        size_t name_size = std::min<size_t>(header.input_filename.size(), UINT16_MAX);
+        put_uint(m_buffer, name_size, 2);
+        m_buffer.insert(m_buffer.end(), header.input_filename.begin(), header.input_filename.begin() + name_size);
+        m_writer = std::thread(&SessionLog::work, this);
+    }
+
+    SessionLog::~SessionLog() {
+        close();
+    }
+
+    void SessionLog::work() {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while (true) {
+            m_wake.wait_for(lock, FLUSH_PERIOD, [this]() { return m_closing or m_buffer.size() >= FLUSH_BYTES; });
+            bool closing = m_closing;
+            std::swap(m_buffer, m_writing);
+            lock.unlock();
+            if (not m_writing.empty()) {
+                m_file.write((const char *) m_writing.data(), (std::streamsize) m_writing.size());
+                m_file.flush();
+                m_writing.clear();
+            }
+            lock.lock();
+            if (not m_file) m_failed = true;
+            if (closing) return;
+        }
+    }
+
+    void SessionLog::close() {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (m_closing) return;
+            m_closing = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+        m_file.close();
+    }
+
+    uint64_t SessionLog::fold(uint64_t digest, uint32_t board_idx, const SBoard &player_board) {
+        constexpr uint64_t PRIME{ 1099511628211ull };
+        for (int i{0}; i < 4; i++) digest = (digest ^ (uint8_t) (board_idx >> (8 * i))) * PRIME;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) digest = (digest ^ (uint8_t) player_board.at(i, j)) * PRIME;
+        }
+        return digest;
+    }
+
+    void SessionLog::append(Player::prompt_e prompt, const string &line, uint32_t board_idx, const SBoard &player_board) {
+        m_digest = fold(m_digest, board_idx, player_board);
+        auto now = std::chrono::steady_clock::now();
+        auto delay = std::chrono::duration_cast<std::chrono::microseconds>(now - m_last).count();
+        m_last = now;
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (m_closing) return;
+            m_buffer.push_back((uint8_t) prompt);
+            put_varint(m_buffer, (uint64_t) delay);
+            put_varint(m_buffer, line.size());
+            m_buffer.insert(m_buffer.end(), line.begin(), line.end());
+            m_lines++;
+            wake = m_buffer.size() >= FLUSH_BYTES;
+        }
+        if (wake) m_wake.notify_one();
+    }
+
+    void SessionLog::append_puzzle(const ReadyPuzzle *puzzle) {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_closing) return;
+        m_buffer.push_back(PUZZLE_TAG);
+        m_buffer.push_back(puzzle != nullptr ? 1 : 0);
+        if (puzzle != nullptr) m_buffer.insert(m_buffer.end(), puzzle->cells, puzzle->cells + BoardPool::BOARD_BYTES);
+    }
+
+    void SessionLog::finish(uint32_t board_idx, const SBoard &player_board) {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (m_closing) return;
+            m_buffer.push_back(END_TAG);
+            put_varint(m_buffer, m_lines);
+            put_uint(m_buffer, m_digest, 8);
+            put_uint(m_buffer, board_idx, 4);
+            for (short i{0}; i < Config::SB_SIZE; i++) {
+                for (short j{0}; j < Config::SB_SIZE; j++) m_buffer.push_back((uint8_t) (int8_t) player_board.at(i, j));
+            }
+        }
+        close();
+    }
+
+    bool SessionLog::good() {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return not m_failed;
+    }
+
+    SessionLog::Recording SessionLog::read(const string &path) {
+        std::ifstream file{ path, std::ios::binary };
+        if (not file) throw std::runtime_error("Session log \"" + path + "\" could not be read!\n");
+        vector<uint8_t> bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+        Reader in{ bytes };
+        Recording rec;
+        uint64_t version, flags, checks, boards, start, name_size;
+        string magic;
+        if (not in.get_bytes(sizeof MAGIC, magic) or std::memcmp(magic.data(), MAGIC, sizeof MAGIC) != 0) {
+            throw std::runtime_error("File is not a session log!\n");
+        }
+        if (not in.get_uint(2, version) or version != VERSION) throw std::runtime_error("Unsupported session log version!\n");
+        if (not (in.get_uint(2, flags) and in.get_uint(2, checks) and in.get_uint(4, boards) and
+                 in.get_uint(8, start) and in.get_uint(2, name_size) and
+                 in.get_bytes(name_size, rec.header.input_filename))) {
+            throw std::runtime_error("Corrupted session log header!\n");
+        }
+        rec.header.check_uniqueness = (flags & UNIQUENESS_FLAG) != 0;
+        rec.header.difficulty = (int) ((flags >> DIFFICULTY_SHIFT) & DIFFICULTY_MASK) - 1;
+        if (rec.header.difficulty >= (int) DifficultyBuckets::N_LEVELS) throw std::runtime_error("Corrupted session log header!\n");
+        rec.header.total_checks = (uint16_t) checks;
+        rec.header.num_boards = (uint32_t) boards;
+        rec.header.start_us = start;
+
+        while (not in.at_end()) {
+            size_t entry_start = in.pos();
+            uint64_t tag, delay, size, lines, digest, board_idx;
+            in.get_uint(1, tag);
+            if (tag == END_TAG) {
+                if (not (in.get_varint(lines) and in.get_uint(8, digest) and in.get_uint(4, board_idx)) or in.left() < (size_t) (Config::SB_SIZE * Config::SB_SIZE)) break;
+                if (lines != rec.entries.size()) throw std::runtime_error("Corrupted session log end!\n");
+                rec.finished = true;
+                rec.digest = digest;
+                rec.board_idx = (uint32_t) board_idx;
+                for (short i{0}; i < Config::SB_SIZE; i++) {
+                    for (short j{0}; j < Config::SB_SIZE; j++) {
+                        uint64_t code = 0;
+                        in.get_uint(1, code);
+                        rec.player_board.set_loc(i, j, (int8_t) code);
+                    }
+                }
+                if (not in.at_end()) throw std::runtime_error("Corrupted session log end!\n");
+                break;
+            }
+            if (tag == PUZZLE_TAG) {
+                uint64_t fed;
+                Fed puzzle{ false, {} };
+                if (not in.get_uint(1, fed)) break;
+                if (fed > 1) throw std::runtime_error("Corrupted session log at byte " + std::to_string(entry_start) + "!\n");
+                puzzle.fed = fed == 1;
+                if (puzzle.fed) {
+                    string cells;
+                    if (not in.get_bytes(BoardPool::BOARD_BYTES, cells)) break;
+                    std::memcpy(puzzle.puzzle.cells, cells.data(), BoardPool::BOARD_BYTES);
+                    if (puzzle.puzzle.view().has_blanks()) throw std::runtime_error("Corrupted session log puzzle!\n");
+                }
+                rec.puzzles.push_back(puzzle);
+                continue;
+            }
+            if (tag > MAX_PROMPT) {
+                throw std::runtime_error("Corrupted session log at byte " + std::to_string(entry_start) + "!\n");
+            }
+            Entry entry{ (Player::prompt_e) tag, 0, {} };
+            // a line cut short is the crash the log was written up to
+            if (not (in.get_varint(delay) and in.get_varint(size)) or size > in.left()) break;
+            in.get_bytes(size, entry.line);
+            entry.delay_us = delay;
+            rec.entries.push_back(std::move(entry));
+        }
+        return rec;
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef SUDOKU_SESSION_LOG_H
+#define SUDOKU_SESSION_LOG_H
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+#include "player.h"
+#include "puzzle_feed.h"
+#include "sudoku_board.h"
+
+/*!
+ *  Binary log of a game session, to reproduce it exactly.
+ *
+ *  A game is deterministic given its options, its puzzle file and the lines
+ *  it reads, so the log records just that: the options in a header, then
+ *  every line the game read, with the prompt it answered and when, and
+ *  finally the state the session ended in. Replaying the lines through a
+ *  new game must end in that same state. As earlier matches leave no trace
+ *  in the final state, the log also keeps a digest of the player board as it
+ *  was before every line; a replay must go through the very same boards.
+ *
+ *  Layout (all integers little-endian, varints are LEB128):
+ *
+ *  + Header: magic "SDKL", version (u16), flags (u16; bit 0: uniqueness check,
+ *    bits 1-3: difficulty level + 1, 0 for every level),
+ *    # of checks (u16), # of valid boards read (u32), start time in microseconds
+ *    since the epoch (u64), puzzle file name (u16 length + bytes).
+ *  + Lines: prompt (u8, see Player::prompt_e), microseconds since the previous
+ *    line (varint), length (varint), bytes.
+ *  + Puzzle taken by a new match from a puzzle source (see SudokuGame::set_puzzle_source):
+ *    0xFE, then 1 and the 81 values (i8, row-major), or 0 if the source had none.
+ *  + End, if the session ended: 0xFF, # of lines (varint), board digest (u64),
+ *    board index (u32), then the 81 player board codes (i8, row-major).
+ *
+ *  The game thread only appends to a memory buffer; a writer thread does the
+ *  I/O, when the buffer is big enough or once a second, so a crashed session
+ *  loses at most the last second of input.
+ *
+ *  How to use it:
+ *  ```c++
+ *      SessionLog log{ "game.sdkl", header };
+ *      log.append(Player::prompt_e::COMMAND, "p 1 1 5", board_idx, sbm.get_player_board());
+ *      log.finish(board_idx, sbm.get_player_board());
+ *
+ *      SessionLog::Recording rec = SessionLog::read("game.sdkl");
+ *  ```
+ */
+
+namespace sdkg {
+
+    class SessionLog {
+        public:
+            static constexpr uint16_t VERSION{ 1 };
+            static constexpr size_t FLUSH_BYTES{ 64 * 1024 };           //!< Buffer size that wakes the writer.
+            static constexpr std::chrono::milliseconds FLUSH_PERIOD{ 1000 };  //!< Longest time a line stays in memory.
+            static constexpr uint64_t DIGEST_SEED{ 14695981039346656037ull };  //!< FNV-1a offset basis.
+
+            /// What the game was started with.
+            struct Header {
+                string input_filename;          //!< Puzzle files, directories or patterns, one per line.
+                uint16_t total_checks = 3;
+                bool check_uniqueness = false;
+                int difficulty = -1;            //!< Level served (see difficulty_e), -1 for every level.
+                uint32_t num_boards = 0;        //!< # of valid boards read, to notice a changed puzzle file.
+                uint64_t start_us = 0;          //!< Start time, microseconds since the epoch.
+            };
+
+            /// A line read by the game.
+            struct Entry {
+                Player::prompt_e prompt;
+                uint64_t delay_us;              //!< Microseconds since the previous line (or the start).
+                string line;
+            };
+
+            /// What a puzzle source gave a new match.
+            struct Fed {
+                bool fed;                       //!< False if the source had no puzzle (a file board was played).
+                ReadyPuzzle puzzle;
+            };
+
+            /// A whole log, as read back.
+            struct Recording {
+                Header header;
+                vector<Entry> entries;
+                vector<Fed> puzzles;            //!< Puzzle source outcomes, in order.
+                bool finished = false;          //!< The session ended; the fields below are set.
+                uint64_t digest = 0;            //!< Digest of the boards the lines were read on (see fold).
+                uint32_t board_idx = 0;         //!< Board being played at the end.
+                SBoard player_board;            //!< Player board at the end.
+            };
+
+        private:
+            std::ofstream m_file;
+            vector<uint8_t> m_buffer;           //!< Filled by the game thread.
+            vector<uint8_t> m_writing;          //!< Written by the writer thread.
+            size_t m_lines = 0;
+            uint64_t m_digest = DIGEST_SEED;
+            std::chrono::steady_clock::time_point m_last;
+            bool m_closing = false;
+            bool m_failed = false;              //!< A write failed, the log stopped there.
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::thread m_writer;
+
+            void work();
+            // Stops the writer once everything buffered was written.
+            void close();
+
+        public:
+            // Creates the log and writes its header. Throws std::runtime_error if it cannot be created.
+            SessionLog( const string &path, const Header &header );
+            ~SessionLog();
+            SessionLog & operator=( const SessionLog & ) = delete;
+            SessionLog( const SessionLog & ) = delete;
+
+            // Records a line read by the game, on the board it was read on.
+            void append( Player::prompt_e prompt, const string &line, uint32_t board_idx, const SBoard &player_board );
+
+            // Records what a puzzle source gave a new match: a puzzle, or nullptr if it had none.
+            void append_puzzle( const ReadyPuzzle *puzzle );
+
+            // Records the final state and closes the log; nothing can be appended afterwards.
+            void finish( uint32_t board_idx, const SBoard &player_board );
+
+            // Folds a board into a digest (FNV-1a), the way `append` does for every line.
+            static uint64_t fold( uint64_t digest, uint32_t board_idx, const SBoard &player_board );
+
+            // Tells if every write so far succeeded.
+            bool good();
+
+            // Reads a log. A log cut short (crash) is read up to its last whole line and is not finished.
+            // Throws std::runtime_error if the file is not a session log or is corrupted.
+            static Recording read( const string &path );
+    };
+}
+
+#endif //SUDOKU_SESSION_LOG_H
@@ -0,0 +1,155 @@
+#include <exception>
+#include <iostream>
+#include <new>
+#include "session_scheduler.h"
+
+namespace sdkg {
+
+    namespace {
+        std::atomic<size_t> g_frame_bytes{ 0 };
+    }
+
+    //=== SessionTask
+
+    std::suspend_never SessionTask::promise_type::final_suspend() noexcept {
+        scheduler->on_session_end();
+        return {};
+    }
+
+    void SessionTask::promise_type::unhandled_exception() {
+        // same outcome as an exception escaping the game loop of a single game
+        std::terminate();
+    }
+
+    void * SessionTask::promise_type::operator new(size_t size) {
+        g_frame_bytes += size;
+        return ::operator new(size);
+    }
+
+    void SessionTask::promise_type::operator delete(void *frame, size_t size) {
+        g_frame_bytes -= size;
+        ::operator delete(frame);
+    }
+
+    size_t SessionTask::frame_bytes() {
+        return g_frame_bytes;
+    }
+
+    //=== SessionScheduler
+
+    SessionScheduler::SessionScheduler(unsigned threads)
+        : m_threads{ threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()) } {/*empty*/}
+
+    void SessionScheduler::spawn(SessionTask task) {
+        task.m_handle.promise().scheduler = this;
+        std::coroutine_handle<> handle = std::exchange(task.m_handle, nullptr);
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_live++;
+        }
+        schedule(handle);
+    }
+
+    void SessionScheduler::schedule(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_ready.push_back(handle);
+        }
+        m_wake.notify_one();
+    }
+
+    void SessionScheduler::call_after(clock::duration delay, std::function<void()> fire) {
+        bool earliest;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_timers.push(Timer{ clock::now() + delay, m_timer_order++, std::move(fire) });
+            earliest = m_timers.top().order == m_timer_order - 1;
+        }
+        // a worker may be sleeping until a later deadline
+        if (earliest) m_wake.notify_one();
+    }
+
+    void SessionScheduler::on_session_end() {
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            last = --m_live == 0;
+        }
+        if (last) m_wake.notify_all();
+    }
+
+    void SessionScheduler::take_due_timers(vector<std::function<void()>> &due) {
+        clock::time_point now = clock::now();
+        while (not m_timers.empty() and m_timers.top().when <= now) {
+            due.push_back(std::move(const_cast<Timer &>(m_timers.top()).fire));
+            m_timers.pop();
+        }
+    }
+
+    void SessionScheduler::work() {
+        vector<std::function<void()>> due;
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while (m_live > 0) {
+            take_due_timers(due);
+            if (not due.empty()) {
+                lock.unlock();
+                for (std::function<void()> &fire : due) fire();
+                due.clear();
+                lock.lock();
+                continue;
+            }
+            if (not m_ready.empty()) {
+                std::coroutine_handle<> handle = m_ready.front();
+                m_ready.pop_front();
+                lock.unlock();
+                m_resumes++;
+                handle.resume();
+                lock.lock();
+                continue;
+            }
+            if (m_timers.empty()) m_wake.wait(lock);
+            else m_wake.wait_until(lock, m_timers.top().when);
+        }
+    }
+
+    void SessionScheduler::run() {
+        vector<std::thread> workers;
+        for (unsigned t{1}; t < m_threads; t++) workers.emplace_back(&SessionScheduler::work, this);
+        work();
+        for (std::thread &worker : workers) worker.join();
+    }
+
+    //=== Session
+
+    void Session::wake() {
+        // pairs with the fence of next_input: either the session sees the line, or we see the session waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        void *waiter = m_waiter.exchange(nullptr);
+        if (waiter != nullptr) m_scheduler.schedule(std::coroutine_handle<>::from_address(waiter));
+    }
+
+    bool Session::post(string &&line) {
+        if (not m_game.post_command(std::move(line))) return false;
+        wake();
+        return true;
+    }
+
+    void Session::close() {
+        m_game.close_input();
+        wake();
+    }
+
+    SessionTask run_session(Session &session) {
+        SudokuGame &game = session.m_game;
+        while (not game.game_over()) {
+            game.process_events();
+            Player::prompt_e prompt;
+            if (game.pending_prompt(prompt)) {
+                if (session.m_on_waiting) session.m_on_waiting(session, prompt);
+                co_await session.next_input();
+                continue;
+            }
+            game.update();
+        }
+    }
+}
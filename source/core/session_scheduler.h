@@ -0,0 +1,204 @@
+#ifndef SUDOKU_SESSION_SCHEDULER_H
+#define SUDOKU_SESSION_SCHEDULER_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+#include "sudoku_gm.h"
+
+/*!
+ *  M:N scheduler running many game sessions, as C++20 coroutines, on a few
+ *  worker threads (this header needs C++20, the rest of the core is C++17).
+ *
+ *  A session drives a SudokuGame through the same process_events/update
+ *  steps as the game loop, but instead of polling or sleeping while the game
+ *  waits for a line it suspends: an idle session is a coroutine frame and a
+ *  SudokuGame, no thread, no stack, no wakeup until a line is posted to it.
+ *  Posting a line (from any thread) makes the session runnable again, and
+ *  whichever worker is free resumes it.
+ *
+ *  Runnable sessions wait in one FIFO ready queue; timers (`call_after`,
+ *  `sleep_for`) wait in a heap, and the workers move the due ones to the
+ *  ready queue. A session runs until it suspends again, so sessions must
+ *  not block.
+ *
+ *  How to use it:
+ *  ```c++
+ *      SessionScheduler scheduler{ 4 };
+ *      Session session{ scheduler };
+ *      session.game().initialize(argc, argv, &loaded);
+ *      scheduler.spawn(run_session(session));
+ *      session.post("1");                  // from any thread, e.g. a socket reader
+ *      scheduler.run();                    // until every session is over
+ *  ```
+ */
+
+namespace sdkg {
+
+    class SessionScheduler;
+
+    /// Coroutine type of the sessions: starts suspended, frees its frame when it ends.
+    class SessionTask {
+        public:
+            struct promise_type {
+                SessionScheduler *scheduler = nullptr;     //!< Set by spawn.
+
+                SessionTask get_return_object() { return SessionTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                // tells the scheduler, then lets the frame be destroyed
+                std::suspend_never final_suspend() noexcept;
+                void return_void() {}
+                void unhandled_exception();
+
+                // Frames are counted, so their footprint can be reported.
+                static void * operator new( size_t size );
+                static void operator delete( void *frame, size_t size );
+            };
+
+        private:
+            std::coroutine_handle<promise_type> m_handle;
+
+            explicit SessionTask( std::coroutine_handle<promise_type> handle ) : m_handle{handle} {/*empty*/}
+            friend class SessionScheduler;
+
+        public:
+            SessionTask( SessionTask &&other ) noexcept : m_handle{ std::exchange(other.m_handle, nullptr) } {/*empty*/}
+            SessionTask & operator=( SessionTask && ) = delete;
+            ~SessionTask() { if (m_handle) m_handle.destroy(); }    // never spawned
+
+            /// Bytes taken by the frames of the live sessions.
+            static size_t frame_bytes();
+    };
+
+    class SessionScheduler {
+        public:
+            typedef std::chrono::steady_clock clock;
+
+        private:
+            struct Timer {
+                clock::time_point when;
+                uint64_t order;                     //!< Ties resolved first come, first served.
+                std::function<void()> fire;
+                bool operator>( const Timer &other ) const {
+                    return when != other.when ? when > other.when : order > other.order;
+                }
+            };
+
+            unsigned m_threads;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::deque<std::coroutine_handle<>> m_ready;
+            std::priority_queue<Timer, vector<Timer>, std::greater<Timer>> m_timers;
+            uint64_t m_timer_order = 0;
+            size_t m_live = 0;                      //!< Spawned sessions that did not end yet.
+            std::atomic<size_t> m_resumes{ 0 };
+
+            void work();
+            // Moves the due timers out of the heap, the lock held.
+            void take_due_timers( vector<std::function<void()>> &due );
+
+        public:
+            /// Runs the sessions on `threads` workers (0 = one per core).
+            explicit SessionScheduler( unsigned threads=0 );
+            SessionScheduler & operator=( const SessionScheduler & ) = delete;
+            SessionScheduler( const SessionScheduler & ) = delete;
+
+            // Adds a session, runnable right away.
+            void spawn( SessionTask task );
+
+            // Makes a suspended coroutine runnable, from any thread.
+            void schedule( std::coroutine_handle<> handle );
+
+            // Calls `fire` on a worker once `delay` elapsed. It must not block either.
+            void call_after( clock::duration delay, std::function<void()> fire );
+
+            // Called by the sessions as they end.
+            void on_session_end();
+
+            // Runs the workers until every session spawned ended.
+            void run();
+
+            inline unsigned threads() const { return m_threads; }
+            inline size_t resumes() const { return m_resumes; }
+
+            /// `co_await scheduler.sleep_for(d)` suspends a session for `d`, freeing its worker.
+            auto sleep_for( clock::duration delay ) {
+                struct Awaiter {
+                    SessionScheduler &scheduler;
+                    clock::duration delay;
+                    bool await_ready() const noexcept { return delay <= clock::duration::zero(); }
+                    void await_suspend( std::coroutine_handle<> handle ) {
+                        scheduler.call_after(delay, [scheduler = &scheduler, handle]() { scheduler->schedule(handle); });
+                    }
+                    void await_resume() const noexcept {}
+                };
+                return Awaiter{ *this, delay };
+            }
+    };
+
+    /// A SudokuGame played through a SessionScheduler, fed by posted lines.
+    class Session {
+        public:
+            /// Called right before the session suspends for a line, with the prompt it waits an answer for.
+            typedef std::function<void( Session &, Player::prompt_e )> waiting_t;
+
+        private:
+            SessionScheduler &m_scheduler;
+            SudokuGame m_game;
+            std::atomic<void *> m_waiter{ nullptr };  //!< Frame address of the suspended session, if waiting a line.
+            waiting_t m_on_waiting;
+
+            // Resumes the session if it waits a line.
+            void wake();
+
+        public:
+            explicit Session( SessionScheduler &scheduler ) : m_scheduler{scheduler} {/*empty*/}
+            Session & operator=( const Session & ) = delete;
+            Session( const Session & ) = delete;
+
+            inline SudokuGame & game() { return m_game; }
+            inline const SudokuGame & game() const { return m_game; }
+
+            inline void on_waiting( waiting_t callback ) { m_on_waiting = std::move(callback); }
+
+            // Queues a line for the game and resumes it. One producer at a time (see SpscQueue).
+            bool post( string &&line );
+
+            // No more lines will come: the game quits once the queued ones are handled.
+            void close();
+
+            /// `co_await session.next_input()` suspends until a line was posted (or the input closed).
+            auto next_input() {
+                struct Awaiter {
+                    Session &session;
+                    bool await_ready() const { return session.m_game.has_input(); }
+                    bool await_suspend( std::coroutine_handle<> handle ) {
+                        session.m_waiter.store(handle.address());
+                        std::atomic_thread_fence(std::memory_order_seq_cst);
+                        // a line posted since await_ready found no waiter: take the handle back and go on
+                        if (session.m_game.has_input()) return session.m_waiter.exchange(nullptr) == nullptr;
+                        return true;
+                    }
+                    void await_resume() const noexcept {}
+                };
+                return Awaiter{ *this };
+            }
+
+            friend SessionTask run_session( Session &session );
+    };
+
+    /// The game loop of a session: process_events and update, suspending while the game waits a line.
+    SessionTask run_session( Session &session );
+}
+
+#endif //SUDOKU_SESSION_SCHEDULER_H
@@ -0,0 +1,67 @@
+#include "solution_cache.h"
+#include "sudoku_solver.h"
+
+namespace sdkg {
+
+    SolutionCache::SolutionCache(solver_t solver) : m_solver{std::move(solver)} {
+        if (not m_solver) m_solver = []( const SBoard &puzzle, SBoard &solution ) { return SudokuSolver(puzzle).solve(solution); };
+    }
+
+    SolutionCache::~SolutionCache() {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stop = true;
+        }
+        m_has_work.notify_all();
+        if (m_worker.joinable()) m_worker.join();
+    }
+
+    SolutionCache::Entry SolutionCache::solve(const SBoard &puzzle) const {
+        Entry entry;
+        entry.solvable = m_solver(puzzle, entry.solution);
+        return entry;
+    }
+
+    void SolutionCache::prefetch(int board_idx, BoardView puzzle) {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (m_solved.count(board_idx)) return;
+        for (const std::pair<int, SBoard> &p : m_pending) {
+            if (p.first == board_idx) return;
+        }
+        m_pending.emplace_back(board_idx, SBoard());
+        puzzle.copy_to(m_pending.back().second);    // the worker may outlive the pool's buffer
+        if (not m_worker.joinable()) m_worker = std::thread(&SolutionCache::work, this);
+        m_has_work.notify_one();
+    }
+
+    bool SolutionCache::get(int board_idx, BoardView puzzle, SBoard &solution) {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        auto it = m_solved.find(board_idx);
+        if (it == m_solved.end()) {
+            // Not solved yet (or still waiting in the queue): solving here is faster than waiting.
+            lock.unlock();
+            SBoard board;
+            puzzle.copy_to(board);
+            Entry entry = solve(board);
+            lock.lock();
+            it = m_solved.emplace(board_idx, entry).first;
+        }
+        solution = it->second.solution;
+        return it->second.solvable;
+    }
+
+    void SolutionCache::work() {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while (true) {
+            m_has_work.wait(lock, [this]() { return m_stop or not m_pending.empty(); });
+            if (m_stop) return;
+            std::pair<int, SBoard> job = m_pending.front();
+            m_pending.pop_front();
+            if (m_solved.count(job.first)) continue;
+            lock.unlock();
+            Entry entry = solve(job.second);
+            lock.lock();
+            m_solved.emplace(job.first, entry);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SUDOKU_SOLUTION_CACHE_H
+#define SUDOKU_SOLUTION_CACHE_H
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+using std::map;
+#include <mutex>
+#include <thread>
+#include "sudoku_board.h"
+
+/*!
+ *  Memoized solutions of clue-only boards.
+ *
+ *  Boards that ship without their solution are solved the first time the
+ *  solution is needed (the first placement check), and the result is kept
+ *  for the next time the same board is played. Boards that are about to be
+ *  played can be handed to `prefetch()`, which solves them on a background
+ *  thread so the solution is usually ready before the player needs it.
+ */
+
+namespace sdkg {
+
+    class SolutionCache {
+        public:
+            /// Solves a puzzle (givens are its positive values), returns false if it has no solution.
+            typedef std::function<bool( const SBoard &, SBoard & )> solver_t;
+
+        private:
+            /// A memoized result, `solvable` is false if the clues admit no solution.
+            struct Entry {
+                bool solvable;
+                SBoard solution;
+            };
+
+            map<int, Entry> m_solved;                             //!< Solutions found so far, by board index.
+            std::deque<std::pair<int, SBoard>> m_pending;         //!< Boards waiting for the background solver.
+            std::mutex m_mutex;
+            std::condition_variable m_has_work;
+            std::thread m_worker;                                 //!< Started on the first prefetch.
+            bool m_stop = false;
+            solver_t m_solver;                                    //!< SudokuSolver, or a variant's solver.
+
+            void work();
+            Entry solve( const SBoard &puzzle ) const;
+
+        public:
+            // Solves with SudokuSolver (classic rules) unless given another solver.
+            explicit SolutionCache( solver_t solver=nullptr );
+            ~SolutionCache();
+            SolutionCache & operator=( const SolutionCache & ) = delete;
+            SolutionCache( const SolutionCache & ) = delete;
+
+            // Queues a board to be solved in the background, if it was not solved yet.
+            void prefetch( int board_idx, BoardView puzzle );
+
+            // Gets the solution of a board, solving it right away if needed. Returns false if unsolvable.
+            bool get( int board_idx, BoardView puzzle, SBoard &solution );
+    };
+}
+
+#endif
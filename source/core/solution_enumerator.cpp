@@ -0,0 +1,76 @@
+#include <mutex>
+#include <vector>
+using std::vector;
+#include "solution_enumerator.h"
+#include "sudoku_solver.h"
+#include "work_stealing_pool.h"
+
+namespace sdkg {
+
+    SolutionEnumerator::SolutionEnumerator(const SBoard &puzzle, size_t limit, unsigned threads)
+        : m_puzzle{puzzle}, m_limit{limit}, m_threads{threads} {/*empty*/}
+
+    SolutionEnumerator::Result SolutionEnumerator::count() {
+        return run(nullptr);
+    }
+
+    SolutionEnumerator::Result SolutionEnumerator::enumerate(const callback_t &on_solution) {
+        return run(&on_solution);
+    }
+
+    SolutionEnumerator::Result SolutionEnumerator::run(const callback_t *on_solution) {
+        std::atomic<size_t> found{ 0 };
+        // raised by the limit or by cancel(); cleared first, so a cancel() racing this start is not lost
+        std::atomic<bool> &stop = m_stop;
+        stop = false;
+        if (m_cancelled) stop = true;
+        std::atomic<bool> cut{ false };     // some part of the tree was left unexplored
+        std::mutex callback_mutex;
+
+        // shared by every task: counts the solution, streams it and raises `stop` at the limit
+        SudokuSolver::visitor_t visit = [&](const SudokuSolver &solver) {
+            if (m_cancelled) { stop = true; return false; }
+            size_t n = ++found;
+            if (m_limit != 0 and n > m_limit) { stop = true; return false; }
+            if (on_solution != nullptr) {
+                SBoard solution;
+                solver.to_board(solution);
+                std::lock_guard<std::mutex> lock{callback_mutex};
+                (*on_solution)(solution);
+            }
+            // the search goes on to its next node, where it stops: if there is none, the limit cut nothing off
+            if (m_limit != 0 and n == m_limit) stop = true;
+            return true;
+        };
+
+        SudokuSolver root{ m_puzzle };
+        if (m_threads == 1) {
+            if (not root.for_each_solution(visit, &stop)) cut = true;
+        } else {
+            WorkStealingPool pool{ m_threads };
+            // while some worker is idle, a task hands it the other branches of its next choice (through its own
+            // deque, where thieves take the oldest, i.e. biggest, subtrees first) and goes down the first branch
+            std::function<void( SudokuSolver & )> search = [&](SudokuSolver &subtree) {
+                vector<SudokuSolver> children;
+                while (not stop and pool.idle_workers() > 0) {
+                    children.clear();
+                    subtree.split(1, children);
+                    if (children.size() < 2) break;     // a dead end or a solution: nothing to share
+                    for (size_t k{1}; k < children.size(); k++) {
+                        pool.submit([&search, child = std::move(children[k])]() mutable { search(child); });
+                    }
+                    subtree = std::move(children.front());
+                }
+                if (stop or not subtree.for_each_solution(visit, &stop)) cut = true;
+            };
+            pool.submit([&search, &root]() { search(root); });
+            pool.wait();
+        }
+
+        Result result;
+        result.cancelled = m_cancelled;
+        result.count = (m_limit != 0 and found > m_limit) ? m_limit : found.load();
+        result.limit_reached = m_limit != 0 and result.count == m_limit and cut and not result.cancelled;
+        return result;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef SUDOKU_SOLUTION_ENUMERATOR_H
+#define SUDOKU_SOLUTION_ENUMERATOR_H
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include "sudoku_board.h"
+
+/*!
+ *  Parallel counting/enumeration of every solution of a board.
+ *
+ *  The search runs as tasks on a WorkStealingPool, split on demand: a task
+ *  that sees an idle worker hands it the other branches of its next choice,
+ *  so unbalanced trees keep every worker busy. The search
+ *  stops as soon as `limit` solutions were found (0 means no limit) or
+ *  `cancel()` is called from any thread.
+ *
+ *  Positive values of the board are the clues, any other value is a
+ *  location to fill, as in SudokuSolver.
+ */
+
+namespace sdkg {
+
+    class SolutionEnumerator {
+        public:
+            /// Receives each solution found; calls are serialized, so it needs no locking of its own.
+            typedef std::function<void( const SBoard & )> callback_t;
+
+            /// Outcome of a count or enumeration.
+            struct Result {
+                size_t count = 0;             //!< # of solutions found (never more than the limit).
+                bool limit_reached = false;   //!< Search cut off at the limit: there may be more solutions.
+                bool cancelled = false;       //!< Search stopped because cancel() was called.
+            };
+
+        private:
+            SBoard m_puzzle;
+            size_t m_limit;                       //!< Maximum # of solutions to find, 0 = all.
+            unsigned m_threads;                   //!< # of worker threads, 0 = one per core.
+            std::atomic<bool> m_cancelled{ false };
+            std::atomic<bool> m_stop{ false };    //!< Polled by every node of the running search.
+
+            Result run( const callback_t *on_solution );
+
+        public:
+            explicit SolutionEnumerator( const SBoard &puzzle, size_t limit=0, unsigned threads=0 );
+
+            // Counts the solutions.
+            Result count();
+
+            // Streams every solution to `on_solution`, in no particular order.
+            Result enumerate( const callback_t &on_solution );
+
+            // Stops a running (or the next) search, may be called from any thread.
+            inline void cancel() { m_cancelled = true; m_stop = true; }
+    };
+}
+
+#endif //SUDOKU_SOLUTION_ENUMERATOR_H
@@ -1,24 +1,36 @@
 #include <algorithm>
+#include <charconv>
 #include <istream>
 #include <fstream>
 using std::ifstream;
 using std::fstream;
-#include <set>
-using std::set;
 #include <map>
 using std::map;
+#include <chrono>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include "sudoku_board.h"
 #include "sudoku_gm.h"
+#include "solution_cache.h"
+#include "board_io.h"
+#include "board_archive.h"
+#include "solution_enumerator.h"
+#include "sudoku_solver.h"
+#include "batch_validator.h"
+#include "work_stealing_pool.h"
+#include "board_geometry.h"
+#include "variant_rules.h"
 #include "config.h"
 #include "../lib/contains.h"
-#include "../utils/split.h"
 
 
 namespace sdkg {
     SBoard::SBoard()
     {
         // Empty board.
-        std::fill( &board[0][0], &board[Config::SB_SIZE][Config::SB_SIZE], 0 );
+        std::fill( &board[0][0], &board[0][0] + Config::SB_SIZE * Config::SB_SIZE, 0 );
     }
 
     void SBoard::set_board( short b[Config::SB_SIZE][Config::SB_SIZE] ) {
@@ -29,103 +41,306 @@ namespace sdkg {
         }
     };
 
-    bool SBoardManager::is_valid(const SBoard sb)
+    template < typename Rules >
+    BasicSBoardManager<Rules>::BasicSBoardManager(const Rules &rules)
+        : m_rules{ rules }, m_boards_read{ std::make_shared<BoardPool>() }, m_difficulty{ std::make_shared<DifficultyBuckets>() },
+          m_input_files{ std::make_shared<const vector<FileStats>>() } {/*empty*/}
+
+    template < typename Rules >
+    BasicSBoardManager<Rules>::~BasicSBoardManager() = default;
+
+    template < typename Rules >
+    bool BasicSBoardManager<Rules>::is_valid(const SBoard &sb) const
     {
-        int line_sum = 0, col_sum = 0;
-        set<short> col_appeared, lin_appeared;
-        auto are_equal = [](const short &a, const short &b) { return a == b; };
-
-        for (short lin{0}; lin < Config::SB_SIZE; lin++) {
-            for (short col{0}; col < Config::SB_SIZE; col++) {
-                // verifies if number is not on a valid range
-                if (sb.at(lin, col) < 1 or sb.at(lin, col) > 9)
-                    return false;
-                // verifies if number is repeating on column
-                if (contains(col_appeared.begin(), col_appeared.end(), sb.at(col, lin), are_equal))
-                    return false;
-                // verifies if number is repeating on lin
-                if (contains(lin_appeared.begin(), lin_appeared.end(), sb.at(lin, col), are_equal))
-                    return false;
-                col_appeared.insert(sb.at(col, lin));
-                lin_appeared.insert(sb.at(lin, col));
-                col_sum += sb.at(col, lin);
-                line_sum += sb.at(lin, col);
+        bool clue_only = false;
+        return validate_batch(&sb, 1, &clue_only, m_rules) & 1u;
+    }
+
+    template < typename Rules >
+    uint32_t BasicSBoardManager<Rules>::validate_batch(const SBoard *boards, size_t n, const bool *clue_only, const Rules &rules) {
+        uint32_t valid = 0;
+        if constexpr (std::is_same<Rules, ClassicRules>::value) {
+            BatchValidator::Result result = BatchValidator::validate(boards, n);
+            for (size_t l{0}; l < n; l++) valid |= (clue_only[l] ? result.consistent : result.complete) & (1u << l);
+        } else {
+            for (size_t l{0}; l < n; l++) {
+                if (is_consistent(boards[l], rules, not clue_only[l])) valid |= 1u << l;
             }
-            if (line_sum != 45 or col_sum != 45) return false;
-            col_appeared.clear();
-            lin_appeared.clear();
-            line_sum = 0;
-            col_sum = 0;
         }
-        return true;
+        return valid;
     }
 
-    void SBoardManager::read_input_file(const string &path_to_file) {
-        ifstream file{path_to_file, fstream::in};
-        SBoard sb;
-        vector<string> tokens;
-        string input;
-        auto is_empty_string = [](const string &str) { return str.empty(); };
-        short
-            b_original[Config::SB_SIZE][Config::SB_SIZE],
-            b_abs[Config::SB_SIZE][Config::SB_SIZE], num,
-            num_invalid_boards = 0;
-        try {
-            if (not file)
-                throw std::runtime_error("File could not be opened!\n"); // verifies if file was opened successfully
-            while (getline(file, input)) {
-                if (not input.empty()) {
+    template < typename Rules >
+    std::shared_ptr<SolutionCache> BasicSBoardManager<Rules>::make_solution_cache() const {
+        if constexpr (std::is_same<Rules, ClassicRules>::value) {
+            return std::make_shared<SolutionCache>();
+        } else {
+            return std::make_shared<SolutionCache>([rules = m_rules]( const SBoard &puzzle, SBoard &solution ) {
+                return BasicSudokuSolver<Rules>(puzzle, rules).solve(solution);
+            });
+        }
+    }
+
+    template < typename Rules >
+    size_t BasicSBoardManager<Rules>::ingest_boards(const SBoard *boards_original, size_t n, BoardPool &pool, const Rules &rules) {
+        SBoard checked[BatchValidator::LANES];
+        bool clue_only[BatchValidator::LANES];
+        size_t num_invalid_boards = 0;
+        for (size_t first{0}; first < n; first += BatchValidator::LANES) {
+            size_t batch = std::min(BatchValidator::LANES, n - first);
+            for (size_t l{0}; l < batch; l++) {
+                const SBoard &sb_original = boards_original[first + l];
+                clue_only[l] = false;
+                for (short i{0}; i < Config::SB_SIZE; i++) {
+                    for (short j{0}; j < Config::SB_SIZE; j++) {
+                        short num = sb_original.at(i, j);
+                        checked[l].set_loc(i, j, (num >= 0) ? num : (short) (num * -1));
+                        if (num == 0) clue_only[l] = true;
+                    }
+                }
+                if (clue_only[l]) {
+                    // Clue-only board: hidden locations are unknown, its solution is derived when first needed.
                     for (short i{0}; i < Config::SB_SIZE; i++) {
-                        tokens = split(input);
-                        // remove empty strings from vector of token strings
-                        std::remove_if(tokens.begin(), tokens.end(), is_empty_string);
                         for (short j{0}; j < Config::SB_SIZE; j++) {
-                            num = (short) std::stoi(tokens.at(j));
-                            b_original[i][j] = num;
-                            b_abs[i][j] = (num >= 0) ? num : num * - 1;
+                            if (sb_original.at(i, j) < 0) checked[l].set_loc(i, j, 0);
                         }
-                        getline(file, input);
                     }
-                    sb.set_board(b_abs);
-                    if (is_valid(sb)) { sb.set_board(b_original); add_board(sb); }
-                    else num_invalid_boards++;
                 }
             }
-            m_num_invalid_boards_read = num_invalid_boards;
+            // clue-only boards only need to be consistent, boards with their solution must be solved boards
+            uint32_t valid = validate_batch(checked, batch, clue_only, rules);
+            for (size_t l{0}; l < batch; l++) {
+                if (not ((valid >> l) & 1u)) num_invalid_boards++;
+                else if (clue_only[l]) pool.push_back(checked[l]);
+                else pool.push_back(boards_original[first + l]);
+            }
+        }
+        return num_invalid_boards;
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::share_boards(const BasicSBoardManager &other) {
+        m_rules = other.m_rules;
+        m_boards_read = other.m_boards_read;
+        m_solutions = other.m_solutions;
+        m_difficulty = other.m_difficulty;
+        m_input_files = other.m_input_files;
+        m_num_invalid_boards_read = other.m_num_invalid_boards_read;
+        m_num_non_unique_boards_read = other.m_num_non_unique_boards_read;
+        m_pending_solution_idx = -1;
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::read_one_file(FileStats &stats, BoardPool &pool, DifficultyBuckets &difficulty, bool check_uniqueness,
+                                                  const Rules &rules, unsigned archive_threads) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            if (BoardArchive::is_archive(stats.path)) {
+                vector<SBoard> boards = BoardArchive(stats.path).read_all(archive_threads);
+                pool.reserve(boards.size());
+                stats.invalid += ingest_boards(boards.data(), boards.size(), pool, rules);
+            } else {
+                ifstream file{stats.path, fstream::in};
+                if (not file) throw std::runtime_error("File could not be opened!\n");
+                // boards are validated in batches, see BatchValidator; malformed ones count as invalid
+                SBoard batch[BatchValidator::LANES];
+                size_t batch_size = 0;
+                for (read_status_e status; (status = try_read_board(file, batch[batch_size])) != END_OF_INPUT; ) {
+                    if (status == BOARD_MALFORMED) {
+                        stats.invalid++;
+                    } else if (++batch_size == BatchValidator::LANES) {
+                        stats.invalid += ingest_boards(batch, batch_size, pool, rules);
+                        batch_size = 0;
+                    }
+                }
+                stats.invalid += ingest_boards(batch, batch_size, pool, rules);
+                file.close();
+            }
+            std::error_code size_error;
+            stats.bytes = std::filesystem::file_size(stats.path, size_error);
+            if (size_error) stats.bytes = 0;
+            stats.valid = pool.size();
+            difficulty = DifficultyBuckets(pool);
+            if (check_uniqueness) {
+                // one thread per file already, the enumerator needs no more
+                pool.scan(0, pool.size(), [&]( size_t, BoardView board ) {
+                    if (count_clue_solutions(board, 2, 1, rules) > 1) stats.non_unique++;
+                });
+            }
+        } catch (const std::exception &e) {
+            stats.error = e.what();
+            stats.valid = stats.invalid = stats.non_unique = 0;
+            pool.clear();
+            difficulty = DifficultyBuckets();
         }
-        catch (const std::exception &e) {
-            std::cerr << Color::tcolor("\n>>> An error occurred while reading the file\n", Color::BRIGHT_RED);
-            std::cerr << Color::tcolor(e.what(), Color::BRIGHT_RED);
-            exit(1);
-            
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::read_input_file(const string &path_to_file) {
+        const vector<FileStats> &files = read_input_files({ path_to_file }, 1);
+        if (not files.front().error.empty()) throw std::runtime_error(files.front().error);
+    }
+
+    template < typename Rules >
+    const vector<typename BasicSBoardManager<Rules>::FileStats> & BasicSBoardManager<Rules>::read_input_files(const vector<string> &paths_to_files, unsigned threads) {
+        size_t n_files = paths_to_files.size();
+        auto files = std::make_shared<vector<FileStats>>(n_files);
+        vector<BoardPool> pools(n_files);
+        vector<DifficultyBuckets> ratings(n_files);
+        for (size_t f{0}; f < n_files; f++) (*files)[f].path = paths_to_files[f];
+
+        // every file is loaded apart, then the pools are concatenated in the order given: a stable order
+        // whatever the loads end in. A single file is read right here, no pool needed, and it alone may spread
+        // an archive's decoding over the threads: inside the pool that would mean threads per loader.
+        if (n_files == 1 or threads == 1) {
+            for (size_t f{0}; f < n_files; f++) {
+                read_one_file((*files)[f], pools[f], ratings[f], m_check_uniqueness, m_rules, threads);
+            }
+        } else {
+            WorkStealingPool loaders{ (unsigned) std::min<size_t>(threads != 0 ? threads : std::thread::hardware_concurrency(), n_files) };
+            for (size_t f{0}; f < n_files; f++) {
+                loaders.submit([&, f]() { read_one_file((*files)[f], pools[f], ratings[f], m_check_uniqueness, m_rules, 1); });
+            }
+            loaders.wait();
+        }
+
+        // a new pool, managers sharing the previous one keep it
+        auto boards = std::make_shared<BoardPool>();
+        auto difficulty = std::make_shared<DifficultyBuckets>();
+        size_t total = 0;
+        for (const BoardPool &pool : pools) total += pool.size();
+        boards->reserve(total);
+        m_num_invalid_boards_read = m_num_non_unique_boards_read = 0;
+        for (size_t f{0}; f < n_files; f++) {
+            FileStats &stats = (*files)[f];
+            stats.first = boards->size();
+            difficulty->append(ratings[f], (uint32_t) stats.first);
+            boards->append(pools[f]);
+            m_num_invalid_boards_read += stats.invalid;
+            m_num_non_unique_boards_read += stats.non_unique;
         }
-        file.close();
+        m_boards_read = std::move(boards);
+        m_difficulty = std::move(difficulty);
+        m_solutions = make_solution_cache();
+        m_pending_solution_idx = -1;
+        m_input_files = std::move(files);
+        return *m_input_files;
     }
 
-    void SBoardManager::set_player_board(const int &board_idx) {
-        if (board_idx >= (short) (m_boards_read.size()) or board_idx < 0) {
+    template < typename Rules >
+    size_t BasicSBoardManager<Rules>::count_clue_solutions(BoardView board, size_t limit, unsigned threads, const Rules &rules) {
+        // only the clues matter, the hidden values (negatives) are one of the possible solutions
+        SBoard clues;
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                if (board.at(i, j) > 0) clues.set_loc(i, j, board.at(i, j));
+            }
+        }
+        if constexpr (std::is_same<Rules, ClassicRules>::value) {
+            return SolutionEnumerator(clues, limit, threads).count().count;
+        } else {
+            // variants are counted on this thread, the enumerator splits the classic search only
+            return BasicSudokuSolver<Rules>(clues, rules).count_solutions(limit != 0 ? limit : SIZE_MAX);
+        }
+    }
+
+    template < typename Rules >
+    size_t BasicSBoardManager<Rules>::count_solutions(int board_idx, size_t limit, unsigned threads) const {
+        return count_clue_solutions(m_boards_read->at(board_idx), limit, threads, m_rules);
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::write_input_file(const string &path_to_file) const {
+        std::ofstream file{path_to_file, fstream::out | fstream::trunc};
+        if (not file) throw std::runtime_error("File could not be created!\n");
+        SBoard sb;
+        m_boards_read->scan(0, m_boards_read->size(), [&]( size_t, BoardView board ) {
+            board.copy_to(sb);
+            write_board(file, sb);
+        });
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::write_archive(const string &path_to_file, bool keep_solutions) const {
+        BoardArchive::write(path_to_file, *m_boards_read, keep_solutions);
+    }
+
+    template < typename Rules >
+    auto BasicSBoardManager<Rules>::parse_sudoku_digit(const string &token) noexcept -> result_t<short> {
+        const char *first = token.data(), *last = token.data() + token.size();
+        while (first < last and (*first == ' ' or (*first >= '\t' and *first <= '\r'))) first++;
+        if (first < last and *first == '+') first++;
+        short digit = 0;
+        auto [next, error] = std::from_chars(first, last, digit);
+        // like stoi, which commands were read with, the number may be followed by anything: "7x" is 7
+        if (error == std::errc::result_out_of_range) return unexpected(error_e::DIGIT_OUT_OF_RANGE);
+        if (error != std::errc() or next == first) return unexpected(error_e::NOT_A_NUMBER);
+        return check_sudoku_digit(digit);
+    }
+
+    template < typename Rules >
+    const char * BasicSBoardManager<Rules>::error_message(error_e error) noexcept {
+        switch (error) {
+            case error_e::DIGIT_OUT_OF_RANGE: return "Sudoku digit must be in range [1, 9]!";
+            case error_e::NOT_A_NUMBER: return "Line, column and digit must be numbers!";
+            case error_e::MISSING_ARGUMENT: return "Missing line, column or digit!";
+            case error_e::BAD_BOARD_INDEX: return "Invalid board index!";
+        }
+        return "Unknown error!";
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::set_player_board(const int &board_idx) {
+        if (not try_set_player_board(board_idx)) {
             throw std::runtime_error("set_player_board -> Invalid board index: " + std::to_string(board_idx) + "\n");
         }
-        SBoard board_chosen{ m_boards_read.at(board_idx) };
+    }
+
+    template < typename Rules >
+    auto BasicSBoardManager<Rules>::try_set_player_board(int board_idx) noexcept -> result_t<void> {
+        if (board_idx >= (int) (m_boards_read->size()) or board_idx < 0) return unexpected(error_e::BAD_BOARD_INDEX);
+        set_player_board((*m_boards_read)[board_idx]);
+        return {};
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::set_player_board(BoardView board_chosen) {
+        short clues = 0;
         for (short i{0}; i < Config::SB_SIZE; i++) {
             for (short j{0}; j < Config::SB_SIZE; j++) {
                 if (board_chosen.at(i, j) > 0) {
                     m_player_board.set_loc(i, j, board_chosen.at(i, j));
-                } else if (board_chosen.at(i, j) < 0){
+                    clues++;
+                } else {
                     m_player_board.set_loc(i, j, loc_type_e::EMPTY);
                 }
             }
         }
+        std::fill(std::begin(m_loc_counts), std::end(m_loc_counts), 0);
+        m_loc_counts[ORIGINAL] = clues;
+        m_loc_counts[EMPTY] = (short) (Config::SB_SIZE * Config::SB_SIZE - clues);
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::play_board(BoardView board) {
+        if (board.has_blanks()) throw std::invalid_argument("play_board -> The board does not carry its solution\n");
+        set_player_board(board);
+        set_solution_board(board);
+    }
 
+    template < typename Rules >
+    std::pair<typename BasicSBoardManager<Rules>::loc_type_e, short> BasicSBoardManager<Rules>::decode_player_board_loc(short line, short column) const {
+        return decode(m_player_board.at(line, column));
     }
 
-    std::pair<SBoardManager::loc_type_e, short> SBoardManager::decode_player_board_loc(short line, short column) const {
-        loc_type_e code;
-        short value;
-        short player_board_loc = m_player_board.at(line, column);
-        if (player_board_loc == 0) {
-            code = loc_type_e::EMPTY;
-            value = 0;
+    template < typename Rules >
+    std::pair<typename BasicSBoardManager<Rules>::loc_type_e, short> BasicSBoardManager<Rules>::decode(short player_board_loc) {
+        // anything else than the encodings below (hidden values, bad prefixes) reads as an empty location
+        loc_type_e code = loc_type_e::EMPTY;
+        short value = 0;
+        if (player_board_loc > 39 or player_board_loc % 10 == 0) {
+            /* empty */
         } else if (player_board_loc >= 31) {
             code = loc_type_e::INVALID;
             value = (short) (player_board_loc - 30);
@@ -142,15 +357,34 @@ namespace sdkg {
         return { code, value };
     }
 
-    short SBoardManager::encode_value(SBoardManager::prefix_e command_status, short value) {
+    template < typename Rules >
+    short BasicSBoardManager<Rules>::encode_value(prefix_e command_status, short value) {
         return (short) (command_status + value);
     }
 
-    void SBoardManager::set_solution_board(const int &board_idx) {
-        if (board_idx >= (short) (m_boards_read.size()) or board_idx < 0) {
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::set_solution_board(const int &board_idx) {
+        if (not try_set_solution_board(board_idx)) {
             throw std::invalid_argument("set_solution_board -> Invalid board index: " + std::to_string(board_idx) + "\n");
         }
-        SBoard board_chosen{ m_boards_read.at(board_idx) };
+    }
+
+    template < typename Rules >
+    auto BasicSBoardManager<Rules>::try_set_solution_board(int board_idx) noexcept -> result_t<void> {
+        if (board_idx >= (int) (m_boards_read->size()) or board_idx < 0) return unexpected(error_e::BAD_BOARD_INDEX);
+        BoardView board_chosen = (*m_boards_read)[board_idx];
+        if (board_chosen.has_blanks()) {
+            m_pending_solution_idx = board_idx;
+            return {};
+        }
+        set_solution_board(board_chosen);
+        return {};
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::set_solution_board(BoardView board_chosen) {
+        m_pending_solution_idx = -1;
+        m_solvable = true;
         for (short i{0}; i < Config::SB_SIZE; i++) {
             for (short j{0}; j < Config::SB_SIZE; j++) {
                 if (board_chosen.at(i, j) > 0) {
@@ -162,10 +396,35 @@ namespace sdkg {
         }
     }
 
-    vector<short> SBoardManager::get_digits_left_to_place() const {
+    template < typename Rules >
+    bool BasicSBoardManager<Rules>::derive_solution() {
+        if (m_pending_solution_idx < 0) return m_solvable;
+        if (not m_solutions) m_solutions = make_solution_cache();
+        // An unsolvable board leaves an empty solution, so every play is reported as incorrect (SudokuGame::serve_board moves past it).
+        m_solvable = m_solutions->get(m_pending_solution_idx, m_boards_read->at(m_pending_solution_idx), m_solution);
+        if (not m_solvable) m_solution = SBoard();
+        m_pending_solution_idx = -1;
+        return m_solvable;
+    }
+
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::prefetch_solutions(int first_idx, int count) {
+        if (m_boards_read->empty()) return;
+        for (int k{0}; k < count; k++) {
+            int board_idx = (int) ((first_idx + k) % m_boards_read->size());
+            if (not (*m_boards_read)[board_idx].has_blanks()) continue;
+            if (not m_solutions) m_solutions = make_solution_cache();
+            m_solutions->prefetch(board_idx, (*m_boards_read)[board_idx]);
+        }
+    }
+
+    template < typename Rules >
+    vector<short> BasicSBoardManager<Rules>::get_digits_left_to_place() const {
         vector<short> digits_left_to_place;
         map<short, int> digits_found;
         short player_board_num;
+        // digits missing from the board must be listed too (sparse clue-only boards may lack some)
+        for (short d{Config::SUDOKU_SMALLEST_NUM}; d <= Config::SUDOKU_BIGGEST_NUM; d++) digits_found[d] = 0;
         // map quantity of each digit on board
         for (short i{0}; i < Config::SB_SIZE; i++) {
             for (short j{0}; j < Config::SB_SIZE; j++) {
@@ -179,18 +438,20 @@ namespace sdkg {
         return digits_left_to_place;
     }
 
-    void SBoardManager::place_digit_on_board(SBoardManager::prefix_e code, short line, short column, short digit) {
-        m_player_board.set_loc(line, column, encode_value(code, digit));
+    template < typename Rules >
+    void BasicSBoardManager<Rules>::place_digit_on_board(prefix_e code, short line, short column, short digit) {
+        set_player_loc(line, column, encode_value(code, digit));
     }
 
-    SBoardManager::loc_type_e SBoardManager::get_placing_status(short line, short column, short digit) {
+    template < typename Rules >
+    typename BasicSBoardManager<Rules>::loc_type_e BasicSBoardManager<Rules>::get_placing_status(short line, short column, short digit) {
+        derive_solution();
         vector<short> digits_left_to_place = get_digits_left_to_place();
-        for (int i{0}; i < Config::SB_SIZE; i++) {
-            if (
-                    decode_player_board_loc(line, i).second == digit or
-                    decode_player_board_loc(i, column).second == digit
-            ) return loc_type_e::INVALID;
-        }
+        short cell = BoardGeometry::cell_of(line, column);
+        if (decode_player_board_loc(line, column).second == digit) return loc_type_e::INVALID;
+        // the digit must follow the rules: not repeat in the location's row, column or box, and the variant's own
+        auto value_at = [this]( short peer ) { return decode_player_board_loc(GEOMETRY.line[peer], GEOMETRY.column[peer]).second; };
+        if (not m_rules.allows(cell, digit, value_at)) return loc_type_e::INVALID;
         if (not contains(digits_left_to_place.begin(), digits_left_to_place.end(), digit, [](short a, short b) { return a==b; })) {
             return loc_type_e::INVALID;
         } else if (digit != m_solution.at(line, column)) {
@@ -200,5 +461,9 @@ namespace sdkg {
         }
     }
 
-
+    template class BasicSBoardManager<ClassicRules>;
+    template class BasicSBoardManager<DiagonalRules>;
+    template class BasicSBoardManager<AntiKnightRules>;
+    template class BasicSBoardManager<JigsawRules>;
+    template class BasicSBoardManager<KillerRules>;
 }
@@ -4,7 +4,15 @@
 using std::vector;
 #include <string>
 using std::string;
+#include <stdexcept>
+#include <memory>
+#include <utility>
+#include <cstdint>
 #include "config.h"
+#include "../lib/expected.h"
+#include "board_pool.h"
+#include "difficulty.h"
+#include "variant_rules.h"
 
 /*!
  *  In this header file we have two classes: SBoard and SudokuPlayerBoard.
@@ -22,6 +30,8 @@ using std::string;
 
 namespace sdkg {
 
+    class SolutionCache;
+
     /// This class stores values for a 9x9 Sudoku board.
     class SBoard {
         private:
@@ -49,14 +59,26 @@ namespace sdkg {
      *  Note that the player's moves are always stored, when it is applied to a location that does
      *  not contain an original value.
      *  This is important so we can color the number accordingly when we display the board.
+     *
+     *  Boards are read, validated, solved and played under the `Rules` given at construction (see
+     *  variant_rules.h); `SBoardManager` is the classic instance, which keeps the vectorized BatchValidator.
      */
 
-    class SBoardManager {
+    template < typename Rules >
+    class BasicSBoardManager {
         private:
+            Rules m_rules;                     //!< Rules boards are validated and plays are checked against.
             SBoard m_player_board;             //!< The Sudoku matrix where the user moves are stored.
             SBoard m_solution;                 //!< The Sudoku matrix with the solution.
-            vector<SBoard> m_boards_read;      //!< Container with the valid boards read from input file
-            short m_num_invalid_boards_read = 0;
+            std::shared_ptr<BoardPool> m_boards_read;     //!< Valid boards read from input file, packed (shared, see share_boards)
+            size_t m_num_invalid_boards_read = 0;
+            size_t m_num_non_unique_boards_read = 0;      //!< Valid boards whose clues admit 2+ solutions.
+            bool m_check_uniqueness = false;              //!< Flag that tells the reader to count non-unique boards.
+            std::shared_ptr<SolutionCache> m_solutions;   //!< Solutions of clue-only boards, derived on demand.
+            int m_pending_solution_idx = -1;              //!< Board whose solution was not derived yet, or -1.
+            bool m_solvable = true;                       //!< False if the current board's clues admit no solution.
+            std::shared_ptr<const DifficultyBuckets> m_difficulty;  //!< Boards read by difficulty level, rated as read.
+            short m_loc_counts[5]{ Config::SB_SIZE * Config::SB_SIZE };  //!< Player's board locations by loc_type_e.
 
         public:
             /// Possible types associated with a location on the board during a match.
@@ -76,62 +98,202 @@ namespace sdkg {
                 PRE_INVALID = 30    //!< User has entered an invalid value.
             };
 
+            /// Why a board operation or the parsing of player input failed (see the try_ methods).
+            enum class error_e : short {
+                DIGIT_OUT_OF_RANGE = 1,     //!< A digit, line or column outside [1, 9].
+                NOT_A_NUMBER,               //!< A token that is not a whole number.
+                MISSING_ARGUMENT,           //!< A command with fewer arguments than it needs.
+                BAD_BOARD_INDEX             //!< No valid board was read at the index.
+            };
+
+            /// What reading one input file gave, see read_input_files.
+            struct FileStats {
+                string path;
+                size_t valid = 0;           //!< Valid boards read, in the pool from `first` on.
+                size_t first = 0;           //!< Index of its first board in the pool.
+                size_t invalid = 0;         //!< Malformed boards and boards that break the rules.
+                size_t non_unique = 0;      //!< Valid boards with more than one solution (needs set_uniqueness_check).
+                uintmax_t bytes = 0;        //!< File size.
+                double seconds = 0;         //!< Time its loader thread took to read, validate and rate it.
+                string error;               //!< Why the file could not be read, empty if it was.
+            };
+
+            /// A value, or the error that prevented it: bad input is returned, not thrown.
+            template <typename T>
+            using result_t = Expected<T, error_e>;
+
         private:
-            // Verifies if board is a valid sudoku board
-            static bool is_valid( const SBoard sb );
+            std::shared_ptr<const vector<FileStats>> m_input_files;   //!< Files the boards were read from, in order (shared).
+
+            // Verifies if board is a solved sudoku board under the rules
+            bool is_valid( const SBoard &sb ) const;
 
-            // add sudoku board to boards read
-            inline void add_board( const SBoard sb ) { m_boards_read.push_back(sb); }
+            // Validates up to 32 boards under the rules, bit `l` set if the l-th is valid: consistent
+            // if `clue_only[l]`, solved otherwise. Classic rules use the vectorized BatchValidator.
+            static uint32_t validate_batch( const SBoard *boards, size_t n, const bool *clue_only, const Rules &rules );
+
+            // Solution cache solving clue-only boards under the rules
+            std::shared_ptr<SolutionCache> make_solution_cache() const;
 
             static short encode_value( prefix_e command_status, short value );
 
+            static std::pair<loc_type_e, short> decode( short player_board_loc );
+
+            // Writes a location of the player's board, keeping the location counts up to date.
+            inline void set_player_loc( short line, short column, short code ) {
+                m_loc_counts[decode(m_player_board.at(line, column)).first]--;
+                m_player_board.set_loc(line, column, code);
+                m_loc_counts[decode(code).first]++;
+            }
+
+            // Player and solution boards of a board that carries its solution.
+            void set_player_board( BoardView board_chosen );
+            void set_solution_board( BoardView board_chosen );
+
+            // Validates boards as read from a file and adds the valid ones to `pool`, returns # of invalid
+            static size_t ingest_boards( const SBoard *boards_original, size_t n, BoardPool &pool, const Rules &rules );
+
+            // Reads one input file into its own pool and rates its boards, never throwing: failures go to stats.error.
+            // An archive is decoded by `archive_threads` threads (0 = one per core).
+            static void read_one_file( FileStats &stats, BoardPool &pool, DifficultyBuckets &difficulty, bool check_uniqueness,
+                                       const Rules &rules, unsigned archive_threads );
+
+            // Counts the solutions of a board's clues, up to `limit` (0 = all)
+            static size_t count_clue_solutions( BoardView board, size_t limit, unsigned threads, const Rules &rules );
+
+
         public:
             //=== Regular methods.
-            SBoardManager() = default;
-            ~SBoardManager() = default;
-            SBoardManager & operator=( const SBoardManager & ) = delete;
-            SBoardManager( const SBoardManager & ) = delete;
+            explicit BasicSBoardManager( const Rules &rules=Rules() );
+            ~BasicSBoardManager();
+            BasicSBoardManager & operator=( const BasicSBoardManager & ) = delete;
+            BasicSBoardManager( const BasicSBoardManager & ) = delete;
 
             //=== Access methods.
 
             //=== Modifiers methods.
 
 
-            // Reads input txt file and allocate boards data
+            // Reads input txt file (or puzzle archive) and allocate boards data; malformed boards count as invalid.
+            // Throws std::runtime_error if the file cannot be read at all (missing file, corrupt archive).
             void read_input_file( const string & path_to_file );
 
+            // Reads many input files (txt or archives) at once, one loader task per file on `threads` threads
+            // (0 = one per core), into a single pool: the boards of the first file, then of the second...
+            // whatever the order the loads end in. Files that cannot be read are skipped, see FileStats::error.
+            // Returns the stats of every file, in the order given (also kept, see get_input_files).
+            const vector<FileStats> & read_input_files( const vector<string> & paths_to_files, unsigned threads=0 );
+
+            // Uses the boards (and solutions) another manager read, instead of reading a file: many
+            // matches over the same puzzles share a single copy. The boards must not be read again meanwhile.
+            void share_boards( const BasicSBoardManager &other );
+
+            // Makes read_input_file count the boards whose clues have more than one solution
+            inline void set_uniqueness_check( bool check ) { m_check_uniqueness = check; }
+
+            // Counts the solutions of a board's clues, up to `limit` (0 = all), see SolutionEnumerator (classic rules)
+            size_t count_solutions( int board_idx, size_t limit, unsigned threads=0 ) const;
+
+            // Writes the valid boards read in the text format
+            void write_input_file( const string & path_to_file ) const;
+
+            // Writes the valid boards read as a puzzle archive, see BoardArchive
+            void write_archive( const string & path_to_file, bool keep_solutions=true ) const;
+
             // Tells if number is on a valid range for sudoku, which is [1, 9]
             inline bool is_valid_sudoku_digit(const short &digit) {
-                bool is_valid = digit <= Config::SUDOKU_BIGGEST_NUM and digit>= Config::SUDOKU_SMALLEST_NUM;
-                if (not is_valid) throw std::invalid_argument("Sudoku digit must be in range [1, 9]!");
-                else return is_valid;
+                result_t<short> checked = check_sudoku_digit(digit);
+                if (not checked) throw std::invalid_argument(error_message(checked.error()));
+                else return true;
+            }
+
+            // Gives back a digit in the valid range for sudoku, [1, 9], or DIGIT_OUT_OF_RANGE
+            static inline result_t<short> check_sudoku_digit( short digit ) noexcept {
+                if (digit > Config::SUDOKU_BIGGEST_NUM or digit < Config::SUDOKU_SMALLEST_NUM) {
+                    return unexpected(error_e::DIGIT_OUT_OF_RANGE);
+                }
+                return digit;
             }
 
-            // Verifies if placing a digit on a sudoku place is correct, invalid or incorrect
+            // Reads a digit (or a line, a column) typed by the player: NOT_A_NUMBER, DIGIT_OUT_OF_RANGE
+            static result_t<short> parse_sudoku_digit( const string &token ) noexcept;
+
+            // Text shown to the player for an error
+            static const char * error_message( error_e error ) noexcept;
+
+            // Verifies if placing a digit on a sudoku place is correct, invalid (breaks the rules) or incorrect
             loc_type_e get_placing_status(short line, short column, short digit);
 
             // Gets number of valid boards read
-            inline size_t get_num_valid_boards() const { return m_boards_read.size(); }
+            inline size_t get_num_valid_boards() const { return m_boards_read->size(); }
+
+            // Valid boards read, as views into the packed pool (no copies)
+            inline const BoardPool & get_boards() const { return *m_boards_read; }
+
+            // Indices of the valid boards read, by difficulty level
+            inline const DifficultyBuckets & get_difficulty() const { return *m_difficulty; }
             
+            // Files the boards were read from, in the order given to read_input_files
+            inline const vector<FileStats> & get_input_files() const { return *m_input_files; }
+
             // Gets number of valid boards read
-        	inline short get_num_invalid_boards_read() const { return this -> m_num_invalid_boards_read; }
+        	inline size_t get_num_invalid_boards_read() const { return this -> m_num_invalid_boards_read; }
+
+            // Gets number of valid boards with more than one solution (needs set_uniqueness_check)
+            inline size_t get_num_non_unique_boards_read() const { return m_num_non_unique_boards_read; }
 
             // Gets which digits are available to place on the player's board
             vector<short> get_digits_left_to_place() const;
 
-            // Set player board hiding playable locations
+            // Set player board hiding playable locations; throws std::runtime_error for a bad index
             void set_player_board( const int &board_idx );
+            result_t<void> try_set_player_board( int board_idx ) noexcept;
 
             void place_digit_on_board( prefix_e code, short line, short column, short digit );
 
-            // Set solution board
+            // Set solution board, clue-only boards have their solution derived on the first placement check;
+            // throws std::invalid_argument for a bad index
             void set_solution_board( const int &board_idx );
+            result_t<void> try_set_solution_board( int board_idx ) noexcept;
+
+            // Makes a board that carries its solution the player's, e.g. a generated one (see PuzzleFeed).
+            // Throws std::invalid_argument if the board has blanks.
+            void play_board( BoardView board );
+
+            // Derives the solution of the current clue-only board, if still pending.
+            // Returns false if the current board has no solution.
+            bool derive_solution();
 
-            inline SBoard get_player_board() { return this -> m_player_board; }
+            // Solves ahead, in the background, the clue-only boards among the `count` boards from `first_idx` on
+            void prefetch_solutions( int first_idx, int count );
+
+            inline const SBoard & get_player_board() const { return this -> m_player_board; }
 
             std::pair<loc_type_e, short> decode_player_board_loc(short line, short column ) const;
 
+            // Raw (encoded) value of a player's board location, and its restore, so a play can be undone exactly
+            inline short get_player_board_code( short line, short column ) const { return m_player_board.at(line, column); }
+            inline void set_player_board_code( short line, short column, short code ) { set_player_loc(line, column, code); }
+
+            // # of locations of the player's board of a type, kept as they change: O(1)
+            inline short count_locs( loc_type_e type ) const { return m_loc_counts[type]; }
+
+            // Tells if the player's board has no empty location left
+            inline bool is_filled() const { return m_loc_counts[EMPTY] == 0; }
+
+            // Tells if the player's board holds an incorrect or invalid digit
+            inline bool has_mistakes() const { return m_loc_counts[INCORRECT] + m_loc_counts[INVALID] != 0; }
+
+            inline const Rules & rules() const { return m_rules; }
     };
+
+    typedef BasicSBoardManager<ClassicRules> SBoardManager;
+
+    extern template class BasicSBoardManager<ClassicRules>;
+    extern template class BasicSBoardManager<DiagonalRules>;
+    extern template class BasicSBoardManager<AntiKnightRules>;
+    extern template class BasicSBoardManager<JigsawRules>;
+    extern template class BasicSBoardManager<KillerRules>;
 }
 
 #endif
@@ -1,9 +1,16 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
 #include <iterator>
+#include <string_view>
+#include <thread>
 
 #include "sudoku_gm.h"
+#include "board_geometry.h"
 #include "../lib/contains.h"
 #include "../utils/split.h"
 #include "../utils/is_numeric.h"
+#include "../utils/expand_paths.h"
 
 
 namespace sdkg {
@@ -18,32 +25,120 @@ namespace sdkg {
     /// Default constructor
     SudokuGame::SudokuGame(){
         m_opt.total_checks = 3; // Default value.
-        m_opt.input_filename = "../data/input.txt"; // Default value.
+        m_opt.check_uniqueness = false; // Default value.
+        m_opt.metrics_port = 0; // Default value.
+        m_opt.difficulty = -1; // Default value.
+        m_opt.generators = 0; // Default value.
+        m_opt.load_threads = 0; // Default value.
     }
 
     void SudokuGame::usage() {
         std::cout << "sudoku";
 
-        std::cout << "Usage: sudoku [-c <num>] [--help] <input_puzzle_file>\n"
+        std::cout << "Usage: sudoku [-c <num>] [-u] [-d <level>] [-g <threads>] [-t <threads>] [--metrics-file <path>]\n"
+                  << "              [--metrics-port <port>] [--record <path>] [--help] <input_puzzle_file>...\n"
+                  << "  Puzzle files: files, directories (every file under them) and glob patterns (quoted),\n"
+                  << "  read in parallel, their boards played in the order given. Default = ../data/input.txt.\n"
                   << "  Game options:\n"
                   << "    -c     <num> Number of checks per game. Default = 3.\n"
+                  << "    -u           Report puzzles that have more than one solution.\n"
+                  << "    -d   <level> Only serve puzzles of a level: easy, medium, hard or expert.\n"
+                  << "    -g <threads> Serve new puzzles, variants of the file ones generated in the background.\n"
+                  << "    -t <threads> Threads reading the puzzle files. Default = # of cores.\n"
+                  << "    --metrics-file <path> Write metrics, in the Prometheus text format, after every match.\n"
+                  << "    --metrics-port <port> Serve the metrics at http://127.0.0.1:<port>/metrics.\n"
+                  << "    --record <path> Record the session to a log that sudoku_replay plays back.\n"
                   << "    --help       Print this help text.\n";
         std::cout << std::endl;
 
         exit( EXIT_SUCCESS );
     }
 
+    bool SudokuGame::needs_input(Player::prompt_e &prompt) const {
+        if ( m_game_state == game_state_e::STARTING or
+             m_game_state == game_state_e::HELPING  or
+             m_game_state == game_state_e::CHECKING_MOVES) {
+            prompt = Player::prompt_e::CONTINUE;
+        } else if ( m_game_state == game_state_e::READING_MAIN_OPT ) {
+            prompt = Player::prompt_e::MAIN_MENU;
+        } else if ( m_game_state == game_state_e::PLAYING_MODE ) {
+            prompt = Player::prompt_e::COMMAND;
+        } else if ( m_game_state == game_state_e::CONFIRMING_QUITTING_MATCH ) {
+            prompt = Player::prompt_e::CONFIRM;
+        } else if ( m_game_state == game_state_e::FINISHED_PUZZLE ) {
+            prompt = Player::prompt_e::MATCH_OVER;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool SudokuGame::input_ready(Player::prompt_e prompt) {
+        if (m_player != nullptr) return true;
+        if (prompt == Player::prompt_e::CONFIRM) {
+            // a confirmation waits for a non-blank answer
+            string blank;
+            while (m_commands.front() != nullptr and m_commands.front()->find_first_not_of(" \t\r") == string::npos) {
+                m_commands.try_pop(blank);
+            }
+        }
+        return not m_commands.empty();
+    }
+
+    bool SudokuGame::post_command( string &&line ) {
+        if (not m_commands.try_push(std::move(line))) return false;
+        // Taking the lock orders the push before idle's check, so its wait cannot miss this wake up.
+        { std::lock_guard<std::mutex> lock(m_input_mutex); }
+        m_input_arrived.notify_one();
+        return true;
+    }
+
+    void SudokuGame::close_input() {
+        m_input_closed = true;
+        { std::lock_guard<std::mutex> lock(m_input_mutex); }
+        m_input_arrived.notify_one();
+    }
+
+    void SudokuGame::idle() {
+        if (not m_waiting_input) return;
+        // Input comes through read(2) now, so cin's tie no longer flushes the prompt: it must be out before waiting.
+        m_out->flush();
+        std::unique_lock<std::mutex> lock(m_input_mutex);
+        m_input_arrived.wait(lock, [this]{ return has_input(); });
+    }
+
     void SudokuGame::process_events(){
+        Player::prompt_e prompt;
+        bool reads_line = needs_input(prompt);
+        if (reads_line and m_command_pending) {
+            // the last command was handled and its outcome rendered
+            Metrics::observe(Metrics::COMMAND_LATENCY, std::chrono::steady_clock::now() - m_command_start);
+            m_command_pending = false;
+        }
+        m_waiting_input = reads_line and not input_ready(prompt);
+        if (m_waiting_input) {
+            // all the input was handled and no more will come: nothing left to do
+            if (m_input_closed and m_commands.empty()) {
+                m_game_is_over = true;
+                m_waiting_input = false;
+                finish_session_log();
+            }
+            return;
+        }
         m_curr_msg.clear();
         if ( m_game_state == game_state_e::STARTING or
              m_game_state == game_state_e::HELPING  or
              m_game_state == game_state_e::CHECKING_MOVES) {
             // Reading a simple enter from user.
             std::string line;
-            std::getline(std::cin, line);
+            read_line(Player::prompt_e::CONTINUE, line);
         } else if ( m_game_state == game_state_e::READING_MAIN_OPT ) {
             read_main_menu_opt();
         } else if ( m_game_state == game_state_e::PLAYING_MODE ) {
+            if (not m_match_started) {
+                Metrics::add(Metrics::MATCHES_STARTED);
+                m_match_start = std::chrono::steady_clock::now();
+            }
             m_match_started = true;
             read_command();
         } else if ( m_game_state == game_state_e::REQUESTING_NEW_GAME ) {
@@ -51,7 +146,11 @@ namespace sdkg {
         } else if ( m_game_state == game_state_e::CONFIRMING_QUITTING_MATCH ){
             read_confirm_quitting_match();
         } else if (m_game_state == game_state_e::QUITTING) {
+            // set here, not in update: update does nothing once the game is over
+            m_curr_msg = "Bye bye! Come back soon!";
+            export_metrics();
             m_game_is_over = true;
+            finish_session_log();
         } else if ( m_game_state == game_state_e::PLACING_PLAY ) {
             place_play();
         } else if ( m_game_state == game_state_e::REMOVING_PLAY ) {
@@ -64,6 +163,7 @@ namespace sdkg {
     }
 
     void SudokuGame::update(){
+        if (m_waiting_input or m_game_is_over) return;
         if ( m_game_state == game_state_e::STARTING) {
             m_game_state = game_state_e::READING_MAIN_OPT;
         } else if (m_game_state == game_state_e::READING_MAIN_OPT) {
@@ -103,8 +203,6 @@ namespace sdkg {
             }
         } else if (m_game_state == game_state_e::HELPING or m_game_state == game_state_e::FINISHED_PUZZLE) {
             m_game_state = game_state_e::READING_MAIN_OPT;
-        } else if (m_game_state == game_state_e::QUITTING) {
-            m_curr_msg = "Bye bye! Come back soon!";
         } else if (m_game_state == game_state_e::PLAYING_MODE) {
             if (m_curr_command == Command::PLACE) {
                 m_game_state = game_state_e::PLACING_PLAY;
@@ -135,6 +233,8 @@ namespace sdkg {
     }
 
     void SudokuGame::render() const {
+        if (m_waiting_input) return;   // nothing changed since the last render
+        if (not m_out->good()) return;  // a stream without buffer (or a closed pipe): no screen to format
         if ( m_game_state == game_state_e::READING_MAIN_OPT) {
             display_player_board();
             display_message();
@@ -173,58 +273,195 @@ namespace sdkg {
 				    m_opt.total_checks = (short) std::stoi(argv[i]);
 				} else {
 				    string msg = ">>> Invalid total checks value! Assuming default value of 3 checks\n\n";
-				    cout << Color::tcolor(msg, Color::YELLOW);
+				    *m_out << Color::tcolor(msg, Color::YELLOW);
 				    m_opt.total_checks = 3;
 				}
+			} else if (string{argv[i]} == "-u") {
+				m_opt.check_uniqueness = true;
+			} else if (string{argv[i]} == "-d" and i + 1 < argc) {
+				difficulty_e level;
+				if (DifficultyBuckets::parse(argv[++i], level)) {
+				    m_opt.difficulty = (int) level;
+				} else {
+				    string msg = ">>> Invalid difficulty level! Serving puzzles of every level\n\n";
+				    *m_out << Color::tcolor(msg, Color::YELLOW);
+				}
+			} else if (string{argv[i]} == "--metrics-file" and i + 1 < argc) {
+				m_opt.metrics_file = argv[++i];
+			} else if (string{argv[i]} == "--metrics-port" and i + 1 < argc) {
+				if (is_numeric(argv[++i]) and string{argv[i]}.size() <= 5 and std::stoi(argv[i]) > 0 and std::stoi(argv[i]) < 65536) {
+				    m_opt.metrics_port = (uint16_t) std::stoi(argv[i]);
+				} else {
+				    string msg = ">>> Invalid metrics port! Metrics endpoint disabled\n\n";
+				    *m_out << Color::tcolor(msg, Color::YELLOW);
+				}
+			} else if (string{argv[i]} == "-g" and i + 1 < argc) {
+				if (is_numeric(argv[++i]) and string{argv[i]}.size() <= 3) {
+				    m_opt.generators = (unsigned) std::stoi(argv[i]);
+				} else {
+				    string msg = ">>> Invalid # of generator threads! Serving the puzzles of the file\n\n";
+				    *m_out << Color::tcolor(msg, Color::YELLOW);
+				}
+			} else if (string{argv[i]} == "-t" and i + 1 < argc) {
+				if (is_numeric(argv[++i]) and string{argv[i]}.size() <= 3) {
+				    m_opt.load_threads = (unsigned) std::stoi(argv[i]);
+				} else {
+				    string msg = ">>> Invalid # of loader threads! Using one per core\n\n";
+				    *m_out << Color::tcolor(msg, Color::YELLOW);
+				}
+			} else if (string{argv[i]} == "--record" and i + 1 < argc) {
+				m_opt.record_file = argv[++i];
 			} else if (string{argv[i]} == "-h" or string{argv[i]} == "--help") {
 				usage();
 			} else {
-				m_opt.input_filename = argv[i];
+				m_opt.input_filenames.push_back(argv[i]);
 			}
 	    }
-        
+        if (m_opt.input_filenames.empty()) m_opt.input_filenames.push_back("../data/input.txt"); // Default value.
+
     }
 
     void SudokuGame::display_welcome() const {
-        for(int i{0};i<55;i++) { std::cout << "="; } std::cout << std::endl;
-        std::cout << "\t" << "Welcome to the Sudoku Game, v1.0" << std::endl;
-        std::cout << "\t" << "Copyright (C) 2021, Pedro Costa Aragão" << std::endl;
-        for(int i{0};i<55;i++) { std::cout << "="; } std::cout << std::endl;
-        std::cout << std::endl;
+        for(int i{0};i<55;i++) { *m_out << "="; } *m_out << std::endl;
+        *m_out << "\t" << "Welcome to the Sudoku Game, v1.0" << std::endl;
+        *m_out << "\t" << "Copyright (C) 2021, Pedro Costa Aragão" << std::endl;
+        for(int i{0};i<55;i++) { *m_out << "="; } *m_out << std::endl;
+        *m_out << std::endl;
 
         
-		string msg = ">>> Preparing to read input file \"" + m_opt.input_filename + "\"...\n\n";
+		string msg = m_opt.input_filenames.size() == 1
+		             ? ">>> Preparing to read input file \"" + m_opt.input_filenames.front() + "\"...\n\n"
+		             : ">>> Preparing to read " + std::to_string(m_opt.input_filenames.size()) + " input paths...\n\n";
 		msg = Color::tcolor(msg, Color::BRIGHT_GREEN);
-		std::cout << msg;
+		*m_out << msg;
     }
     
     void SudokuGame::display_input_info() const {
     	string msg = ">>> Number of checks per game: " + std::to_string(m_opt.total_checks) + "\n" +
-    				 ">>> Total of valid sudoku boards read: " + std::to_string(sbm.get_num_valid_boards()) + "\n";
-    	std::cout << Color::tcolor(msg, Color::BRIGHT_GREEN);
+    				 ">>> Total of valid sudoku boards read: " + std::to_string(sbm.get_num_valid_boards()) + "\n" +
+    				 ">>> Boards by difficulty:";
+    	for (size_t l{0}; l < DifficultyBuckets::N_LEVELS; l++) {
+    		msg += string{" "} + DifficultyBuckets::name((difficulty_e) l) + " " +
+    		       std::to_string(sbm.get_difficulty().bucket((difficulty_e) l).size());
+    	}
+    	msg += "\n";
+    	*m_out << Color::tcolor(msg, Color::BRIGHT_GREEN);
+    	display_input_files();
     	
     	if (sbm.get_num_invalid_boards_read()) { 
 			msg = ">>> " + std::to_string(sbm.get_num_invalid_boards_read()) + " boards from input file didn't match sudoku rules\n\n";
-			std::cout << Color::tcolor(msg, Color::YELLOW);
+			*m_out << Color::tcolor(msg, Color::YELLOW);
     	
     	}
+    	if (sbm.get_num_non_unique_boards_read()) {
+			msg = ">>> " + std::to_string(sbm.get_num_non_unique_boards_read()) + " boards from input file have more than one solution\n\n";
+			*m_out << Color::tcolor(msg, Color::YELLOW);
+    	}
         display_ask_to_continue();
     }
 
-    void SudokuGame::initialize(int argc, char **argv) {
+    void SudokuGame::display_input_files() const {
+        static constexpr size_t MAX_FILES_LISTED{ 20 };    //!< Beyond that, only the files that failed are listed.
+        const vector<SBoardManager::FileStats> &files = sbm.get_input_files();
+        if (files.size() < 2) return;
+        uintmax_t bytes = 0;
+        size_t failed = 0;
+        for (const SBoardManager::FileStats &file : files) {
+            bytes += file.bytes;
+            if (not file.error.empty()) failed++;
+        }
+        std::ostringstream summary;
+        summary << ">>> Files read: " << files.size() - failed << " of " << files.size() << ", "
+                << bytes / 1024 << " KiB in " << std::fixed << std::setprecision(3) << m_load_seconds << " s\n";
+        *m_out << Color::tcolor(summary.str(), Color::BRIGHT_GREEN);
+        for (const SBoardManager::FileStats &file : files) {
+            if (file.error.empty() and files.size() > MAX_FILES_LISTED) continue;
+            std::ostringstream line;
+            line << ">>>   " << file.path << ": ";
+            if (not file.error.empty()) {
+                line << file.error;
+                *m_out << Color::tcolor(line.str(), Color::YELLOW);
+                continue;
+            }
+            line << file.valid << " valid, " << file.invalid << " invalid boards (" << file.bytes << " bytes, "
+                 << std::fixed << std::setprecision(3) << file.seconds << " s)\n";
+            *m_out << Color::tcolor(line.str(), Color::BRIGHT_GREEN);
+        }
+        *m_out << "\n";
+    }
+
+    bool SudokuGame::initialize(int argc, char **argv, const SudokuGame *loaded) {
         read_cli_options(argc, argv);
         m_checks_left = m_opt.total_checks;
         display_welcome();
-        sbm.read_input_file(m_opt.input_filename);
+        sbm.set_uniqueness_check(m_opt.check_uniqueness);
+        try {
+            if (loaded != nullptr) {
+                sbm.share_boards(loaded->sbm);
+            } else {
+                auto start = std::chrono::steady_clock::now();
+                const vector<SBoardManager::FileStats> &files = sbm.read_input_files(expand_paths(m_opt.input_filenames), m_opt.load_threads);
+                m_load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (files.size() == 1 and not files.front().error.empty()) throw std::runtime_error(files.front().error);
+            }
+            if (sbm.get_num_valid_boards() == 0) {
+                throw std::runtime_error(m_opt.input_filenames.size() == 1 ? "The file has no valid board!\n" : "The files have no valid board!\n");
+            }
+        } catch (const std::exception &e) {
+            std::cerr << Color::tcolor("\n>>> An error occurred while reading the file\n", Color::BRIGHT_RED);
+            std::cerr << Color::tcolor(e.what(), Color::BRIGHT_RED);
+            m_game_is_over = true;
+            return false;
+        }
         display_input_info();
-        sbm.set_player_board(m_curr_board_idx);
-        sbm.set_solution_board(m_curr_board_idx);
+        if (m_opt.difficulty >= 0 and sbm.get_difficulty().bucket((difficulty_e) m_opt.difficulty).empty()) {
+            string msg = string{">>> No "} + DifficultyBuckets::name((difficulty_e) m_opt.difficulty) +
+                         " puzzle in the file! Serving puzzles of every level\n\n";
+            *m_out << Color::tcolor(msg, Color::YELLOW);
+            m_opt.difficulty = -1;
+        }
+        if (size_t skipped = serve_board(m_opt.difficulty >= 0 ? next_board_idx() : 0); skipped > 0) {
+            *m_out << Color::tcolor(">>> Skipped " + std::to_string(skipped) + " board(s) without solution\n\n",
+                                    Color::YELLOW);
+        }
+        if (m_opt.metrics_port != 0) {
+            try {
+                m_metrics_server = std::make_unique<MetricsServer>(m_opt.metrics_port);
+            } catch (const std::exception &e) {
+                *m_out << Color::tcolor(string{">>> "} + e.what() + "\n\n", Color::YELLOW);
+            }
+        }
+        if (not m_opt.record_file.empty()) {
+            SessionLog::Header header;
+            // one path per line, replay reads them the same way
+            for (const string &path : m_opt.input_filenames) {
+                header.input_filename += (header.input_filename.empty() ? "" : "\n") + path;
+            }
+            header.total_checks = (uint16_t) m_opt.total_checks;
+            header.check_uniqueness = m_opt.check_uniqueness;
+            header.difficulty = m_opt.difficulty;
+            header.num_boards = (uint32_t) sbm.get_num_valid_boards();
+            header.start_us = (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+            try {
+                m_session_log = std::make_unique<SessionLog>(m_opt.record_file, header);
+            } catch (const std::exception &e) {
+                *m_out << Color::tcolor(string{">>> "} + e.what() + "\n", Color::YELLOW);
+            }
+        }
+        if (m_opt.generators > 0) {
+            vector<uint32_t> sources;
+            if (m_opt.difficulty >= 0) sources = sbm.get_difficulty().bucket((difficulty_e) m_opt.difficulty);
+            m_feed = std::make_unique<PuzzleFeed>(sbm.get_boards(), std::move(sources), m_opt.generators);
+            set_puzzle_source([this]( ReadyPuzzle &puzzle ) { return m_feed->try_take(puzzle); });
+        }
         m_game_state = game_state_e::STARTING;
+        return true;
     }
 
-    void SudokuGame::print_number_from_player_board(short line, short column) const {
+    size_t SudokuGame::write_number_from_player_board(short line, short column, char *out) const {
         std::pair<SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(line, column);
-        string num = std::to_string(loc.second);
+        char num = (char) ('0' + loc.second);
         Color::value_t color = Color::BRIGHT_CYAN;
 
         if (m_game_state == game_state_e::FINISHED_PUZZLE or m_game_state == game_state_e::CHECKING_MOVES) {
@@ -238,78 +475,63 @@ namespace sdkg {
         if (loc.first == SBoardManager::ORIGINAL) {
             color = Color::BRIGHT_WHITE;
         } else if (loc.first == SBoardManager::EMPTY) {
-            num = " ";
+            num = ' ';
         } else if (loc.first == SBoardManager::INVALID) {
             color = Color::BRIGHT_RED;
         }
 
-        cout << Color::tcolor(num, color);
+        return Color::append(out, std::string_view{ &num, 1 }, color);
     }
 
     void SudokuGame::display_player_board() const {
-        short lin = 0, col = 0;
-
-        cout << Color::tcolor("|--------[MAIN SCREEN]--------|\n", Color::BRIGHT_BLUE);
-        cout << "     ";
-
-        int i{1};
-        while (i < 10) {
-            if (i == m_last_play.col) cout << Color::tcolor("V", Color::BRIGHT_RED);
-            else cout << " ";
-            cout << " ";
-            if (i % 3 == 0) cout << "  ";
-            i++;
-        }
-        cout << "\n";
-        cout << "     1 2 3   4 5 6   7 8 9\n";
-
-        for (int c{0}; c < 3; c++) {
-            // print horizontal line
-            cout << "   ";  // horizontal line indentation
-            for (int i{0}; i <= Config::SB_CHAR_WIDTH; i++) {
-                if ((c == 1 or c == 2) and (i == 0 or i == 24)) cout << "|";
-                else if (i % 8 == 0) cout << "+";
-                else cout << "-";
-            }
-            cout << "\n";
-
-            // print numbers divided by pipes
-            for (int k{0}; k < 3; k++) {
-                if (lin + 1 == m_last_play.row) cout << Color::tcolor(">", Color::BRIGHT_RED);
-                else cout << " ";
-                cout << lin + 1 << " ";     // print line number
-                for (int d{0}; d <= Config::SB_CHAR_WIDTH; d++) {
-                    if (d % 8 == 0) cout << "|";
-                    else if (d % 2 == 0) {
-                        print_number_from_player_board(lin, col);
-                        col++;
-                    }
-                    else if (d % 2 != 0) cout << " ";
-                    if (d == Config::SB_CHAR_WIDTH) {
-                        cout << "\n";
-                        lin++;
-                        col = 0;
-                    }
-                }
-            }
+        // Box borders; the top and bottom ones have corners, the inner ones continue the side walls.
+        static constexpr std::string_view OUTER_BORDER{ "   +-------+-------+-------+\n" };
+        static constexpr std::string_view INNER_BORDER{ "   |-------+-------+-------|\n" };
+        // The plain text is under 1 KiB; at most 81 locations and 2 markers are colored.
+        char text[1024 + (Config::SB_SIZE * Config::SB_SIZE + 3) * Color::MAX_SPAN_OVERHEAD];
+        char *out = text;
+        auto put = [&out]( std::string_view s ) {
+            std::memcpy(out, s.data(), s.size());
+            out += s.size();
+        };
+
+        // the whole board is formatted into one buffer and written at once, without allocating
+        out += Color::append(out, "|--------[MAIN SCREEN]--------|\n", Color::BRIGHT_BLUE);
+        put("     ");
+        for (short col{0}; col < Config::SB_SIZE; col++) {
+            if (col > 0 and GEOMETRY.box_start[col]) put("  ");
+            if (col + 1 == m_last_play.col) out += Color::append(out, "V", Color::BRIGHT_RED);
+            else put(" ");
+            put(" ");
         }
-        cout << "   ";
-        for (int i{0}; i <= 24; i++) {
-            if (i % 8 == 0) cout << "+";
-            else cout << "-";
+        put("  \n");
+        put("     1 2 3   4 5 6   7 8 9\n");
+
+        for (short lin{0}; lin < Config::SB_SIZE; lin++) {
+            if (GEOMETRY.box_start[lin]) put(lin == 0 ? OUTER_BORDER : INNER_BORDER);
+            if (lin + 1 == m_last_play.row) out += Color::append(out, ">", Color::BRIGHT_RED);
+            else put(" ");
+            *out++ = (char) ('1' + lin);     // print line number
+            put(" ");
+            for (short col{0}; col < Config::SB_SIZE; col++) {
+                put(col == 0 ? "| " : GEOMETRY.box_start[col] ? " | " : " ");
+                out += write_number_from_player_board(lin, col, out);
+            }
+            put(" |\n");
         }
-        cout << "\n";
+        put(OUTER_BORDER);
+        m_out->write(text, out - text);
     }
 
     void SudokuGame::display_message() const {
-        cout << Color::tcolor("MSG: [ ", Color::BRIGHT_YELLOW);
-        cout << Color::tcolor(m_curr_msg, Color::BRIGHT_YELLOW);
-        cout << Color::tcolor(" ]\n", Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor("MSG: [ ", Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor(m_curr_msg, Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor(" ]\n", Color::BRIGHT_YELLOW);
     }
 
     void SudokuGame::display_main_menu_opt() const {
-        cout << "1-Play  2-New Game  3-Quit  4-Help" << endl;
-        cout << "Select option [1, 4] > ";
+        *m_out << "1-Play  2-New Game  3-Quit  4-Help" << endl;
+        *m_out << "Select option [1, 4] > ";
     }
 
     bool SudokuGame::game_over() const {
@@ -320,12 +542,12 @@ namespace sdkg {
         short opt_num;
         string line;
         try {
-            std::getline(std::cin, line);
+            read_line(Player::prompt_e::MAIN_MENU, line);
             if (line.empty()) {
                 m_curr_main_menu_opt = main_menu_opt_e::HELP;
                 return;
             }
-            opt_num = (short) std::stoi(line);
+            opt_num = SBoardManager::parse_sudoku_digit(line).value_or(0);
             if (opt_num == 1){
                 m_curr_main_menu_opt = main_menu_opt_e::PLAY;
             } else if (opt_num == 2) {
@@ -345,8 +567,9 @@ namespace sdkg {
     void SudokuGame::read_confirm_quitting_match() {
         string confirm;
         try {
-            getline(std::cin >> std::ws, confirm);
+            read_line(Player::prompt_e::CONFIRM, confirm);
             if (confirm == "y" or confirm == "Y") {
+                if (m_match_started) Metrics::add(Metrics::MATCHES_ABANDONED);
                 m_quitting_match = true;
                 m_match_started = false;
             } else {
@@ -358,30 +581,77 @@ namespace sdkg {
 
     }
 
+    void SudokuGame::set_puzzle_source(puzzle_source_t source) {
+        m_puzzle_source = std::move(source);
+        // the match on screen gets a puzzle from the source too, unless it is under way
+        if (not m_match_started) take_puzzle();
+    }
+
+    bool SudokuGame::take_puzzle() {
+        if (not m_puzzle_source) return false;
+        ReadyPuzzle puzzle;
+        bool fed = m_puzzle_source(puzzle);
+        if (fed) sbm.play_board(puzzle.view());
+        if (m_session_log != nullptr) m_session_log->append_puzzle(fed ? &puzzle : nullptr);
+        return fed;
+    }
+
     void SudokuGame::change_to_new_game() {
-        size_t new_game_idx = m_curr_board_idx + 1;
-        short first_game_idx = 0;
-        if ( new_game_idx > sbm.get_num_valid_boards() - 1 ) {
-            m_curr_board_idx = first_game_idx;
-        } else {
-            m_curr_board_idx++;
-        }
-        sbm.set_player_board(m_curr_board_idx);
-        sbm.set_solution_board(m_curr_board_idx);
+        size_t skipped = take_puzzle() ? 0 : serve_board(next_board_idx());
         m_last_play = Play();
         m_checks_left = m_opt.total_checks;
         m_match_started = false;
         m_finished_match = false;
         undo_log = stack<Play>();
         m_curr_msg = "New game set, good luck!";
+        if (skipped > 0) m_curr_msg = "Skipped " + std::to_string(skipped) + " board(s) without solution. " + m_curr_msg;
+    }
+
+    int SudokuGame::next_board_idx() {
+        if (m_opt.difficulty < 0) {
+            size_t new_game_idx = m_curr_board_idx + 1;
+            return new_game_idx > sbm.get_num_valid_boards() - 1 ? 0 : (int) new_game_idx;
+        }
+        // O(1): the bucket is walked in order, a board comes back only once the whole level was served
+        const vector<uint32_t> &bucket = sbm.get_difficulty().bucket((difficulty_e) m_opt.difficulty);
+        auto board_idx = (int) bucket[m_bucket_pos];
+        m_bucket_pos = (m_bucket_pos + 1) % bucket.size();
+        return board_idx;
+    }
+
+    size_t SudokuGame::serve_board(int board_idx) {
+        // the board's solution was usually prefetched while the previous one was played; a board that turns out
+        // unsolvable could never be won, so the next one is served instead (at most one pass over the boards)
+        size_t skipped{0};
+        load_board(board_idx);
+        while (not sbm.derive_solution() and skipped + 1 < sbm.get_num_valid_boards()) {
+            skipped++;
+            load_board(next_board_idx());
+        }
+        return skipped;
+    }
+
+    void SudokuGame::load_board(int board_idx) {
+        m_curr_board_idx = board_idx;
+        sbm.set_player_board(m_curr_board_idx);
+        sbm.set_solution_board(m_curr_board_idx);
+        if (m_opt.difficulty < 0) {
+            sbm.prefetch_solutions(m_curr_board_idx, Config::SOLVE_AHEAD + 1);
+            return;
+        }
+        const vector<uint32_t> &bucket = sbm.get_difficulty().bucket((difficulty_e) m_opt.difficulty);
+        sbm.prefetch_solutions(m_curr_board_idx, 1);
+        for (size_t k{0}; k < std::min<size_t>(Config::SOLVE_AHEAD, bucket.size()); k++) {
+            sbm.prefetch_solutions((int) bucket[(m_bucket_pos + k) % bucket.size()], 1);
+        }
     }
 
     void SudokuGame::display_confirm_quitting_match() const {
-        cout << "Select an option [ y / N ] > ";
+        *m_out << "Select an option [ y / N ] > ";
     }
 
     void SudokuGame::display_ask_to_continue() const {
-        std::cout << "Press < enter > to continue > ";
+        *m_out << "Press < enter > to continue > ";
     }
 
     void SudokuGame::display_sudoku_help() const {
@@ -393,11 +663,11 @@ namespace sdkg {
                 string{" 1. Each row, column, and nonet can contain each number (typically 1 to 9)\n exactly once.\n"} +
                 string{" 2. The sum of all numbers in any nonet, row, or column must be equal to 45.\n"} +
                 string{"--------------------------------------------------------------------------------\n"};
-        cout << Color::tcolor(msg, Color::BRIGHT_GREEN);
+        *m_out << Color::tcolor(msg, Color::BRIGHT_GREEN);
     }
 
     void SudokuGame::display_checks_left() const {
-        cout << Color::tcolor("Checks left: " + std::to_string(m_checks_left) + "\n", Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor("Checks left: " + std::to_string(m_checks_left) + "\n", Color::BRIGHT_YELLOW);
     }
 
     void SudokuGame::display_command_syntax() const {
@@ -409,26 +679,31 @@ namespace sdkg {
                 string{"  'c' + 'enter'                      -> check wich moves made are correct.\n"} +
                 string{"  'u' + 'enter'                      -> undo last play.\n"} +
                 string{"  <row>, <col>, <number> must be in range [1, 9].\n"};
-        cout << Color::tcolor(msg, Color::BRIGHT_GREEN);
+        *m_out << Color::tcolor(msg, Color::BRIGHT_GREEN);
     }
 
     void SudokuGame::display_ask_for_a_command() const {
-        cout << Color::tcolor("Enter a command > ", Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor("Enter a command > ", Color::BRIGHT_YELLOW);
     }
 
     void SudokuGame::read_command() {
         string command;
         vector<string> tokens;
         try {
-            getline(std::cin, command);
+            read_line(Player::prompt_e::COMMAND, command);
+            m_command_start = std::chrono::steady_clock::now();
+            m_command_pending = true;
             tokens = split(command);
-            std::remove_if(tokens.begin(), tokens.end(), [](string &str) { return str.empty(); });
-            if (tokens.at(0).empty()) {
+            tokens.erase(std::remove_if(tokens.begin(), tokens.end(), [](string &str) { return str.empty(); }), tokens.end());
+            if (tokens.empty()) {
                 m_curr_command = Command::EMPTY;
             } else if (tokens.at(0) == "u") {
+                Metrics::add(Metrics::COMMANDS);
                 m_curr_command = Command::UNDO;
             } else if (tokens.at(0) == "c") {
+                Metrics::add(Metrics::COMMANDS);
                 if (m_checks_left > 0) {
+                    Metrics::add(Metrics::CHECKS);
                     m_curr_command = Command::CHECK;
                     m_checks_left--;
                 }
@@ -437,19 +712,18 @@ namespace sdkg {
                     m_curr_command = Command::INVALID;
                 }
             } else if (tokens.at(0) == "p" or tokens.at(0) == "r") {
-                short r, c, v;
-                bool locs_okay;
+                Metrics::add(Metrics::COMMANDS);
                 m_curr_command = (tokens.at(0) == "p") ? Command::PLACE : Command::REMOVE;
-                r = (short) (std::stoi(tokens.at(1)));
-                c = (short) (std::stoi(tokens.at(2)));
-                if (m_curr_command == Command::PLACE) v = (short) std::stoi(tokens.at(3));
-                else v = 1;
-                locs_okay =
-                        sbm.is_valid_sudoku_digit(r) and
-                        sbm.is_valid_sudoku_digit(c) and
-                        sbm.is_valid_sudoku_digit(v);
-                if (locs_okay) m_last_play = Play(m_curr_command, r, c, v);
+                // bad plays are routine under bots and malformed feeds: they are returned, not thrown
+                SBoardManager::result_t<Play> play = parse_play(m_curr_command, tokens);
+                if (play) {
+                    m_last_play = *play;
+                } else {
+                    m_curr_command = Command::INVALID;
+                    m_curr_msg = SBoardManager::error_message(play.error());
+                }
             } else {
+                Metrics::add(Metrics::COMMANDS);
                 m_curr_command = Command::INVALID;
                 m_curr_msg = "Invalid command!";
             }
@@ -459,15 +733,27 @@ namespace sdkg {
         }
     }
 
+    SBoardManager::result_t<SudokuGame::Play> SudokuGame::parse_play(Command command, const vector<string> &tokens) noexcept {
+        size_t arguments = command == Command::PLACE ? 3 : 2;
+        if (tokens.size() < arguments + 1) return unexpected(SBoardManager::error_e::MISSING_ARGUMENT);
+        short values[3]{ 1, 1, 1 };     // line, column and digit, a removal has no digit
+        for (size_t k{0}; k < arguments; k++) {
+            SBoardManager::result_t<short> value = SBoardManager::parse_sudoku_digit(tokens[k + 1]);
+            if (not value) return unexpected(value.error());
+            values[k] = *value;
+        }
+        return Play(command, values[0], values[1], values[2]);
+    }
+
     void SudokuGame::display_digits_left_to_place() const {
         vector<short> digits_left_to_place = sbm.get_digits_left_to_place();
-        cout << Color::tcolor("Digits left: [ ", Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor("Digits left: [ ", Color::BRIGHT_YELLOW);
         for (int i{1}; i <= 9; i++) {
             if (contains(digits_left_to_place.begin(), digits_left_to_place.end(), i, [](short a, short b) {return a == b;})) {
-                cout << Color::tcolor(std::to_string(i) + " ", Color::BRIGHT_YELLOW);
+                *m_out << Color::tcolor(std::to_string(i) + " ", Color::BRIGHT_YELLOW);
             }
         }
-        cout << Color::tcolor("]\n", Color::BRIGHT_YELLOW);
+        *m_out << Color::tcolor("]\n", Color::BRIGHT_YELLOW);
     }
 
     void SudokuGame::place_play() {
@@ -487,19 +773,29 @@ namespace sdkg {
             } else if (placing_status == SBoardManager::loc_type_e::INCORRECT) {
                 code = SBoardManager::prefix_e::PRE_INCORRECT;
             }
+            m_last_play.previous = sbm.get_player_board_code(p_row, p_col);
             sbm.place_digit_on_board(code, p_row, p_col, m_last_play.value);
-            if (m_game_state != game_state_e::UNDOING_PLAY) undo_log.push(m_last_play);
-            if (is_finished()) {
-                if (is_victory()) {
-                    m_curr_msg = "Congratulations you won!";
-                } else {
-                    m_curr_msg = "Well, you lost... :(";
-                }
-                m_finished_match = true;
-            }
+            undo_log.push(m_last_play);
+            Metrics::add(Metrics::PLACEMENTS);
+            if (code == SBoardManager::prefix_e::PRE_INVALID) Metrics::add(Metrics::INVALID_PLACEMENTS);
+            end_match_if_finished();
         }
     }
 
+    void SudokuGame::end_match_if_finished() {
+        if (not is_finished()) return;
+        if (is_victory()) {
+            m_curr_msg = "Congratulations you won!";
+            Metrics::add(Metrics::MATCHES_WON);
+        } else {
+            m_curr_msg = "Well, you lost... :(";
+            Metrics::add(Metrics::MATCHES_LOST);
+        }
+        Metrics::observe(Metrics::MATCH_DURATION, std::chrono::steady_clock::now() - m_match_start);
+        m_finished_match = true;
+        export_metrics();
+    }
+
     void SudokuGame::remove_play() {
         auto p_row = (short) (m_last_play.row - 1);
         auto p_col = (short) (m_last_play.col - 1);
@@ -511,52 +807,60 @@ namespace sdkg {
         } else {
             m_last_play.value = loc_desired_to_play.second;
             m_last_play.command = Command::REMOVE;
+            m_last_play.previous = sbm.get_player_board_code(p_row, p_col);
             sbm.place_digit_on_board(SBoardManager::prefix_e::PRE_ORIGINAL, p_row, p_col, 0);
-            if (m_game_state != game_state_e::UNDOING_PLAY) undo_log.push(m_last_play);
+            undo_log.push(m_last_play);
+            Metrics::add(Metrics::REMOVALS);
         }
     }
 
     void SudokuGame::undo_play() {
         if (not undo_log.empty()) {
-            m_last_play.row = undo_log.top().row;
-            m_last_play.col = undo_log.top().col;
-            m_last_play.value = undo_log.top().value;
-            if (undo_log.top().command == Command::PLACE) {
-                m_last_play.command = Command::REMOVE;
-                remove_play();
-            } else if (undo_log.top().command == Command::REMOVE) {
-                m_last_play.command = Command::PLACE;
-                place_play();
-            }
+            Metrics::add(Metrics::UNDOS);
+            // the location gets back exactly what it held, a digit overwritten by a placement included
+            m_last_play = undo_log.top();
             undo_log.pop();
+            sbm.set_player_board_code((short) (m_last_play.row - 1), (short) (m_last_play.col - 1), m_last_play.previous);
+            end_match_if_finished();
         } else {
             m_curr_msg = "Nothing to undo!";
         }
     }
 
     bool SudokuGame::is_finished() const {
-        for (short i{0}; i < Config::SB_SIZE; i++) {
-            for (short j{0}; j < Config::SB_SIZE; j++) {
-                if (sbm.decode_player_board_loc(i, j).first == SBoardManager::EMPTY) { return false; }
-            }
-        }
-        return true;
+        return sbm.is_filled();
     }
 
     bool SudokuGame::is_victory() const {
-        for (short i{0}; i < Config::SB_SIZE; i++) {
-            for (short j{0}; j < Config::SB_SIZE; j++) {
-                SBoardManager::loc_type_e loc_code = sbm.decode_player_board_loc(i, j).first;
-                if (loc_code == SBoardManager::INVALID or loc_code == SBoardManager::INCORRECT) { return false; }
-            }
-        }
-        return true;
+        return not sbm.has_mistakes();
     }
 
     void SudokuGame::finish_game() {
-        change_to_new_game();
-        // Reading a simple enter from user.
+        // Reading a simple enter from user, the finished board is still loaded at this point.
         std::string line;
-        std::getline(std::cin, line);
+        read_line(Player::prompt_e::MATCH_OVER, line);
+        change_to_new_game();
+    }
+
+    void SudokuGame::finish_session_log() {
+        if (m_session_log == nullptr) return;
+        m_session_log->finish((uint32_t) m_curr_board_idx, sbm.get_player_board());
+        if (not m_session_log->good()) {
+            *m_out << Color::tcolor(">>> Could not write session log \"" + m_opt.record_file + "\"\n", Color::YELLOW);
+        }
+        m_session_log.reset();
+    }
+
+    void SudokuGame::export_metrics() const {
+        if (m_opt.metrics_file.empty()) return;
+        if (not Metrics::export_file(m_opt.metrics_file)) {
+            *m_out << Color::tcolor(">>> Could not write metrics file \"" + m_opt.metrics_file + "\"\n", Color::YELLOW);
+        }
+    }
+
+    void SudokuGame::read_line(Player::prompt_e prompt, string &line) {
+        if (m_player != nullptr) line = m_player->answer(prompt, sbm);
+        else if (not m_commands.try_pop(line)) line.clear();
+        if (m_session_log != nullptr) m_session_log->append(prompt, line, (uint32_t) m_curr_board_idx, sbm.get_player_board());
     }
 }
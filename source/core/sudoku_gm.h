@@ -25,22 +25,44 @@ using std::accumulate;
 #include <stack>
 using std::stack;
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <chrono>
+#include <functional>
+
 #include "../lib/messages.h"
 #include "../lib/text_color.h"
+#include "../lib/spsc_queue.h"
 #include "sudoku_board.h"
+#include "player.h"
+#include "metrics.h"
+#include "session_log.h"
+#include "puzzle_feed.h"
 
 namespace sdkg {
 
     /// Game class representing a Life Game simulation manager.
     class SudokuGame
     {
+        public:
+            /// Gives the next puzzle to play, or false to play the next board of the file.
+            typedef std::function<bool( ReadyPuzzle & )> puzzle_source_t;
+
         private:
             //=== Structs
 
             /// Internal game options
             struct Options {
-                std::string input_filename; //!< Input cfg file.
+                std::vector<std::string> input_filenames;  //!< Puzzle files, directories and glob patterns, in order.
+                unsigned load_threads;     //!< Threads loading the puzzle files, 0 for one per core.
                 short total_checks;        //!< # of checks user has left.
+                bool check_uniqueness;     //!< Report boards with more than one solution.
+                std::string metrics_file;  //!< Prometheus file refreshed after every match, empty for none.
+                uint16_t metrics_port;     //!< Port of the HTTP metrics endpoint, 0 for none.
+                std::string record_file;   //!< Session log recording every line read, empty for none.
+                int difficulty;            //!< Level boards are served from (see difficulty_e), -1 for every board.
+                unsigned generators;       //!< Threads generating puzzles in the background (PuzzleFeed), 0 for none.
             };
 
             /// Possible games states
@@ -90,6 +112,7 @@ namespace sdkg {
                 short row;    //!< row selected by the user.
                 short col;    //!< col selected by the user.
                 short value;  //!< value to play selected by the user.
+                short previous = 0;  //!< Encoded location before the play (see SBoardManager), restored by undo.
                 /// Constructor.
                 explicit Play( Command cmd=Command::EMPTY, short r=-1, short c=-1, short v=1 ) : command{cmd}, row{r}, col{c}, value{v}{/*empty*/}
             };
@@ -103,14 +126,30 @@ namespace sdkg {
             std::string m_curr_msg;                 //!< Current message to display on screen.
             Command m_curr_command;                 //!< Current user command on playing mode
             Play m_last_play;                       //!< Last user play.
-            bool m_quitting_match;                  //!< Flag that indicates whether the user wants to end an ongoing game.
+            bool m_quitting_match = false;          //!< Flag that indicates whether the user wants to end an ongoing game.
             bool m_game_is_over = false;                    //!< Flag that indicates if user chose to quit game;
             bool m_match_started = false;                   //!< Flag that indicates if match started (at least one play was exec)
-            bool m_finished_match;
+            bool m_finished_match = false;          //!< Flag that indicates the current puzzle was completed.
             int m_checks_left;                    //!< Current # of checks user can request.
-            short m_curr_board_idx = 0;                 //!< Current player board index
+            int m_curr_board_idx = 0;                   //!< Current player board index
+            size_t m_bucket_pos = 0;                    //!< Next board of the difficulty bucket, when serving a level.
             main_menu_opt_e m_curr_main_menu_opt;   //!< Current main menu option.
             stack< Play > undo_log;              //!< Log of commands to support undoing.
+            Player * m_player = nullptr;            //!< Scripted player answering prompts, or nullptr to read the command queue.
+            std::ostream * m_out = &std::cout;      //!< Where the screens and messages go (see set_output).
+            SpscQueue< string, 64 > m_commands;     //!< Input lines waiting to be handled (see post_command).
+            std::atomic<bool> m_input_closed{ false };  //!< Flag that indicates no more input lines will arrive.
+            bool m_waiting_input = false;           //!< Flag that indicates the last process_events had no input to handle.
+            std::mutex m_input_mutex;               //!< Pairs with m_input_arrived, so a post is never missed by idle.
+            std::condition_variable m_input_arrived;    //!< Signaled when a line is posted or the input is closed.
+            bool m_command_pending = false;         //!< Flag that indicates a command is being handled (for its latency).
+            std::chrono::steady_clock::time_point m_command_start;  //!< When the command being handled was read.
+            std::chrono::steady_clock::time_point m_match_start;    //!< When the first command of the match was read.
+            double m_load_seconds = 0;                              //!< Time taken to read the puzzle files.
+            std::unique_ptr< MetricsServer > m_metrics_server;      //!< HTTP metrics endpoint, if requested.
+            std::unique_ptr< SessionLog > m_session_log;            //!< Log of the lines read, if requested.
+            std::unique_ptr< PuzzleFeed > m_feed;                   //!< Puzzles generated for this game, if requested.
+            puzzle_source_t m_puzzle_source;                        //!< Where new matches take their puzzle first, if set.
 
             void read_cli_options( int argc, char ** argv );
 
@@ -120,25 +159,61 @@ namespace sdkg {
 
             void read_command();
 
+            // Reads the line, column (and digit) of a place or remove command, never throwing on bad tokens.
+            static SBoardManager::result_t<Play> parse_play( Command command, const vector<string> &tokens ) noexcept;
+
+            // Reads the answer to a prompt, either from the attached player or from the command queue.
+            void read_line( Player::prompt_e prompt, string &line );
+
+            // Tells if the current state reads a line, and which prompt it answers.
+            bool needs_input( Player::prompt_e &prompt ) const;
+
+            // Tells if a line answering the prompt is available (drops blank lines a confirmation ignores).
+            bool input_ready( Player::prompt_e prompt );
+
             void change_to_new_game();
 
+            // Plays the next puzzle of the puzzle source, if any; false if there is none (the board is unchanged).
+            bool take_puzzle();
+
+            // Index of the board after the current one: the next of the file, or of the difficulty bucket.
+            int next_board_idx();
+
+            // Makes a board the player's, solving the ones that follow ahead.
+            void load_board( int board_idx );
+
+            // Loads a board, moving on past the ones found without solution; returns how many were skipped.
+            size_t serve_board( int board_idx );
+
             bool is_finished() const;
 
             bool is_victory() const;
 
             void finish_game();
 
+            // Records the final state in the session log, if one is being written, and closes it.
+            void finish_session_log();
+
+            // Refreshes the metrics file, if one was requested.
+            void export_metrics() const;
+
             void place_play();
 
             void remove_play();
 
             void undo_play();
 
+            // Ends the match if the board is full, counting a win or a loss.
+            void end_match_if_finished();
+
             void display_welcome() const;
 
             void display_input_info() const;
+            // Lists the files read when there are several; past twenty, only the ones that failed.
+            void display_input_files() const;
 
-            void print_number_from_player_board( short line, short column ) const;
+            // Writes the colored digit of a location into `out`, returns the # of chars written.
+            size_t write_number_from_player_board( short line, short column, char *out ) const;
 
             void display_player_board() const;
 
@@ -165,11 +240,45 @@ namespace sdkg {
                 ~SudokuGame() = default;
 
                 static void usage() ;
-                void initialize( int argc, char** argv );
+                // Returns false (and the game is over) if no board could be loaded from the input file.
+                // With `loaded`, an initialized game, its boards are shared instead of reading the file again.
+                bool initialize( int argc, char** argv, const SudokuGame *loaded=nullptr );
                 void update();
                 void process_events();
                 void render() const;
                 bool game_over() const;
+                /// Makes new matches take their puzzle from `source` first, e.g. a PuzzleFeed shared by many games.
+                void set_puzzle_source( puzzle_source_t source );
+
+                /// Attaches a scripted player that answers every prompt instead of the command queue.
+                inline void set_player( Player *player ) { m_player = player; }
+
+                /// Makes the game write to `out` instead of cout, e.g. a stream without buffer to discard the output.
+                /// Games on different threads need streams of their own: a stream is not thread-safe.
+                inline void set_output( std::ostream &out ) { m_out = &out; }
+
+                /// Queues an input line, called from the (single) input thread. Returns false if the queue is full.
+                bool post_command( string &&line );
+
+                /// Tells the game no more input lines will be posted; it quits once the queued ones are handled.
+                void close_input();
+
+                /// Tells if the game is blocked until an input line is posted.
+                inline bool is_waiting_input() const { return m_waiting_input; }
+
+                /// Tells the prompt the game is blocked on, false if it is not waiting input.
+                inline bool pending_prompt( Player::prompt_e &prompt ) const { return m_waiting_input and needs_input(prompt); }
+
+                /// Tells if a posted line, or the end of the input, is waiting to be handled (game thread side).
+                inline bool has_input() const { return not m_commands.empty() or m_input_closed; }
+
+                inline const SBoardManager & board_manager() const { return sbm; }
+
+                /// Index of the board being played, among the valid boards read.
+                inline int board_index() const { return m_curr_board_idx; }
+
+                /// Background work done while the player thinks, then blocks until a line is posted or the input closed.
+                void idle();
 
     }; // SudokuGame class.
 }
@@ -0,0 +1,182 @@
+#include "sudoku_solver.h"
+
+namespace sdkg {
+
+    template < typename Rules >
+    BasicSudokuSolver<Rules>::BasicSudokuSolver(const SBoard &puzzle, const Rules &rules) : m_rules{rules}, m_extra{m_rules} {
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                short digit = puzzle.at(i, j);
+                if (digit < Config::SUDOKU_SMALLEST_NUM) continue;
+                auto bit = (mask_t) (1u << digit);
+                short cell = BoardGeometry::cell_of(i, j);
+                if (digit > Config::SUDOKU_BIGGEST_NUM or
+                    (m_rows[i] | m_cols[j] | m_boxes[m_rules.region(cell)]) & bit or
+                    not (m_extra.allowed(m_rules, m_cells, cell) & bit)) {
+                    m_consistent = false;
+                    continue;
+                }
+                set_cell(cell, digit);
+            }
+        }
+    }
+
+    template < typename Rules >
+    void BasicSudokuSolver<Rules>::set_cell(short cell, short digit) {
+        auto bit = (mask_t) (1u << digit);
+        m_cells[cell] = digit;
+        m_rows[GEOMETRY.line[cell]] |= bit;
+        m_cols[GEOMETRY.column[cell]] |= bit;
+        m_boxes[m_rules.region(cell)] |= bit;
+        m_extra.place(m_rules, cell, digit);
+    }
+
+    template < typename Rules >
+    void BasicSudokuSolver<Rules>::clear_cell(short cell) {
+        short digit = m_cells[cell];
+        auto bit = (mask_t) ~(1u << digit);
+        m_cells[cell] = 0;
+        m_extra.clear(m_rules, cell, digit);
+        m_rows[GEOMETRY.line[cell]] &= bit;
+        m_cols[GEOMETRY.column[cell]] &= bit;
+        m_boxes[m_rules.region(cell)] &= bit;
+    }
+
+    template < typename Rules >
+    typename BasicSudokuSolver<Rules>::mask_t BasicSudokuSolver<Rules>::candidates(short line, short column) const {
+        short cell = BoardGeometry::cell_of(line, column);
+        if (m_cells[cell] != 0) return 0;
+        return (mask_t) (ALL_DIGITS & m_extra.allowed(m_rules, m_cells, cell) & ~(m_rows[line] | m_cols[column] | m_boxes[m_rules.region(cell)]));
+    }
+
+    template < typename Rules >
+    short BasicSudokuSolver<Rules>::pick_cell(mask_t &candidates) const {
+        short best = -1;
+        int best_count = Config::SB_SIZE + 1;
+        for (short cell{0}; cell < N_CELLS; cell++) {
+            if (m_cells[cell] != 0) continue;
+            auto cand = (mask_t) (ALL_DIGITS & ~(m_rows[GEOMETRY.line[cell]] | m_cols[GEOMETRY.column[cell]] | m_boxes[m_rules.region(cell)]));
+            cand &= m_extra.allowed(m_rules, m_cells, cell);
+            int count = __builtin_popcount(cand);
+            if (count < best_count) {
+                best = cell;
+                best_count = count;
+                candidates = cand;
+                if (count <= 1) break;  // either a dead end or a forced move, no need to look further
+            }
+        }
+        return best;
+    }
+
+    template < typename Rules >
+    bool BasicSudokuSolver<Rules>::search_first() {
+        m_stats.nodes++;
+        mask_t cand = 0;
+        short cell = pick_cell(cand);
+        if (cell < 0) return true;
+        if (__builtin_popcount(cand) > 1 and ++m_stats.guesses > m_guess_limit) return false;
+        while (cand) {
+            auto digit = (short) __builtin_ctz(cand);
+            cand &= (mask_t) (cand - 1);
+            set_cell(cell, digit);
+            if (search_first()) return true;
+            if (m_stats.guesses > m_guess_limit) return false;
+            clear_cell(cell);
+        }
+        return false;
+    }
+
+    template < typename Rules >
+    size_t BasicSudokuSolver<Rules>::search_count(size_t limit) {
+        m_stats.nodes++;
+        mask_t cand = 0;
+        short cell = pick_cell(cand);
+        if (cell < 0) return 1;
+        if (__builtin_popcount(cand) > 1) m_stats.guesses++;
+        size_t found = 0;
+        while (cand and found < limit) {
+            auto digit = (short) __builtin_ctz(cand);
+            cand &= (mask_t) (cand - 1);
+            set_cell(cell, digit);
+            found += search_count(limit - found);
+            clear_cell(cell);
+        }
+        return found;
+    }
+
+    template < typename Rules >
+    bool BasicSudokuSolver<Rules>::search_all(const visitor_t &visit, const std::atomic<bool> *stop) {
+        m_stats.nodes++;
+        if (stop != nullptr and stop->load(std::memory_order_relaxed)) return false;
+        mask_t cand = 0;
+        short cell = pick_cell(cand);
+        if (cell < 0) return visit(*this);
+        if (__builtin_popcount(cand) > 1) m_stats.guesses++;
+        while (cand) {
+            auto digit = (short) __builtin_ctz(cand);
+            cand &= (mask_t) (cand - 1);
+            set_cell(cell, digit);
+            bool go_on = search_all(visit, stop);
+            clear_cell(cell);
+            if (not go_on) return false;
+        }
+        return true;
+    }
+
+    template < typename Rules >
+    void BasicSudokuSolver<Rules>::to_board(SBoard &sb) const {
+        for (short i{0}; i < Config::SB_SIZE; i++) {
+            for (short j{0}; j < Config::SB_SIZE; j++) {
+                sb.set_loc(i, j, m_cells[i * Config::SB_SIZE + j]);
+            }
+        }
+    }
+
+    template < typename Rules >
+    bool BasicSudokuSolver<Rules>::solve(SBoard &solution) {
+        m_stats = Stats();
+        if (not m_consistent or not search_first()) return false;
+        to_board(solution);
+        return true;
+    }
+
+    template < typename Rules >
+    bool BasicSudokuSolver<Rules>::for_each_solution(const visitor_t &visit, const std::atomic<bool> *stop) {
+        m_stats = Stats();
+        if (not m_consistent) return true;
+        return search_all(visit, stop);
+    }
+
+    template < typename Rules >
+    void BasicSudokuSolver<Rules>::split(short depth, std::vector<BasicSudokuSolver> &subtrees) const {
+        if (not m_consistent) return;
+        mask_t cand = 0;
+        short cell = pick_cell(cand);
+        if (depth <= 0 or cell < 0) {
+            subtrees.push_back(*this);
+            return;
+        }
+        // forced moves do not count as a level, they would only produce a single subtree
+        auto child_depth = (short) (__builtin_popcount(cand) > 1 ? depth - 1 : depth);
+        while (cand) {
+            auto digit = (short) __builtin_ctz(cand);
+            cand &= (mask_t) (cand - 1);
+            BasicSudokuSolver child{ *this };
+            child.set_cell(cell, digit);
+            child.split(child_depth, subtrees);
+        }
+    }
+
+    template < typename Rules >
+    size_t BasicSudokuSolver<Rules>::count_solutions(size_t limit) {
+        m_stats = Stats();
+        if (not m_consistent or limit == 0) return 0;
+        return search_count(limit);
+    }
+
+    template class BasicSudokuSolver<ClassicRules>;
+    template class BasicSudokuSolver<DiagonalRules>;
+    template class BasicSudokuSolver<AntiKnightRules>;
+    template class BasicSudokuSolver<JigsawRules>;
+    template class BasicSudokuSolver<KillerRules>;
+}
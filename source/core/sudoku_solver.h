@@ -0,0 +1,105 @@
+#ifndef SUDOKU_SOLVER_H
+#define SUDOKU_SOLVER_H
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "config.h"
+#include "sudoku_board.h"
+#include "board_geometry.h"
+#include "variant_rules.h"
+
+/*!
+ *  Exact backtracking solver for the 9x9 Sudoku board, classic or variant
+ *  (see variant_rules.h): `SudokuSolver` is the classic instance.
+ *
+ *  The solver keeps one bit mask of used digits per row, column and box,
+ *  so testing whether a digit fits a location is a couple of bitwise
+ *  operations. The search always branches on the empty location with the
+ *  fewest candidates (minimum remaining values).
+ *
+ *  Positive values of the input board are taken as givens, any value `<= 0`
+ *  (empty or hidden location) is a location the solver has to fill.
+ */
+
+namespace sdkg {
+
+    template < typename Rules >
+    class BasicSudokuSolver {
+        public:
+            /// Counters describing how much work the last search did.
+            struct Stats {
+                size_t nodes = 0;      //!< # of search nodes visited.
+                size_t guesses = 0;    //!< # of times the search had to pick among 2+ candidates.
+            };
+
+            typedef uint16_t mask_t;    //!< Bit `d` set means digit `d` is used/allowed.
+
+            /// Called with the solver holding a solution, returns false to stop the search.
+            typedef std::function<bool( const BasicSudokuSolver & )> visitor_t;
+
+        private:
+            static constexpr short N_CELLS{ BoardGeometry::N_CELLS };
+            static constexpr mask_t ALL_DIGITS{ 0x3FE };    //!< Bits 1 to 9 set.
+
+            short m_cells[N_CELLS]{};                 //!< Current values, 0 means empty.
+            mask_t m_rows[Config::SB_SIZE]{};         //!< Digits used per row.
+            mask_t m_cols[Config::SB_SIZE]{};         //!< Digits used per column.
+            mask_t m_boxes[Config::SB_SIZE]{};        //!< Digits used per box (region of the rules).
+            Rules m_rules;
+            typename Rules::State m_extra;            //!< What the rules track beyond rows, columns and regions.
+            bool m_consistent = true;                 //!< False if the givens already break the rules.
+            size_t m_guess_limit = SIZE_MAX;          //!< `solve` gives up past this many guesses.
+            Stats m_stats;
+
+            void set_cell( short cell, short digit );
+            void clear_cell( short cell );
+
+            // Returns the empty cell with fewest candidates, or -1 if the board is full.
+            short pick_cell( mask_t &candidates ) const;
+
+            bool search_first();
+            size_t search_count( size_t limit );
+            bool search_all( const visitor_t &visit, const std::atomic<bool> *stop );
+
+        public:
+            explicit BasicSudokuSolver( const SBoard &puzzle, const Rules &rules=Rules() );
+
+            // Finds a solution, returns false if there is none (or the guess limit was hit).
+            bool solve( SBoard &solution );
+
+            // Makes `solve` give up once it guessed more than `limit` times, e.g. to rate a board cheaply.
+            inline void set_guess_limit( size_t limit ) { m_guess_limit = limit; }
+
+            // Counts solutions, stopping as soon as `limit` solutions were found.
+            size_t count_solutions( size_t limit );
+
+            // Calls `visit` for every solution; stops early (returning false) when it returns false or `*stop` is set.
+            bool for_each_solution( const visitor_t &visit, const std::atomic<bool> *stop=nullptr );
+
+            // Expands the first `depth` branching levels of the search, appending one solver per open subtree.
+            void split( short depth, std::vector<BasicSudokuSolver> &subtrees ) const;
+
+            // Copies the current values (a solution, after a search succeeded) to a board.
+            void to_board( SBoard &sb ) const;
+
+            // Tells if the givens do not break any rule.
+            inline bool is_consistent() const { return m_consistent; }
+
+            inline const Stats & stats() const { return m_stats; }
+
+            // Candidate digits of a location considering the givens only.
+            mask_t candidates( short line, short column ) const;
+    };
+
+    typedef BasicSudokuSolver<ClassicRules> SudokuSolver;
+
+    extern template class BasicSudokuSolver<ClassicRules>;
+    extern template class BasicSudokuSolver<DiagonalRules>;
+    extern template class BasicSudokuSolver<AntiKnightRules>;
+    extern template class BasicSudokuSolver<JigsawRules>;
+    extern template class BasicSudokuSolver<KillerRules>;
+}
+
+#endif
@@ -0,0 +1,333 @@
+#ifndef SUDOKU_VARIANT_RULES_H
+#define SUDOKU_VARIANT_RULES_H
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+using std::vector;
+#include "config.h"
+#include "board_geometry.h"
+
+/*!
+ *  Rule sets of the Sudoku variants, as compile-time plug-ins.
+ *
+ *  A rule set is a plain type handed as a template argument to the code that
+ *  checks or solves boards (BasicSudokuSolver, BasicSBoardManager, is_solved),
+ *  so every call below is resolved, and usually inlined, at compile time and
+ *  ClassicRules adds nothing to the classic 9x9 path. A rule set provides:
+ *
+ *  + `region( cell )`: the third unit of a location, the box in classic rules
+ *    (jigsaw regions replace it);
+ *  + `allows( cell, digit, value_at )`: tells if a digit may go to a location
+ *    given the values of the others, `value_at( cell )` returning 0 for an
+ *    empty location. Placement status and validation use it;
+ *  + `State`: what a solver keeps to answer `allowed( cell, cells )` (bit `d`
+ *    set if digit `d` is still possible beyond the row, column and region) as
+ *    `place` and `clear` fill and empty locations.
+ *
+ *  Bit `d` of a digit mask stands for digit `d`, as in SudokuSolver.
+ *
+ *  How to use it:
+ *  ```c++
+ *      KillerRules rules{ cages };
+ *      BasicSudokuSolver<KillerRules> solver{ puzzle, rules };
+ *      if (solver.solve(solution)) assert(is_solved(solution, rules));
+ *  ```
+ */
+
+namespace sdkg {
+
+    constexpr uint16_t DIGIT_BITS{ 0x3FE };     //!< Bits 1 to 9 set.
+
+    /// Tells if the locations in `peers` (other than `cell`) leave room for `digit`.
+    template < typename ValueAt >
+    inline bool no_peer_holds( const uint8_t *peers, short n, short digit, ValueAt value_at ) {
+        for (short k{0}; k < n; k++) {
+            if (value_at(peers[k]) == digit) return false;
+        }
+        return true;
+    }
+
+    /// Rows, columns and 3x3 boxes.
+    struct ClassicRules {
+        static constexpr const char *NAME{ "classic" };
+
+        inline short region( short cell ) const { return GEOMETRY.box[cell]; }
+
+        template < typename ValueAt >
+        inline bool allows( short cell, short digit, ValueAt value_at ) const {
+            return no_peer_holds(GEOMETRY.peers[cell], BoardGeometry::N_PEERS, digit, value_at);
+        }
+
+        struct State {
+            explicit State( const ClassicRules & ) {}
+
+            inline uint16_t allowed( const ClassicRules &, const short *, short ) const { return DIGIT_BITS; }
+            inline void place( const ClassicRules &, short, short ) {}
+            inline void clear( const ClassicRules &, short, short ) {}
+        };
+    };
+
+    /// Classic rules, plus both main diagonals hold every digit once (Sudoku X).
+    struct DiagonalRules {
+        static constexpr const char *NAME{ "diagonal" };
+
+        inline short region( short cell ) const { return GEOMETRY.box[cell]; }
+
+        /// Bit 0 set if the location is on the main diagonal, bit 1 if it is on the anti-diagonal.
+        static inline unsigned diagonals_of( short cell ) {
+            return (GEOMETRY.line[cell] == GEOMETRY.column[cell] ? 1u : 0u)
+                 | (GEOMETRY.line[cell] + GEOMETRY.column[cell] == Config::SB_SIZE - 1 ? 2u : 0u);
+        }
+
+        template < typename ValueAt >
+        inline bool allows( short cell, short digit, ValueAt value_at ) const {
+            if (not no_peer_holds(GEOMETRY.peers[cell], BoardGeometry::N_PEERS, digit, value_at)) return false;
+            unsigned diagonals = diagonals_of(cell);
+            for (short k{0}; k < Config::SB_SIZE and diagonals != 0; k++) {
+                auto main = (short) BoardGeometry::cell_of(k, k), anti = (short) BoardGeometry::cell_of(k, (short) (Config::SB_SIZE - 1 - k));
+                if ((diagonals & 1u) and main != cell and value_at(main) == digit) return false;
+                if ((diagonals & 2u) and anti != cell and value_at(anti) == digit) return false;
+            }
+            return true;
+        }
+
+        struct State {
+            uint16_t used[2]{};     //!< Digits used on the main and anti-diagonal.
+
+            explicit State( const DiagonalRules & ) {}
+
+            inline uint16_t allowed( const DiagonalRules &, const short *, short cell ) const {
+                unsigned diagonals = diagonals_of(cell);
+                return (uint16_t) (DIGIT_BITS & ~((diagonals & 1u ? used[0] : 0) | (diagonals & 2u ? used[1] : 0)));
+            }
+            inline void place( const DiagonalRules &, short cell, short digit ) {
+                unsigned diagonals = diagonals_of(cell);
+                if (diagonals & 1u) used[0] |= (uint16_t) (1u << digit);
+                if (diagonals & 2u) used[1] |= (uint16_t) (1u << digit);
+            }
+            inline void clear( const DiagonalRules &, short cell, short digit ) {
+                unsigned diagonals = diagonals_of(cell);
+                if (diagonals & 1u) used[0] &= (uint16_t) ~(1u << digit);
+                if (diagonals & 2u) used[1] &= (uint16_t) ~(1u << digit);
+            }
+        };
+    };
+
+    /// Locations a chess knight's move apart, computed by the compiler.
+    struct KnightMoves {
+        uint8_t count[BoardGeometry::N_CELLS];
+        uint8_t cells[BoardGeometry::N_CELLS][8];
+    };
+
+    constexpr KnightMoves make_knight_moves() {
+        KnightMoves k{};
+        constexpr short DL[]{ -2, -2, -1, -1, 1, 1, 2, 2 }, DC[]{ -1, 1, -2, 2, -2, 2, -1, 1 };
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            for (short m{0}; m < 8; m++) {
+                short l = (short) (GEOMETRY.line[cell] + DL[m]), c = (short) (GEOMETRY.column[cell] + DC[m]);
+                if (l < 0 or l >= Config::SB_SIZE or c < 0 or c >= Config::SB_SIZE) continue;
+                k.cells[cell][k.count[cell]++] = (uint8_t) BoardGeometry::cell_of(l, c);
+            }
+        }
+        return k;
+    }
+
+    inline constexpr KnightMoves KNIGHT_MOVES = make_knight_moves();
+
+    /// Classic rules, plus locations a knight's move apart never hold the same digit.
+    struct AntiKnightRules {
+        static constexpr const char *NAME{ "anti-knight" };
+
+        inline short region( short cell ) const { return GEOMETRY.box[cell]; }
+
+        template < typename ValueAt >
+        inline bool allows( short cell, short digit, ValueAt value_at ) const {
+            return no_peer_holds(GEOMETRY.peers[cell], BoardGeometry::N_PEERS, digit, value_at)
+               and no_peer_holds(KNIGHT_MOVES.cells[cell], KNIGHT_MOVES.count[cell], digit, value_at);
+        }
+
+        struct State {
+            // the knight's cells are read straight from the solver's values, nothing to keep
+            explicit State( const AntiKnightRules & ) {}
+
+            inline uint16_t allowed( const AntiKnightRules &, const short *cells, short cell ) const {
+                unsigned used = 0;
+                for (short k{0}; k < KNIGHT_MOVES.count[cell]; k++) used |= 1u << cells[KNIGHT_MOVES.cells[cell][k]];
+                return (uint16_t) (DIGIT_BITS & ~used);
+            }
+            inline void place( const AntiKnightRules &, short, short ) {}
+            inline void clear( const AntiKnightRules &, short, short ) {}
+        };
+    };
+
+    /// Rows, columns and nine irregular regions of nine locations instead of the boxes.
+    class JigsawRules {
+        public:
+            static constexpr const char *NAME{ "jigsaw" };
+
+        private:
+            uint8_t m_region[BoardGeometry::N_CELLS]{};
+            uint8_t m_peers[BoardGeometry::N_CELLS][3 * (Config::SB_SIZE - 1)]{};   //!< Row, column and region peers.
+            uint8_t m_n_peers[BoardGeometry::N_CELLS]{};
+
+        public:
+            /// Regions from 81 chars '0' to '8', row-major. Throws std::invalid_argument unless every region has 9 locations.
+            explicit JigsawRules( const char *layout ) {
+                short size[Config::SB_SIZE]{};
+                for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+                    if (layout[cell] < '0' or layout[cell] > '8') throw std::invalid_argument("JigsawRules: regions are '0' to '8'");
+                    m_region[cell] = (uint8_t) (layout[cell] - '0');
+                    size[m_region[cell]]++;
+                }
+                for (short n : size) {
+                    if (n != Config::SB_SIZE) throw std::invalid_argument("JigsawRules: every region needs 9 locations");
+                }
+                for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+                    for (short other{0}; other < BoardGeometry::N_CELLS; other++) {
+                        if (other != cell and (GEOMETRY.line[other] == GEOMETRY.line[cell] or GEOMETRY.column[other] == GEOMETRY.column[cell]
+                                               or m_region[other] == m_region[cell])) {
+                            m_peers[cell][m_n_peers[cell]++] = (uint8_t) other;
+                        }
+                    }
+                }
+            }
+
+            inline short region( short cell ) const { return m_region[cell]; }
+
+            template < typename ValueAt >
+            inline bool allows( short cell, short digit, ValueAt value_at ) const {
+                return no_peer_holds(m_peers[cell], m_n_peers[cell], digit, value_at);
+            }
+
+            struct State {
+                explicit State( const JigsawRules & ) {}
+
+                inline uint16_t allowed( const JigsawRules &, const short *, short ) const { return DIGIT_BITS; }
+                inline void place( const JigsawRules &, short, short ) {}
+                inline void clear( const JigsawRules &, short, short ) {}
+            };
+    };
+
+    /// Classic rules, plus cages: groups of locations with distinct digits adding up to the cage's sum.
+    class KillerRules {
+        public:
+            static constexpr const char *NAME{ "killer" };
+
+            struct Cage {
+                short sum;
+                vector<short> cells;
+            };
+
+        private:
+            vector<Cage> m_cages;
+            vector<short> m_cage_of;    //!< Cage of every location, -1 if none.
+
+        public:
+            /// Throws std::invalid_argument if a location is in two cages or a cage cannot add up to its sum.
+            explicit KillerRules( vector<Cage> cages ) : m_cages{ std::move(cages) }, m_cage_of(BoardGeometry::N_CELLS, -1) {
+                for (size_t k{0}; k < m_cages.size(); k++) {
+                    const Cage &cage = m_cages[k];
+                    auto n = (short) cage.cells.size();
+                    if (n < 1 or n > Config::SB_SIZE or cage.sum < n * (n + 1) / 2 or cage.sum > n * (19 - n) / 2) {
+                        throw std::invalid_argument("KillerRules: impossible cage");
+                    }
+                    for (short cell : cage.cells) {
+                        if (cell < 0 or cell >= BoardGeometry::N_CELLS or m_cage_of[cell] >= 0) throw std::invalid_argument("KillerRules: bad cage location");
+                        m_cage_of[cell] = (short) k;
+                    }
+                }
+            }
+
+            inline const vector<Cage> & cages() const { return m_cages; }
+            inline short region( short cell ) const { return GEOMETRY.box[cell]; }
+
+            template < typename ValueAt >
+            inline bool allows( short cell, short digit, ValueAt value_at ) const {
+                if (not no_peer_holds(GEOMETRY.peers[cell], BoardGeometry::N_PEERS, digit, value_at)) return false;
+                if (m_cage_of[cell] < 0) return true;
+                const Cage &cage = m_cages[m_cage_of[cell]];
+                short sum = digit;
+                bool full = true;
+                for (short mate : cage.cells) {
+                    if (mate == cell) continue;
+                    short value = value_at(mate);
+                    if (value == digit) return false;
+                    sum = (short) (sum + value);
+                    full = full and value != 0;
+                }
+                return full ? sum == cage.sum : sum < cage.sum;
+            }
+
+            struct State {
+                vector<uint16_t> used;      //!< Digits placed in every cage.
+                vector<short> sum;          //!< Sum placed in every cage.
+                vector<short> left;         //!< Empty locations of every cage.
+
+                explicit State( const KillerRules &rules ) : used(rules.m_cages.size()), sum(rules.m_cages.size()) {
+                    for (const Cage &cage : rules.m_cages) left.push_back((short) cage.cells.size());
+                }
+
+                inline uint16_t allowed( const KillerRules &rules, const short *, short cell ) const {
+                    short k = rules.m_cage_of[cell];
+                    if (k < 0) return DIGIT_BITS;
+                    auto free = (uint16_t) (DIGIT_BITS & ~used[k]);
+                    short others = (short) (left[k] - 1), target = (short) (rules.m_cages[k].sum - sum[k]);
+                    uint16_t ok = 0;
+                    for (uint16_t cand = free; cand; cand &= (uint16_t) (cand - 1)) {
+                        auto digit = (short) __builtin_ctz(cand);
+                        // the other empty locations must reach the rest of the sum with distinct digits left
+                        short rest = (short) (target - digit), lo = 0, hi = 0, n = 0;
+                        auto avail = (uint16_t) (free & ~(1u << digit));
+                        for (short d{1}; d <= Config::SB_SIZE and n < others; d++) {
+                            if (not (avail & (1u << d))) continue;
+                            lo = (short) (lo + d);
+                            n++;
+                        }
+                        if (n < others) continue;
+                        n = 0;
+                        for (short d{Config::SB_SIZE}; d >= 1 and n < others; d--) {
+                            if (not (avail & (1u << d))) continue;
+                            hi = (short) (hi + d);
+                            n++;
+                        }
+                        if (rest >= lo and rest <= hi) ok |= (uint16_t) (1u << digit);
+                    }
+                    return ok;
+                }
+                inline void place( const KillerRules &rules, short cell, short digit ) {
+                    short k = rules.m_cage_of[cell];
+                    if (k < 0) return;
+                    used[k] |= (uint16_t) (1u << digit);
+                    sum[k] = (short) (sum[k] + digit);
+                    left[k]--;
+                }
+                inline void clear( const KillerRules &rules, short cell, short digit ) {
+                    short k = rules.m_cage_of[cell];
+                    if (k < 0) return;
+                    used[k] &= (uint16_t) ~(1u << digit);
+                    sum[k] = (short) (sum[k] - digit);
+                    left[k]++;
+                }
+            };
+    };
+
+    /// Tells if the filled locations of a board (an SBoard, or anything with `at( line, column )`) hold digits in
+    /// [1, 9] following the rules. Empty locations (0) are skipped, unless `complete` requires every location filled.
+    template < typename Rules, typename Board >
+    bool is_consistent( const Board &sb, const Rules &rules, bool complete=false ) {
+        auto value_at = [&sb]( short cell ) { return sb.at(GEOMETRY.line[cell], GEOMETRY.column[cell]); };
+        for (short cell{0}; cell < BoardGeometry::N_CELLS; cell++) {
+            short digit = value_at(cell);
+            if (digit == 0 and not complete) continue;
+            if (digit < Config::SUDOKU_SMALLEST_NUM or digit > Config::SUDOKU_BIGGEST_NUM) return false;
+            if (not rules.allows(cell, digit, value_at)) return false;
+        }
+        return true;
+    }
+
+    /// Tells if a board is filled with digits in [1, 9] following the rules.
+    template < typename Rules, typename Board >
+    inline bool is_solved( const Board &sb, const Rules &rules ) { return is_consistent(sb, rules, true); }
+}
+
+#endif //SUDOKU_VARIANT_RULES_H
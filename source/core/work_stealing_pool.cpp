@@ -0,0 +1,90 @@
+#include <algorithm>
+#include "work_stealing_pool.h"
+
+namespace sdkg {
+
+    namespace {
+        /// Pool and worker index of the current thread, so tasks can push to their own deque.
+        thread_local const WorkStealingPool * tl_pool = nullptr;
+        thread_local size_t tl_worker = 0;
+    }
+
+    WorkStealingPool::WorkStealingPool(unsigned threads) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t{0}; t < threads; t++) m_queues.push_back(std::make_unique<Queue>());
+        for (unsigned t{0}; t < threads; t++) m_workers.emplace_back(&WorkStealingPool::work, this, t);
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock{m_idle_mutex};
+            m_stop = true;
+        }
+        m_has_work.notify_all();
+        for (std::thread &worker : m_workers) worker.join();
+    }
+
+    void WorkStealingPool::submit(task_t task) {
+        size_t target = (tl_pool == this) ? tl_worker : m_next_queue++ % m_queues.size();
+        m_pending++;
+        {
+            std::lock_guard<std::mutex> lock{m_queues[target]->mutex};
+            m_queues[target]->tasks.push_back(std::move(task));
+            m_queued++;
+        }
+        // taking the idle lock orders this push before a sleeping worker's check of m_queued
+        { std::lock_guard<std::mutex> lock{m_idle_mutex}; }
+        m_has_work.notify_one();
+    }
+
+    bool WorkStealingPool::pop_local(size_t worker, task_t &task) {
+        Queue &queue = *m_queues[worker];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        m_queued--;
+        return true;
+    }
+
+    bool WorkStealingPool::steal(size_t worker, task_t &task) {
+        for (size_t k{1}; k < m_queues.size(); k++) {
+            Queue &victim = *m_queues[(worker + k) % m_queues.size()];
+            std::lock_guard<std::mutex> lock{victim.mutex};
+            if (victim.tasks.empty()) continue;
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            m_queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void WorkStealingPool::work(size_t worker) {
+        tl_pool = this;
+        tl_worker = worker;
+        task_t task;
+        while (true) {
+            if (pop_local(worker, task) or steal(worker, task)) {
+                task();
+                task = nullptr;
+                if (--m_pending == 0) {
+                    std::lock_guard<std::mutex> lock{m_idle_mutex};
+                    m_all_done.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{m_idle_mutex};
+            // running tasks may still submit work: sleep until a push (it notifies) or the stop, not a timeout
+            m_idle++;
+            m_has_work.wait(lock, [this]() { return m_stop or m_queued != 0; });
+            m_idle--;
+            if (m_stop and m_queued == 0) return;
+        }
+    }
+
+    void WorkStealingPool::wait() {
+        std::unique_lock<std::mutex> lock{m_idle_mutex};
+        m_all_done.wait(lock, [this]() { return m_pending == 0; });
+    }
+}
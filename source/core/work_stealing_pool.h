@@ -0,0 +1,74 @@
+#ifndef SUDOKU_WORK_STEALING_POOL_H
+#define SUDOKU_WORK_STEALING_POOL_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::vector;
+
+/*!
+ *  Fixed-size thread pool with one task deque per worker.
+ *
+ *  A worker takes tasks from the back of its own deque (the most recently
+ *  pushed, still hot in cache) and, when it runs dry, steals from the front
+ *  of the other workers' deques (the oldest tasks, usually the biggest
+ *  subtrees of a search). Tasks submitted from inside a task go to the
+ *  submitting worker's deque; tasks submitted from outside are spread
+ *  round-robin. A task may check `idle_workers()` to split its work only
+ *  when some worker would take it.
+ *
+ *  Workers with nothing to run sleep until a task is pushed, without polling.
+ */
+
+namespace sdkg {
+
+    class WorkStealingPool {
+        public:
+            typedef std::function<void()> task_t;
+
+        private:
+            /// A worker's task deque, guarded by its own lock so the owner and thieves rarely contend.
+            struct Queue {
+                std::mutex mutex;
+                std::deque<task_t> tasks;
+            };
+
+            vector<std::unique_ptr<Queue>> m_queues;
+            vector<std::thread> m_workers;
+            std::atomic<size_t> m_pending{ 0 };     //!< Tasks submitted and not finished yet.
+            std::atomic<size_t> m_queued{ 0 };      //!< Tasks in the deques, not taken by a worker yet.
+            std::atomic<size_t> m_idle{ 0 };        //!< Workers sleeping for lack of tasks.
+            std::atomic<size_t> m_next_queue{ 0 };  //!< Round-robin cursor for external submissions.
+            std::mutex m_idle_mutex;
+            std::condition_variable m_has_work;      //!< Signaled when a task is pushed or the pool stops.
+            std::condition_variable m_all_done;      //!< Signaled when m_pending drops to zero.
+            bool m_stop = false;
+
+            bool pop_local( size_t worker, task_t &task );
+            bool steal( size_t worker, task_t &task );
+            void work( size_t worker );
+
+        public:
+            // Starts the workers, `threads` = 0 means one per core.
+            explicit WorkStealingPool( unsigned threads=0 );
+            ~WorkStealingPool();
+            WorkStealingPool & operator=( const WorkStealingPool & ) = delete;
+            WorkStealingPool( const WorkStealingPool & ) = delete;
+
+            void submit( task_t task );
+
+            // Blocks until every submitted task (and the tasks they submitted) finished.
+            void wait();
+
+            inline size_t size() const { return m_workers.size(); }
+
+            // # of workers waiting for a task right now, a hint for tasks that could split their work.
+            inline size_t idle_workers() const { return m_idle.load(std::memory_order_relaxed); }
+    };
+}
+
+#endif //SUDOKU_WORK_STEALING_POOL_H
@@ -0,0 +1,83 @@
+#ifndef SUDOKUGAME_EXPECTED_H
+#define SUDOKUGAME_EXPECTED_H
+
+/*!
+ * A value or the error that prevented it, returned instead of thrown.
+ *
+ * This is a small subset of C++23's std::expected, for the paths where bad
+ * input is routine (bot commands, malformed feeds): a failure costs a
+ * return, not an exception unwind. Names follow std::expected, so the type
+ * can be swapped for it when the project moves to C++23.
+ *
+ * How to use it:
+ * ```c++
+ *      Expected<short, error_e> parse( const string &token ) {
+ *          if (token.empty()) return unexpected(error_e::MISSING);
+ *          return short{ ... };
+ *      }
+ *      auto digit = parse("7");
+ *      if (digit) use(*digit); else report(digit.error());
+ * ```
+ */
+#include <cassert>
+#include <utility>
+
+/// The error side of an Expected, see `unexpected`.
+template <typename E>
+class Unexpected {
+    private:
+        E m_error;
+
+    public:
+        constexpr explicit Unexpected( E error ) : m_error{ std::move(error) } {}
+        constexpr const E & error() const { return m_error; }
+};
+
+/// Wraps an error to be returned as an Expected.
+template <typename E>
+constexpr Unexpected<E> unexpected( E error ) { return Unexpected<E>{ std::move(error) }; }
+
+template <typename T, typename E>
+class Expected {
+    private:
+        bool m_has_value;
+        T m_value{};
+        E m_error{};
+
+    public:
+        constexpr Expected( T value ) : m_has_value{ true }, m_value{ std::move(value) } {}
+        template <typename G>
+        constexpr Expected( Unexpected<G> error ) : m_has_value{ false }, m_error{ error.error() } {}
+
+        constexpr bool has_value() const { return m_has_value; }
+        constexpr explicit operator bool() const { return m_has_value; }
+
+        /// The value; only valid if has_value().
+        constexpr const T & value() const { assert(m_has_value); return m_value; }
+        constexpr const T & operator*() const { return value(); }
+        constexpr const T * operator->() const { return &value(); }
+        constexpr T value_or( T other ) const { return m_has_value ? m_value : other; }
+
+        /// The error; only valid if not has_value().
+        constexpr const E & error() const { assert(not m_has_value); return m_error; }
+};
+
+/// A status: nothing on success, the error otherwise.
+template <typename E>
+class Expected<void, E> {
+    private:
+        bool m_has_value;
+        E m_error{};
+
+    public:
+        constexpr Expected() : m_has_value{ true } {}
+        template <typename G>
+        constexpr Expected( Unexpected<G> error ) : m_has_value{ false }, m_error{ error.error() } {}
+
+        constexpr bool has_value() const { return m_has_value; }
+        constexpr explicit operator bool() const { return m_has_value; }
+
+        constexpr const E & error() const { assert(not m_has_value); return m_error; }
+};
+
+#endif //SUDOKUGAME_EXPECTED_H
@@ -0,0 +1,161 @@
+#ifndef SUDOKUGAME_HDR_HISTOGRAM_H
+#define SUDOKUGAME_HDR_HISTOGRAM_H
+
+/*!
+ * High dynamic range latency histogram, after HdrHistogram.
+ *
+ * Values (nanoseconds) are counted in log-linear buckets: every power of two
+ * range is split into 512 sub-buckets, so any value is known within 0.2%,
+ * from 1 ns to about 68 s, in a fixed 115 KiB. Recording is a bit scan and
+ * an increment. Unlike LatencyHistogram (power of two buckets, good enough
+ * for a dashboard) this resolves the tail: p99.9 of two runs can be told
+ * apart when they differ by a percent.
+ *
+ * `write_percentiles` writes the percentile distribution in HdrHistogram's
+ * text format (.hgrm), which HdrHistogram's plotter and most tools built on it
+ * read, so runs before and after a change can be overlaid.
+ *
+ * A histogram is not thread-safe: keep one per thread and `merge` them.
+ *
+ * How to use it:
+ * ```c++
+ *      HdrHistogram h;
+ *      h.record(std::chrono::microseconds(250));
+ *      uint64_t p999 = h.value_at_percentile(99.9);      // ns
+ *      h.write_percentiles(std::cout);                    // in microseconds
+ * ```
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+class HdrHistogram {
+    public:
+        static constexpr unsigned SUB_BITS{ 10 };                   //!< 2^10 sub-buckets per power of two (half of them past the first).
+        static constexpr uint64_t SUB_COUNT{ uint64_t{1} << SUB_BITS };
+        static constexpr unsigned MAX_BITS{ 36 };                   //!< Values up to 2^36 ns (~68 s), longer ones count as that.
+        static constexpr uint64_t MAX_VALUE{ (uint64_t{1} << MAX_BITS) - 1 };
+        static constexpr size_t N_BUCKETS{ MAX_BITS - SUB_BITS + 1 }; //!< Power of two ranges, the first one linear.
+        static constexpr size_t N_COUNTS{ SUB_COUNT + (N_BUCKETS - 1) * (SUB_COUNT / 2) };
+
+    private:
+        std::vector<uint64_t> m_counts;
+        uint64_t m_total = 0;
+        uint64_t m_min = UINT64_MAX;
+        uint64_t m_max = 0;
+        double m_sum = 0;
+        double m_sum_squares = 0;
+
+        /// Index of the count of a value: values below SUB_COUNT have their own, above they share one per 2^shift.
+        static size_t index_of( uint64_t value ) {
+            if (value < SUB_COUNT) return (size_t) value;
+            unsigned shift = 64 - (unsigned) __builtin_clzll(value) - SUB_BITS;
+            return (size_t) (SUB_COUNT + (shift - 1) * (SUB_COUNT / 2) + ((value >> shift) - SUB_COUNT / 2));
+        }
+
+        /// Highest value counted at an index.
+        static uint64_t highest_value_at( size_t idx ) {
+            if (idx < SUB_COUNT) return idx;
+            size_t shift = (idx - SUB_COUNT) / (SUB_COUNT / 2) + 1;
+            uint64_t sub = (idx - SUB_COUNT) % (SUB_COUNT / 2) + SUB_COUNT / 2;
+            return ((sub + 1) << shift) - 1;
+        }
+
+    public:
+        HdrHistogram() : m_counts(N_COUNTS, 0) {/*empty*/}
+
+        void record( uint64_t ns ) {
+            ns = std::min(ns, MAX_VALUE);
+            m_counts[index_of(ns)]++;
+            m_total++;
+            m_min = std::min(m_min, ns);
+            m_max = std::max(m_max, ns);
+            m_sum += (double) ns;
+            m_sum_squares += (double) ns * (double) ns;
+        }
+
+        void record( std::chrono::nanoseconds elapsed ) {
+            record(elapsed.count() > 0 ? (uint64_t) elapsed.count() : 0);
+        }
+
+        void merge( const HdrHistogram &other ) {
+            for (size_t k{0}; k < N_COUNTS; k++) m_counts[k] += other.m_counts[k];
+            m_total += other.m_total;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+            m_sum += other.m_sum;
+            m_sum_squares += other.m_sum_squares;
+        }
+
+        uint64_t count() const { return m_total; }
+        uint64_t min() const { return m_total != 0 ? m_min : 0; }
+        uint64_t max() const { return m_max; }
+        double mean() const { return m_total != 0 ? m_sum / (double) m_total : 0.0; }
+        double stddev() const {
+            if (m_total == 0) return 0.0;
+            double mean = m_sum / (double) m_total;
+            return std::sqrt(std::max(0.0, m_sum_squares / (double) m_total - mean * mean));
+        }
+
+        /// Smallest value (as its bucket's highest, and never above the max) at or above `percentile`% of the values.
+        uint64_t value_at_percentile( double percentile ) const {
+            if (m_total == 0) return 0;
+            auto rank = (uint64_t) std::ceil(std::min(percentile, 100.0) / 100.0 * (double) m_total);
+            rank = std::max<uint64_t>(rank, 1);
+            uint64_t seen = 0;
+            for (size_t k{0}; k < N_COUNTS; k++) {
+                seen += m_counts[k];
+                if (seen >= rank) return std::min(highest_value_at(k), m_max);
+            }
+            return m_max;
+        }
+
+        /// # of values counted at or below `value`'s bucket.
+        uint64_t count_at_or_below( uint64_t value ) const {
+            uint64_t seen = 0;
+            size_t last = index_of(std::min(value, MAX_VALUE));
+            for (size_t k{0}; k <= last; k++) seen += m_counts[k];
+            return seen;
+        }
+
+        /// Writes the percentile distribution in the .hgrm format, values divided by `unit_ns` (microseconds by default).
+        /*!
+         * Percentiles are stepped like HdrHistogram's percentile iterator: `ticks` steps from 0% to 50%, as many
+         * from 50% to 75%, and so on, halving the distance to 100% every time, up to the maximum.
+         */
+        void write_percentiles( std::ostream &out, double unit_ns=1000.0, unsigned ticks=5 ) const {
+            char line[128];
+            out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+            double percentile = 0;
+            while (m_total != 0) {
+                uint64_t value = value_at_percentile(percentile);
+                uint64_t below = count_at_or_below(value);
+                if (below >= m_total) break;
+                std::snprintf(line, sizeof line, "%12.3f %14.12f %10llu %14.2f\n", (double) value / unit_ns,
+                              percentile / 100.0, (unsigned long long) below, 1.0 / (1.0 - percentile / 100.0));
+                out << line;
+                // the step halves every time the distance to 100% does
+                double halvings = std::floor(std::log2(100.0 / (100.0 - percentile)));
+                percentile += 100.0 / ((double) ticks * std::pow(2.0, halvings + 1));
+            }
+            if (m_total != 0) {
+                std::snprintf(line, sizeof line, "%12.3f %14.12f %10llu\n", (double) m_max / unit_ns, 1.0,
+                              (unsigned long long) m_total);
+                out << line;
+            }
+            std::snprintf(line, sizeof line, "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mean() / unit_ns, stddev() / unit_ns);
+            out << line;
+            std::snprintf(line, sizeof line, "#[Max     = %12.3f, Total count    = %12llu]\n", (double) m_max / unit_ns,
+                          (unsigned long long) m_total);
+            out << line;
+            std::snprintf(line, sizeof line, "#[Buckets = %12zu, SubBuckets     = %12llu]\n", N_BUCKETS, (unsigned long long) SUB_COUNT);
+            out << line;
+        }
+};
+
+#endif //SUDOKUGAME_HDR_HISTOGRAM_H
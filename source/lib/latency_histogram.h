@@ -0,0 +1,94 @@
+#ifndef SUDOKUGAME_LATENCY_HISTOGRAM_H
+#define SUDOKUGAME_LATENCY_HISTOGRAM_H
+
+/*!
+ * Fixed bucket latency histogram, recorded by a single thread and read by any.
+ *
+ * Bucket `i` counts durations up to 2^i microseconds, from 1us to about 71
+ * minutes, plus a last bucket for anything longer. Recording is a bit scan and
+ * three relaxed stores: only the owner thread writes, so no read-modify-write
+ * atomics are needed, while readers still see whole values.
+ *
+ * How to use it:
+ * ```c++
+ *      LatencyHistogram h;                          // owned by one thread
+ *      h.record(std::chrono::microseconds(250));
+ *      LatencyHistogram::Snapshot s;                // any thread
+ *      s.add(h);
+ *      double p99 = s.quantile(0.99);               // in seconds
+ * ```
+ */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+class LatencyHistogram {
+    public:
+        static constexpr size_t N_BUCKETS{ 34 };    //!< 33 power of two bounds plus the overflow bucket.
+
+        /// Upper bound, in seconds, of bucket `i` (the last one has no bound).
+        static constexpr double bucket_bound( size_t i ) {
+            return (double) (uint64_t{1} << i) * 1e-6;
+        }
+
+        /// Plain copy of one or more histograms.
+        struct Snapshot {
+            uint64_t buckets[N_BUCKETS]{};
+            uint64_t count = 0;
+            uint64_t sum_ns = 0;
+
+            void add( const LatencyHistogram &h ) {
+                for (size_t i{0}; i < N_BUCKETS; i++) buckets[i] += h.m_buckets[i].load(std::memory_order_relaxed);
+                count += h.m_count.load(std::memory_order_relaxed);
+                sum_ns += h.m_sum_ns.load(std::memory_order_relaxed);
+            }
+
+            void add( const Snapshot &s ) {
+                for (size_t i{0}; i < N_BUCKETS; i++) buckets[i] += s.buckets[i];
+                count += s.count;
+                sum_ns += s.sum_ns;
+            }
+
+            double sum_seconds() const { return (double) sum_ns * 1e-9; }
+
+            /// Upper bound, in seconds, of the bucket holding the q-quantile (0 if empty).
+            double quantile( double q ) const {
+                uint64_t total = 0;
+                for (size_t i{0}; i < N_BUCKETS; i++) total += buckets[i];
+                if (total == 0) return 0;
+                auto rank = (uint64_t) (q * (double) total);
+                if (rank >= total) rank = total - 1;
+                uint64_t seen = 0;
+                for (size_t i{0}; i + 1 < N_BUCKETS; i++) {
+                    seen += buckets[i];
+                    if (seen > rank) return bucket_bound(i);
+                }
+                return bucket_bound(N_BUCKETS - 2);
+            }
+        };
+
+    private:
+        std::atomic<uint64_t> m_buckets[N_BUCKETS]{};
+        std::atomic<uint64_t> m_count{ 0 };
+        std::atomic<uint64_t> m_sum_ns{ 0 };
+
+        static void bump( std::atomic<uint64_t> &a, uint64_t n ) {
+            a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+    public:
+        /// Owner thread only.
+        void record( std::chrono::nanoseconds elapsed ) {
+            uint64_t ns = elapsed.count() > 0 ? (uint64_t) elapsed.count() : 0;
+            uint64_t us = (ns + 999) / 1000;
+            // smallest i with us <= 2^i
+            size_t i = us <= 1 ? 0 : (size_t) (64 - __builtin_clzll(us - 1));
+            if (i > N_BUCKETS - 1) i = N_BUCKETS - 1;
+            bump(m_buckets[i], 1);
+            bump(m_count, 1);
+            bump(m_sum_ns, ns);
+        }
+};
+
+#endif //SUDOKUGAME_LATENCY_HISTOGRAM_H
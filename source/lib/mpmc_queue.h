@@ -0,0 +1,108 @@
+#ifndef SUDOKUGAME_MPMC_QUEUE_H
+#define SUDOKUGAME_MPMC_QUEUE_H
+
+/*!
+ * Bounded lock-free queue for any number of producer and consumer threads.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue: every slot carries a sequence
+ * number telling whether it is ready to be written (sequence == position)
+ * or read (sequence == position + 1), so a producer or a consumer claims a
+ * position with a single compare-and-swap on the tail or head, and hands
+ * the slot over with a release store of its sequence. Threads never wait
+ * for each other: a full queue makes `try_push` fail, an empty one makes
+ * `try_pop` fail, and it is up to the caller to back off (backpressure).
+ *
+ * The head, the tail and every slot sit on their own cache lines, so
+ * producers and consumers only share the line of the slot they exchange.
+ *
+ * How to use it:
+ * ```c++
+ *      MpmcQueue<Puzzle, 256> queue;
+ *      while (not queue.try_push(puzzle)) backoff();   // any producer thread
+ *      Puzzle next;
+ *      if (queue.try_pop(next)) { ... }               // any consumer thread
+ * ```
+ */
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+template <typename T, size_t Capacity>
+class MpmcQueue {
+    static_assert(Capacity >= 2 and (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    private:
+        static constexpr size_t CACHE_LINE{ 64 };
+
+        struct alignas(CACHE_LINE) Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        Slot m_slots[Capacity];
+        alignas(CACHE_LINE) std::atomic<size_t> m_head{ 0 };   //!< Next position to pop.
+        alignas(CACHE_LINE) std::atomic<size_t> m_tail{ 0 };   //!< Next position to push.
+
+    public:
+        MpmcQueue() {
+            for (size_t i{0}; i < Capacity; i++) m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        MpmcQueue & operator=( const MpmcQueue & ) = delete;
+        MpmcQueue( const MpmcQueue & ) = delete;
+
+        /// Enqueues a value, returns false if the queue is full.
+        template <typename U>
+        bool try_push( U &&value ) {
+            size_t pos = m_tail.load(std::memory_order_relaxed);
+            while (true) {
+                Slot &slot = m_slots[pos & (Capacity - 1)];
+                size_t seq = slot.sequence.load(std::memory_order_acquire);
+                auto diff = (ptrdiff_t) seq - (ptrdiff_t) pos;
+                if (diff == 0) {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        slot.value = std::forward<U>(value);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;   // the slot still holds the value pushed a lap ago
+                } else {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// Dequeues a value, returns false if the queue is empty.
+        bool try_pop( T &value ) {
+            size_t pos = m_head.load(std::memory_order_relaxed);
+            while (true) {
+                Slot &slot = m_slots[pos & (Capacity - 1)];
+                size_t seq = slot.sequence.load(std::memory_order_acquire);
+                auto diff = (ptrdiff_t) seq - (ptrdiff_t) (pos + 1);
+                if (diff == 0) {
+                    if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        value = std::move(slot.value);
+                        slot.sequence.store(pos + Capacity, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;   // nothing pushed there yet
+                } else {
+                    pos = m_head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// Approximate # of queued values (positions claimed, possibly not handed over yet).
+        size_t size() const {
+            size_t tail = m_tail.load(std::memory_order_acquire);
+            size_t head = m_head.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        static constexpr size_t capacity() { return Capacity; }
+};
+
+#endif //SUDOKUGAME_MPMC_QUEUE_H
@@ -0,0 +1,69 @@
+#ifndef SUDOKUGAME_SPSC_QUEUE_H
+#define SUDOKUGAME_SPSC_QUEUE_H
+
+/*!
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * The producer only writes `m_tail` and the consumer only writes `m_head`, so
+ * pushing and popping are a couple of loads and one release store, with no
+ * locks or read-modify-write atomics. Each index sits on its own cache line.
+ *
+ * How to use it:
+ * ```c++
+ *      SpscQueue<std::string, 64> queue;
+ *      queue.try_push("p 1 2 3");       // producer thread
+ *      std::string cmd;
+ *      if (queue.try_pop(cmd)) { ... }  // consumer thread
+ * ```
+ */
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 and (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    private:
+        static constexpr size_t CACHE_LINE{ 64 };
+
+        T m_slots[Capacity];
+        alignas(CACHE_LINE) std::atomic<size_t> m_head{ 0 };   //!< Next slot to pop (consumer owned).
+        alignas(CACHE_LINE) std::atomic<size_t> m_tail{ 0 };   //!< Next slot to push (producer owned).
+
+    public:
+        /// Producer side: enqueues a value, returns false if the queue is full.
+        template <typename U>
+        bool try_push( U &&value ) {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == Capacity) return false;
+            m_slots[tail & (Capacity - 1)] = std::forward<U>(value);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Consumer side: dequeues a value, returns false if the queue is empty.
+        bool try_pop( T &value ) {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) return false;
+            value = std::move(m_slots[head & (Capacity - 1)]);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Consumer side: the next value without dequeuing it, or nullptr if the queue is empty.
+        const T * front() const {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) return nullptr;
+            return &m_slots[head & (Capacity - 1)];
+        }
+
+        /// Approximate # of queued values (exact when called from the producer or the consumer while the other is idle).
+        size_t size() const {
+            return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        }
+
+        bool empty() const { return size() == 0; }
+};
+
+#endif //SUDOKUGAME_SPSC_QUEUE_H
@@ -4,20 +4,35 @@
 /*!
  * Color code:
  * https://en.wikipedia.org/wiki/ANSI_escape_code#Colors
- * 
+ *
  * How to use this function:
  * ```c++
  *      std::cout << "Esse texto aparece normal, "
  *                << Color::tcolor("texto em vermelho e negrito", Color::RED, Color::BOLD)
  *                << "\n";
  * ```
+ *
+ * The escape sequences of every color/modifier pair are built by the
+ * compiler into a table, and `append` writes a colored span into a buffer
+ * of the caller without allocating, e.g. to render a whole board at once:
+ * ```c++
+ *      char line[64 * Color::MAX_SPAN_OVERHEAD];
+ *      size_t n = Color::append(line, "5", Color::BRIGHT_CYAN);
+ * ```
+ * `enable_if_tty()` turns colors off when the output is piped or logged
+ * (or NO_COLOR is set): spans are then written as plain text.
  */
-#include <sstream>
-using std::ostringstream;
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib> // getenv
+#include <cstring>
 #include <string>
 using std::string;
+#include <string_view>
 #include <array>
 using std::array;
+#include <unistd.h> // isatty
 
 namespace Color {
     // Alias
@@ -52,18 +67,116 @@ namespace Color {
         31, 32, 33, 34, 35, 36, 37,
         91, 92, 93, 94, 95, 96, 97};
 
+    /// Longest escape sequence starting a span ("\33[-32768;-32768m").
+    static constexpr size_t MAX_PREFIX{ 16 };
+    /// Escape sequence ending a span.
+    static constexpr std::string_view RESET{ "\33[0m" };
+    /// Bytes a colored span adds to its message, at most.
+    static constexpr size_t MAX_SPAN_OVERHEAD{ MAX_PREFIX + RESET.size() };
+
+    namespace detail {
+        static constexpr short N_MODIFIERS{ 10 };   //!< Modifiers [0, 9] are in the table.
+        static constexpr short N_CODES{ 108 };      //!< Colors [0, 107] (backgrounds included) are in the table.
+
+        /// "\33[<modifier>;<color>m", at most 8 chars for table entries.
+        struct Escape {
+            char text[8]{};
+            uint8_t size = 0;
+        };
+
+        struct EscapeTable {
+            Escape at[N_MODIFIERS][N_CODES]{};
+        };
+
+        constexpr EscapeTable make_escape_table() {
+            EscapeTable table{};
+            for (short modifier{0}; modifier < N_MODIFIERS; modifier++) {
+                for (short color{0}; color < N_CODES; color++) {
+                    Escape &e = table.at[modifier][color];
+                    e.text[e.size++] = '\33';
+                    e.text[e.size++] = '[';
+                    e.text[e.size++] = (char) ('0' + modifier);
+                    e.text[e.size++] = ';';
+                    if (color >= 100) e.text[e.size++] = (char) ('0' + color / 100);
+                    if (color >= 10) e.text[e.size++] = (char) ('0' + color / 10 % 10);
+                    e.text[e.size++] = (char) ('0' + color % 10);
+                    e.text[e.size++] = 'm';
+                }
+            }
+            return table;
+        }
+
+        inline constexpr EscapeTable ESCAPES{ make_escape_table() };
+
+        inline std::atomic<bool> enabled{ true };
+    }
+
+    /// Turns the escape sequences on or off for every span written from now on.
+    inline void set_enabled( bool on ) { detail::enabled.store(on, std::memory_order_relaxed); }
+    inline bool enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+
+    /// Keeps colors only if `fd` is a terminal and NO_COLOR is not set; returns whether they are on.
+    inline bool enable_if_tty( int fd=STDOUT_FILENO ) {
+        bool on = isatty(fd) == 1 and std::getenv("NO_COLOR") == nullptr;
+        set_enabled(on);
+        return on;
+    }
+
+    /// Writes the escape sequence starting a span into `out` (MAX_PREFIX chars at least), returns its size.
+    inline size_t write_prefix( char *out, short color, short modifier=Color::REGULAR ) {
+        if (modifier >= 0 and modifier < detail::N_MODIFIERS and color >= 0 and color < detail::N_CODES) {
+            const detail::Escape &e = detail::ESCAPES.at[modifier][color];
+            std::memcpy(out, e.text, e.size);
+            return e.size;
+        }
+        char *at = out;
+        *at++ = '\33';
+        *at++ = '[';
+        at = std::to_chars(at, out + MAX_PREFIX, modifier).ptr;
+        *at++ = ';';
+        at = std::to_chars(at, out + MAX_PREFIX, color).ptr;
+        *at++ = 'm';
+        return (size_t) (at - out);
+    }
+
+    /// Writes a colored message into `out` (msg.size() + MAX_SPAN_OVERHEAD chars at least), returns its size.
+    inline size_t append( char *out, std::string_view msg, short color=Color::WHITE, short modifier=Color::REGULAR ) {
+        if (not enabled()) {
+            std::memcpy(out, msg.data(), msg.size());
+            return msg.size();
+        }
+        size_t n = write_prefix(out, color, modifier);
+        std::memcpy(out + n, msg.data(), msg.size());
+        n += msg.size();
+        std::memcpy(out + n, RESET.data(), RESET.size());
+        return n + RESET.size();
+    }
+
+    /// Appends a colored message to a string, allocating only if it runs out of capacity.
+    inline void append( string &out, std::string_view msg, short color=Color::WHITE, short modifier=Color::REGULAR ) {
+        if (not enabled()) {
+            out.append(msg);
+            return;
+        }
+        char prefix[MAX_PREFIX];
+        out.append(prefix, write_prefix(prefix, color, modifier));
+        out.append(msg);
+        out.append(RESET);
+    }
+
     /// Returns a string with a colored message.
     /*!
      * @param msg Message to display.
      * @param color Color code to apply to the message.
      * @param modifier Modifier code to apply to the message.
-     * @return A string with the embedded color/modifier escape codes.
+     * @return A string with the embedded color/modifier escape codes (the message alone if colors are off).
      */
 
     inline string tcolor( const string & msg, short color=Color::WHITE, short modifier=Color::REGULAR ){
-        ostringstream oss;
-        oss << "\33[" << modifier << ";" << color << "m" << msg << "\33[0m";
-        return oss.str();
+        string colored;
+        colored.reserve(msg.size() + MAX_SPAN_OVERHEAD);
+        append(colored, msg, color, modifier);
+        return colored;
     }
 }
 #endif
@@ -0,0 +1,86 @@
+/**
+ * @file archive_main.cpp
+ *
+ * @description
+ * Converts puzzle files between the text format and the binary puzzle
+ * archive (see core/board_archive.h). Boards are converted as they are,
+ * without validation, so a round trip gives back the same boards.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "../core/board_archive.h"
+#include "../core/board_io.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    void usage() {
+        std::cout << "Usage: sudoku_archive pack [--no-solutions] [-b <boards_per_block>] <input.txt> <output.sdka>\n"
+                  << "       sudoku_archive unpack <input.sdka> <output.txt>\n"
+                  << "  pack options:\n"
+                  << "    --no-solutions  Store only the clues, solutions are derived when the board is played.\n"
+                  << "    -b <num>        Boards per independently decodable block. Default = "
+                  << sdkg::BoardArchive::DEFAULT_BOARDS_PER_BLOCK << ".\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    std::streamoff file_size( const string &path ) {
+        std::ifstream file{ path, std::ios::binary | std::ios::ate };
+        return file ? (std::streamoff) file.tellg() : 0;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    if (argc < 2) usage();
+    string mode{ argv[1] };
+    bool keep_solutions = true;
+    uint32_t boards_per_block = sdkg::BoardArchive::DEFAULT_BOARDS_PER_BLOCK;
+    vector<string> paths;
+    for (int i{2}; i < argc; i++) {
+        string arg{ argv[i] };
+        if (arg == "--no-solutions") keep_solutions = false;
+        else if (arg == "-b" and i + 1 < argc and is_numeric(argv[i + 1])) boards_per_block = (uint32_t) std::stoul(argv[++i]);
+        else if (arg == "-h" or arg == "--help") usage();
+        else paths.push_back(arg);
+    }
+    if (paths.size() != 2 or (mode != "pack" and mode != "unpack")) usage();
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        size_t n_boards = 0;
+        if (mode == "pack") {
+            std::ifstream in{ paths[0] };
+            if (not in) throw std::runtime_error("File could not be opened!\n");
+            sdkg::BoardPool boards;
+            sdkg::SBoard sb;
+            while (sdkg::read_board(in, sb)) boards.push_back(sb);
+            sdkg::BoardArchive::write(paths[1], boards, keep_solutions, boards_per_block);
+            n_boards = boards.size();
+        } else {
+            vector<sdkg::SBoard> boards = sdkg::BoardArchive(paths[0]).read_all();
+            std::ofstream out{ paths[1], std::ios::trunc };
+            if (not out) throw std::runtime_error("File could not be created!\n");
+            for (const sdkg::SBoard &sb : boards) sdkg::write_board(out, sb);
+            n_boards = boards.size();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::streamoff in_size = file_size(paths[0]), out_size = file_size(paths[1]);
+        std::cout << n_boards << " boards, " << in_size << " -> " << out_size << " bytes";
+        if (out_size > 0) std::cout << " (ratio " << (double) in_size / (double) out_size << ")";
+        std::cout << ", " << elapsed.count() << " s\n";
+    } catch (const std::exception &e) {
+        std::cerr << "sudoku_archive: " << e.what();
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/**
+ * @file augment_main.cpp
+ *
+ * @description
+ * Dataset augmentation: reads puzzles and writes, for every one of them, M
+ * variants made by validity preserving transforms (see core/board_transform.h).
+ *
+ * The input is streamed in batches through a fixed ring of slots: the main
+ * thread reads a batch into a free slot, worker threads transform and format
+ * it into the slot's fixed-size output buffer, and a writer thread writes the
+ * slots back in input order. Memory use does not depend on the input size.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "../core/board_io.h"
+#include "../core/board_transform.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    constexpr size_t CHUNK_SIZE{ 1u << 20 };    //!< Output buffer of a slot, in bytes.
+
+    /// Augmentation options read from the command line.
+    struct AugmentOptions {
+        string input_filename;
+        string output_filename;                   //!< "-" for the standard output.
+        size_t variants = 10;                     //!< Variants written per input puzzle.
+        size_t threads = std::thread::hardware_concurrency();
+        uint64_t seed = 42;
+        unsigned kinds = sdkg::BoardTransform::ALL;
+        bool keep_original = false;               //!< Also write each input puzzle before its variants.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_augment [-m <variants>] [-t <threads>] [--seed <num>] [--transforms <list>]\n"
+                  << "                      [--keep-original] <input_puzzle_file> <output_file | ->\n"
+                  << "  Options:\n"
+                  << "    -m <num>            Variants per puzzle. Default = 10.\n"
+                  << "    -t <num>            Worker threads. Default = # of cores.\n"
+                  << "    --seed <num>        Base seed; a variant only depends on it, its puzzle and its index.\n"
+                  << "    --transforms <list> Comma separated kinds among relabel, bands, stacks, rows, columns,\n"
+                  << "                        rotate, transpose, or all. Default = all.\n"
+                  << "    --keep-original     Write every input puzzle before its variants.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        return std::stoul(argv[++i]);
+    }
+
+    AugmentOptions read_cli_options( int argc, char **argv ) {
+        AugmentOptions opt;
+        vector<string> paths;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "-m") opt.variants = read_number(argc, argv, i);
+            else if (arg == "-t") opt.threads = read_number(argc, argv, i);
+            else if (arg == "--seed") opt.seed = read_number(argc, argv, i);
+            else if (arg == "--keep-original") opt.keep_original = true;
+            else if (arg == "--transforms" and i + 1 < argc) {
+                try {
+                    opt.kinds = sdkg::BoardTransform::parse_kinds(argv[++i]);
+                } catch (const std::exception &e) {
+                    std::cerr << e.what() << "\n";
+                    exit( EXIT_FAILURE );
+                }
+            }
+            else if (arg == "-h" or arg == "--help") usage();
+            else paths.push_back(arg);
+        }
+        if (paths.size() != 2) usage();
+        opt.input_filename = paths[0];
+        opt.output_filename = paths[1];
+        if (opt.threads == 0) opt.threads = 1;
+        return opt;
+    }
+
+    /// One batch moving through the pipeline.
+    struct Slot {
+        enum state_e { FREE, READ, DONE } state = FREE;
+        vector<sdkg::SBoard> boards;        //!< Input puzzles, capacity fixed at startup.
+        size_t n_boards = 0;
+        uint64_t first_puzzle = 0;          //!< Index of boards[0] in the input.
+        vector<char> text;                  //!< Formatted variants, CHUNK_SIZE bytes.
+        size_t text_size = 0;
+    };
+
+    /// Fixed ring of slots shared by the reader, the workers and the writer.
+    class Pipeline {
+        private:
+            const AugmentOptions &m_opt;
+            vector<Slot> m_slots;
+            std::mutex m_mutex;
+            std::condition_variable m_changed;
+            size_t m_next_read = 0;       //!< Next batch the reader fills.
+            size_t m_next_work = 0;       //!< Next batch a worker takes.
+            size_t m_next_write = 0;      //!< Next batch the writer writes.
+            bool m_input_done = false;
+            bool m_failed = false;
+
+            Slot & slot( size_t seq ) { return m_slots[seq % m_slots.size()]; }
+
+            void transform( Slot &s ) const {
+                sdkg::SBoard variant;
+                char *out = s.text.data();
+                for (size_t b{0}; b < s.n_boards; b++) {
+                    uint64_t puzzle = s.first_puzzle + b;
+                    if (m_opt.keep_original) out += sdkg::format_board(s.boards[b], out);
+                    for (size_t v{0}; v < m_opt.variants; v++) {
+                        sdkg::BoardTransform::random(sdkg::BoardTransform::variant_seed(m_opt.seed, puzzle, v), m_opt.kinds).apply(s.boards[b], variant);
+                        out += sdkg::format_board(variant, out);
+                    }
+                }
+                s.text_size = (size_t) (out - s.text.data());
+            }
+
+        public:
+            Pipeline( const AugmentOptions &opt, size_t batch ) : m_opt{opt}, m_slots(2 * opt.threads + 2) {
+                for (Slot &s : m_slots) {
+                    s.boards.resize(batch);
+                    s.text.resize(CHUNK_SIZE);
+                }
+            }
+
+            /// Main thread: streams the input into the ring. Returns the # of puzzles read.
+            size_t read( std::istream &in ) {
+                size_t total = 0;
+                bool more = true;
+                while (more) {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_changed.wait(lock, [this]() { return slot(m_next_read).state == Slot::FREE or m_failed; });
+                    if (m_failed) break;
+                    Slot &s = slot(m_next_read);
+                    lock.unlock();
+
+                    s.n_boards = 0;
+                    s.first_puzzle = total;
+                    try {
+                        while (s.n_boards < s.boards.size() and (more = sdkg::read_board(in, s.boards[s.n_boards]))) s.n_boards++;
+                    } catch (const std::exception &e) {
+                        std::cerr << "Malformed board after puzzle #" << total + s.n_boards << ", input ends here.\n";
+                        more = false;
+                    }
+                    total += s.n_boards;
+
+                    lock.lock();
+                    if (s.n_boards > 0) {
+                        s.state = Slot::READ;
+                        m_next_read++;
+                    }
+                    m_changed.notify_all();
+                }
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_input_done = true;
+                m_changed.notify_all();
+                return total;
+            }
+
+            /// Worker threads: transform batches until the input is exhausted.
+            void work() {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (true) {
+                    m_changed.wait(lock, [this]() { return m_next_work < m_next_read or m_input_done or m_failed; });
+                    if (m_next_work == m_next_read) return;
+                    Slot &s = slot(m_next_work++);
+                    lock.unlock();
+                    transform(s);
+                    lock.lock();
+                    s.state = Slot::DONE;
+                    m_changed.notify_all();
+                }
+            }
+
+            /// Writer thread: writes the batches in input order. Returns the # of bytes written.
+            size_t write( std::ostream &out ) {
+                size_t bytes = 0;
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (true) {
+                    m_changed.wait(lock, [this]() {
+                        return slot(m_next_write).state == Slot::DONE or (m_input_done and m_next_write == m_next_read);
+                    });
+                    if (slot(m_next_write).state != Slot::DONE) return bytes;
+                    Slot &s = slot(m_next_write);
+                    lock.unlock();
+                    out.write(s.text.data(), (std::streamsize) s.text_size);
+                    bytes += s.text_size;
+                    lock.lock();
+                    if (not out) {
+                        m_failed = true;
+                        m_changed.notify_all();
+                        return bytes;
+                    }
+                    s.state = Slot::FREE;
+                    m_next_write++;
+                    m_changed.notify_all();
+                }
+            }
+
+            bool failed() const { return m_failed; }
+    };
+}
+
+int main( int argc, char ** argv )
+{
+    AugmentOptions opt = read_cli_options(argc, argv);
+    size_t boards_out = opt.variants + (opt.keep_original ? 1 : 0);
+    if (boards_out == 0) usage();
+    // as many puzzles per batch as fit the output buffer
+    size_t batch = CHUNK_SIZE / (boards_out * sdkg::MAX_BOARD_TEXT);
+    if (batch == 0) {
+        std::cerr << "Too many variants per puzzle, at most " << CHUNK_SIZE / sdkg::MAX_BOARD_TEXT << " fit a batch.\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream input{ opt.input_filename };
+    if (not input) {
+        std::cerr << "Could not open \"" << opt.input_filename << "\".\n";
+        return EXIT_FAILURE;
+    }
+    std::ofstream file;
+    if (opt.output_filename != "-") {
+        file.open(opt.output_filename, std::ios::binary | std::ios::trunc);
+        if (not file) {
+            std::cerr << "Could not create \"" << opt.output_filename << "\".\n";
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream &output = opt.output_filename == "-" ? std::cout : file;
+
+    auto start = std::chrono::steady_clock::now();
+    Pipeline pipeline{ opt, batch };
+    size_t bytes = 0;
+    std::thread writer([&pipeline, &output, &bytes]() { bytes = pipeline.write(output); });
+    vector<std::thread> workers;
+    for (size_t t{0}; t < opt.threads; t++) workers.emplace_back(&Pipeline::work, &pipeline);
+    size_t puzzles = pipeline.read(input);
+    for (std::thread &worker : workers) worker.join();
+    writer.join();
+    output.flush();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (pipeline.failed() or not output) {
+        std::cerr << "Write error on \"" << opt.output_filename << "\".\n";
+        return EXIT_FAILURE;
+    }
+    std::cerr << puzzles << " puzzles read, " << puzzles * boards_out << " boards written ("
+              << (double) bytes / (1 << 20) << " MiB) in " << elapsed.count() << " s, "
+              << (elapsed.count() > 0 ? (double) puzzles * boards_out / elapsed.count() : 0.0) << " boards/s\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,348 @@
+/**
+ * @file batch_main.cpp
+ *
+ * @description
+ * Long running batch jobs over a puzzle file: solve every puzzle, validate
+ * every board, or write augmented variants. Jobs save a checkpoint (input
+ * offset, durable output size and counters, see core/checkpoint.h) every few
+ * records; a killed or interrupted job run again with the same arguments
+ * resumes from its last checkpoint instead of starting over.
+ *
+ * Malformed boards are counted and skipped, they never stop the job.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+using std::string;
+#include <thread>
+#include <unistd.h>
+#include <vector>
+using std::vector;
+
+#include "../core/batch_validator.h"
+#include "../core/board_io.h"
+#include "../core/board_pool.h"
+#include "../core/board_transform.h"
+#include "../core/checkpoint.h"
+#include "../core/sudoku_solver.h"
+#include "../core/work_stealing_pool.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    constexpr size_t BATCH_SIZE{ 4096 };    //!< Records read, processed and written at once.
+    constexpr size_t CHUNK_SIZE{ 256 };     //!< Records per pool task.
+    constexpr int EXIT_INTERRUPTED{ 3 };    //!< Exit code of a job stopped by a signal, resumable.
+
+    volatile std::sig_atomic_t g_stop = 0;
+
+    void on_signal( int ) { g_stop = 1; }
+
+    /// Batch options read from the command line.
+    struct BatchOptions {
+        string mode;                    //!< solve, validate or augment.
+        string input_filename;
+        string output_filename;
+        string checkpoint_filename;     //!< Default: <output>.ckpt
+        size_t every = 100000;          //!< Records between checkpoints.
+        size_t threads = std::thread::hardware_concurrency();
+        size_t variants = 10;           //!< augment: variants per puzzle.
+        uint64_t seed = 42;             //!< augment: base seed.
+        string transforms{ "all" };     //!< augment: transform kinds.
+        bool restart = false;           //!< Ignore an existing checkpoint.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_batch solve|validate|augment [options] <input_puzzle_file> <output_file>\n"
+                  << "  Modes:\n"
+                  << "    solve      Write every solvable puzzle with its solution (hidden values negative).\n"
+                  << "    validate   Write one line per board: <record #> complete|puzzle|invalid.\n"
+                  << "    augment    Write <variants> transformed variants of every puzzle (see sudoku_augment).\n"
+                  << "  Options:\n"
+                  << "    --checkpoint <path>  Checkpoint file. Default = <output_file>.ckpt\n"
+                  << "    --every <num>        Records between checkpoints. Default = 100000.\n"
+                  << "    --restart            Start over even if a checkpoint exists.\n"
+                  << "    -t <num>             Worker threads. Default = # of cores.\n"
+                  << "    -m <num>             augment: variants per puzzle. Default = 10.\n"
+                  << "    --seed <num>         augment: base seed. Default = 42.\n"
+                  << "    --transforms <list>  augment: transform kinds. Default = all.\n"
+                  << "  An interrupted job (exit code " << EXIT_INTERRUPTED << ") resumes when run again with the same arguments.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        return std::stoul(argv[++i]);
+    }
+
+    BatchOptions read_cli_options( int argc, char **argv ) {
+        BatchOptions opt;
+        vector<string> paths;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "--every") opt.every = read_number(argc, argv, i);
+            else if (arg == "-t") opt.threads = read_number(argc, argv, i);
+            else if (arg == "-m") opt.variants = read_number(argc, argv, i);
+            else if (arg == "--seed") opt.seed = read_number(argc, argv, i);
+            else if (arg == "--restart") opt.restart = true;
+            else if (arg == "--checkpoint" and i + 1 < argc) opt.checkpoint_filename = argv[++i];
+            else if (arg == "--transforms" and i + 1 < argc) opt.transforms = argv[++i];
+            else if (arg == "-h" or arg == "--help") usage();
+            else if (opt.mode.empty()) opt.mode = arg;
+            else paths.push_back(arg);
+        }
+        if (paths.size() != 2 or (opt.mode != "solve" and opt.mode != "validate" and opt.mode != "augment")) usage();
+        opt.input_filename = paths[0];
+        opt.output_filename = paths[1];
+        if (opt.checkpoint_filename.empty()) opt.checkpoint_filename = opt.output_filename + ".ckpt";
+        if (opt.threads == 0) opt.threads = 1;
+        if (opt.every == 0) opt.every = 1;
+        return opt;
+    }
+
+    /// What a checkpoint must match to be resumed: everything that changes the output.
+    string job_of( const BatchOptions &opt ) {
+        string job = opt.mode + " input=" + opt.input_filename;
+        if (opt.mode == "augment") {
+            job += " variants=" + std::to_string(opt.variants) + " seed=" + std::to_string(opt.seed) +
+                   " transforms=" + opt.transforms;
+        }
+        return job;
+    }
+
+    /// Append-only output whose content past the last checkpoint is discarded on resume.
+    class OutputFile {
+        private:
+            int m_fd = -1;
+            string m_path;
+            uint64_t m_offset = 0;
+
+            [[noreturn]] void fail( const string &what ) const {
+                throw std::runtime_error(what + " \"" + m_path + "\": " + std::strerror(errno));
+            }
+
+        public:
+            /// Opens the output keeping its first `offset` bytes.
+            OutputFile( const string &path, uint64_t offset ) : m_path{path}, m_offset{offset} {
+                m_fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+                if (m_fd < 0) fail("cannot open");
+                if (ftruncate(m_fd, (off_t) offset) != 0 or lseek(m_fd, (off_t) offset, SEEK_SET) < 0) fail("cannot truncate");
+            }
+
+            ~OutputFile() { if (m_fd >= 0) close(m_fd); }
+            OutputFile & operator=( const OutputFile & ) = delete;
+            OutputFile( const OutputFile & ) = delete;
+
+            void append( const char *data, size_t size ) {
+                for (size_t done{0}; done < size; ) {
+                    ssize_t n = write(m_fd, data + done, size - done);
+                    if (n < 0 and errno == EINTR) continue;
+                    if (n <= 0) fail("cannot write");
+                    done += (size_t) n;
+                }
+                m_offset += size;
+            }
+
+            /// Makes everything appended so far durable, returns the durable size.
+            uint64_t sync() {
+                if (fdatasync(m_fd) != 0) fail("cannot sync");
+                return m_offset;
+            }
+    };
+
+    /// Output and counters of one chunk of records.
+    struct ChunkResult {
+        string text;
+        std::map<string, uint64_t> counters;
+    };
+
+    /// Processes records [first, first + n) of a batch.
+    class Processor {
+        private:
+            const BatchOptions &m_opt;
+            unsigned m_kinds;
+
+            void solve( const sdkg::SBoard &puzzle, ChunkResult &r ) const {
+                sdkg::SudokuSolver solver{ puzzle };
+                sdkg::SBoard solution;
+                if (not solver.is_consistent() or not solver.solve(solution)) {
+                    r.counters["unsolvable"]++;
+                    return;
+                }
+                sdkg::SBoard out;
+                for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+                    for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                        short clue = puzzle.at(i, j);
+                        out.set_loc(i, j, clue > 0 ? clue : (short) -solution.at(i, j));
+                    }
+                }
+                char text[sdkg::MAX_BOARD_TEXT];
+                r.text.append(text, sdkg::format_board(out, text));
+                r.counters["solved"]++;
+            }
+
+            void validate( const sdkg::BoardPool &boards, size_t begin, size_t n, uint64_t first_record, ChunkResult &r ) const {
+                constexpr size_t BOARD_BYTES{ sdkg::BoardPool::BOARD_BYTES };
+                for (size_t first{0}; first < n; first += sdkg::BatchValidator::LANES) {
+                    size_t lanes = std::min(sdkg::BatchValidator::LANES, n - first);
+                    int8_t checked[sdkg::BatchValidator::LANES * BOARD_BYTES];
+                    bool blanks[sdkg::BatchValidator::LANES]{};
+                    // hidden values count as placed, blanks only need to be consistent
+                    boards.scan(begin + first, begin + first + lanes, [&]( size_t idx, sdkg::BoardView board ) {
+                        size_t l = idx - begin - first;
+                        const int8_t *cells = board.cells();
+                        for (size_t k{0}; k < BOARD_BYTES; k++) {
+                            checked[l * BOARD_BYTES + k] = (int8_t) (cells[k] < 0 ? -cells[k] : cells[k]);
+                            blanks[l] = blanks[l] or cells[k] == 0;
+                        }
+                    });
+                    sdkg::BatchValidator::Result result = sdkg::BatchValidator::validate(checked, lanes);
+                    for (size_t l{0}; l < lanes; l++) {
+                        const char *status = "invalid";
+                        if ((result.complete >> l) & 1u) status = "complete";
+                        else if (blanks[l] and ((result.consistent >> l) & 1u)) status = "puzzle";
+                        r.counters[status]++;
+                        r.text += std::to_string(first_record + first + l) + " " + status + "\n";
+                    }
+                }
+            }
+
+            void augment( const sdkg::SBoard &puzzle, uint64_t record, ChunkResult &r ) const {
+                sdkg::SBoard variant;
+                char text[sdkg::MAX_BOARD_TEXT];
+                for (size_t v{0}; v < m_opt.variants; v++) {
+                    sdkg::BoardTransform::random(sdkg::BoardTransform::variant_seed(m_opt.seed, record, v), m_kinds).apply(puzzle, variant);
+                    r.text.append(text, sdkg::format_board(variant, text));
+                }
+                r.counters["variants"] += m_opt.variants;
+            }
+
+        public:
+            Processor( const BatchOptions &opt, unsigned kinds ) : m_opt{opt}, m_kinds{kinds} {}
+
+            void run( const sdkg::BoardPool &boards, size_t first, size_t n, uint64_t first_record, ChunkResult &r ) const {
+                if (m_opt.mode == "validate") {
+                    validate(boards, first, n, first_record, r);
+                    return;
+                }
+                sdkg::SBoard puzzle;
+                boards.scan(first, first + n, [&]( size_t idx, sdkg::BoardView board ) {
+                    board.copy_to(puzzle);
+                    if (m_opt.mode == "solve") solve(puzzle, r);
+                    else augment(puzzle, first_record + (idx - first), r);
+                });
+            }
+    };
+
+    /// Offset of the next unread byte, also once the stream hit its end.
+    uint64_t input_position( std::ifstream &in ) {
+        if (in.good()) return (uint64_t) in.tellg();
+        in.clear();
+        in.seekg(0, std::ios::end);
+        return (uint64_t) in.tellg();
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    BatchOptions opt = read_cli_options(argc, argv);
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    try {
+        unsigned kinds = sdkg::BoardTransform::parse_kinds(opt.transforms);
+        sdkg::Checkpoint cp;
+        string job = job_of(opt);
+        bool resumed = not opt.restart and sdkg::Checkpoint::load(opt.checkpoint_filename, cp);
+        if (resumed and cp.job != job) {
+            std::cerr << "Checkpoint \"" << opt.checkpoint_filename << "\" belongs to another job (" << cp.job
+                      << "), use --restart to start over.\n";
+            return EXIT_FAILURE;
+        }
+        if (not resumed) {
+            cp = sdkg::Checkpoint();
+            cp.job = job;
+        }
+
+        std::ifstream input{ opt.input_filename, std::ios::binary };
+        if (not input) throw std::runtime_error("cannot open \"" + opt.input_filename + "\"");
+        input.seekg((std::streamoff) cp.input_offset);
+        OutputFile output{ opt.output_filename, cp.output_offset };
+        if (resumed) {
+            std::cerr << "Resuming at record " << cp.records << " (input byte " << cp.input_offset << ").\n";
+        }
+
+        Processor processor{ opt, kinds };
+        sdkg::WorkStealingPool pool{ (unsigned) opt.threads };
+        sdkg::BoardPool boards;
+        boards.reserve(BATCH_SIZE);
+        sdkg::SBoard sb;
+        vector<ChunkResult> chunks((BATCH_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        uint64_t saved_records = cp.records;
+        auto start = std::chrono::steady_clock::now();
+        bool more = true;
+
+        while (more and not g_stop) {
+            boards.clear();
+            while (boards.size() < BATCH_SIZE and more) {
+                sdkg::read_status_e status = sdkg::try_read_board(input, sb);
+                if (status == sdkg::BOARD_READ and not sdkg::BoardPool::fits(sb)) status = sdkg::BOARD_MALFORMED;
+                if (status == sdkg::BOARD_MALFORMED) cp.counters["malformed"]++;
+                else if (status == sdkg::BOARD_READ) boards.push_back(sb);
+                more = status != sdkg::END_OF_INPUT;
+            }
+            size_t n = boards.size();
+            cp.input_offset = input_position(input);
+
+            size_t n_chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            for (size_t c{0}; c < n_chunks; c++) {
+                chunks[c] = ChunkResult();
+                pool.submit([&, c]() {
+                    size_t first = c * CHUNK_SIZE;
+                    processor.run(boards, first, std::min(CHUNK_SIZE, n - first), cp.records + first, chunks[c]);
+                });
+            }
+            pool.wait();
+            for (size_t c{0}; c < n_chunks; c++) {
+                output.append(chunks[c].text.data(), chunks[c].text.size());
+                for (const auto &counter : chunks[c].counters) cp.counters[counter.first] += counter.second;
+            }
+            cp.records += n;
+
+            if (cp.records - saved_records >= opt.every or g_stop or not more) {
+                cp.output_offset = output.sync();
+                cp.save(opt.checkpoint_filename);
+                saved_records = cp.records;
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cerr << cp.records << " records";
+        for (const auto &counter : cp.counters) std::cerr << ", " << counter.second << " " << counter.first;
+        std::cerr << " (" << elapsed.count() << " s this run)\n";
+        if (g_stop) {
+            std::cerr << "Interrupted, run the same command again to resume.\n";
+            return EXIT_INTERRUPTED;
+        }
+        // the job is complete, a new run starts from scratch
+        std::remove(opt.checkpoint_filename.c_str());
+    } catch (const std::exception &e) {
+        std::cerr << "sudoku_batch: " << e.what() << "\n"
+                  << "The last checkpoint, if any, is kept: run the same command again to resume.\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
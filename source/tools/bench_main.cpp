@@ -0,0 +1,651 @@
+/**
+ * @file bench_main.cpp
+ *
+ * @description
+ * Micro-benchmarks of the hot paths of the game core.
+ *
+ *   sudoku_bench validate [-n <boards>]   Batch validation throughput (BatchValidator).
+ *   sudoku_bench anneal [-n <max_box>]     Annealing vs exact backtracking on 9x9 up to large boards.
+ *   sudoku_bench cp [-n <puzzles>]         CP solver vs exact backtracking on hard and minimal 9x9 puzzles.
+ *   sudoku_bench variants [-n <puzzles>]   Solver throughput per variant rule set.
+ *   sudoku_bench pool [-n <boards>]        Full scans of a BoardPool vs a vector of SBoard.
+ *   sudoku_bench queue [-n <puzzles>]      Lock-free MPMC queue vs a locked deque under contention.
+ *   sudoku_bench errors [-n <calls>]       Cost of rejecting bad input: exceptions vs returned errors.
+ *   sudoku_bench color [-n <spans>]        Colored text: ostringstream vs the escape table and buffer writer.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "../core/annealing_solver.h"
+#include "../core/batch_validator.h"
+#include "../core/board_io.h"
+#include "../core/board_pool.h"
+#include "../core/cp_solver.h"
+#include "../core/large_board.h"
+#include "../core/sudoku_solver.h"
+#include "../core/puzzle_feed.h"
+#include "../core/sudoku_board.h"
+#include "../core/variant_rules.h"
+#include "../lib/mpmc_queue.h"
+#include "../lib/text_color.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    void usage() {
+        std::cout << "Usage: sudoku_bench <benchmark> [-n <iterations>] [-t <threads>] [--timeout <seconds>]\n"
+                  << "  Benchmarks:\n"
+                  << "    validate   Batch validation of packed and SBoard boards.\n"
+                  << "    anneal     Simulated annealing vs exact backtracking, box sizes 3 to n (default 5),\n"
+                  << "               each solver stopped after --timeout seconds (default 20).\n"
+                  << "    cp         CP solver vs backtracking, on well-known hard puzzles and n generated\n"
+                  << "               minimal puzzles (default 200).\n"
+                  << "    variants   Solving and uniqueness proofs of n puzzles (default 100) per variant rule\n"
+                  << "               set: classic, diagonal, anti-knight, jigsaw, killer.\n"
+                  << "    pool       Full scans (clue-only check, validation) of n boards (default 1M) stored\n"
+                  << "               as a vector of SBoard and as a packed BoardPool, against a plain read.\n"
+                  << "    queue      n puzzles (default 1M) passed through the PuzzleFeed queue and a locked deque,\n"
+                  << "               by half producers and half consumers, 2 to t threads (default 64).\n"
+                  << "    errors     n calls (default 1M) of the digit check, the token parser and the board\n"
+                  << "               selection, with good and bad input, throwing vs returning the error.\n"
+                  << "    color      n colored spans (default 1M), the size of board digits, formatted with an\n"
+                  << "               ostringstream (as tcolor did), with tcolor and written into a buffer.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    double seconds_since( std::chrono::steady_clock::time_point start ) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// Solved boards built by relabeling the digits of a pattern solution, plus a few broken ones.
+    vector<int8_t> make_packed_boards( size_t n ) {
+        constexpr int N_CELLS{ sdkg::Config::SB_SIZE * sdkg::Config::SB_SIZE };
+        std::mt19937 rng{ 7 };
+        vector<int8_t> cells(n * N_CELLS);
+        int digits[10]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        for (size_t b{0}; b < n; b++) {
+            std::shuffle(digits + 1, digits + 10, rng);
+            for (int r{0}; r < sdkg::Config::SB_SIZE; r++) {
+                for (int c{0}; c < sdkg::Config::SB_SIZE; c++) {
+                    cells[b * N_CELLS + r * 9 + c] = (int8_t) digits[(r * 3 + r / 3 + c) % 9 + 1];
+                }
+            }
+            if (b % 16 == 0) cells[b * N_CELLS + 40] = cells[b * N_CELLS + 41];   // break some of them
+        }
+        return cells;
+    }
+
+    void bench_validate( size_t n ) {
+        constexpr size_t N_CELLS{ sdkg::Config::SB_SIZE * sdkg::Config::SB_SIZE };
+        vector<int8_t> packed = make_packed_boards(n);
+        vector<sdkg::SBoard> boards(n);
+        for (size_t b{0}; b < n; b++) {
+            for (size_t k{0}; k < N_CELLS; k++) boards[b].set_loc((short) (k / 9), (short) (k % 9), packed[b * N_CELLS + k]);
+        }
+
+        size_t valid = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t b{0}; b < n; b += sdkg::BatchValidator::LANES) {
+            valid += __builtin_popcount(sdkg::BatchValidator::validate(packed.data() + b * N_CELLS,
+                                                                       std::min(sdkg::BatchValidator::LANES, n - b)).complete);
+        }
+        double packed_s = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t b{0}; b < n; b += sdkg::BatchValidator::LANES) {
+            valid += __builtin_popcount(sdkg::BatchValidator::validate(boards.data() + b,
+                                                                       std::min(sdkg::BatchValidator::LANES, n - b)).complete);
+        }
+        double sboard_s = seconds_since(start);
+
+        std::cout << "kernel: " << sdkg::BatchValidator::kernel_name() << ", " << n << " boards, "
+                  << valid / 2 << " valid\n"
+                  << "  packed input: " << n / packed_s / 1e6 << " M boards/s\n"
+                  << "  SBoard input: " << n / sboard_s / 1e6 << " M boards/s\n";
+    }
+
+    void bench_pool( size_t n ) {
+        constexpr size_t N_CELLS{ sdkg::BoardPool::BOARD_BYTES };
+        constexpr size_t LANES{ sdkg::BatchValidator::LANES };
+        vector<int8_t> packed = make_packed_boards(n);
+        vector<sdkg::SBoard> boards(n);
+        sdkg::BoardPool pool;
+        pool.reserve(n);
+        for (size_t b{0}; b < n; b++) {
+            for (size_t k{0}; k < N_CELLS; k++) boards[b].set_loc((short) (k / 9), (short) (k % 9), packed[b * N_CELLS + k]);
+            if (b % 3 == 0) boards[b].set_loc(8, 8, 0);     // some clue-only boards
+            pool.push_back(boards[b]);
+        }
+        packed = vector<int8_t>();
+        auto report = [n]( const char *name, double seconds, size_t bytes_per_board, size_t found ) {
+            std::cout << "  " << name << (double) n / seconds / 1e6 << " M boards/s, "
+                      << (double) (n * bytes_per_board) / seconds / 1e9 << " GB/s (" << found << ")\n";
+        };
+        std::cout << n << " boards, SBoard " << sizeof(sdkg::SBoard) << " bytes, pooled " << N_CELLS << " bytes\n";
+
+        // the memory bound: every byte of the pool read once
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sum = 0;
+        const auto *words = (const uint64_t *) pool.data();
+        for (size_t w{0}; w < n * N_CELLS / sizeof(uint64_t); w++) sum += words[w];
+        report("plain read:              ", seconds_since(start), N_CELLS, (size_t) (sum & 0xFF));
+
+        std::cout << "clue-only boards:\n";
+        start = std::chrono::steady_clock::now();
+        size_t blanks = 0;
+        for (size_t b{0}; b < n; b++) {
+            sdkg::SBoard board_chosen{ boards[b] };     // the copy every lookup used to make
+            bool blank = false;
+            for (short i{0}; i < sdkg::Config::SB_SIZE and not blank; i++) {
+                for (short j{0}; j < sdkg::Config::SB_SIZE and not blank; j++) blank = board_chosen.at(i, j) == 0;
+            }
+            blanks += blank;
+        }
+        report("vector<SBoard> + copy:   ", seconds_since(start), sizeof(sdkg::SBoard), blanks);
+
+        start = std::chrono::steady_clock::now();
+        blanks = 0;
+        for (size_t b{0}; b < n; b++) blanks += pool[b].has_blanks();
+        report("BoardPool, no prefetch:  ", seconds_since(start), N_CELLS, blanks);
+
+        start = std::chrono::steady_clock::now();
+        blanks = 0;
+        pool.scan(0, n, [&blanks]( size_t, sdkg::BoardView board ) { blanks += board.has_blanks(); });
+        report("BoardPool scan:          ", seconds_since(start), N_CELLS, blanks);
+
+        std::cout << "validation:\n";
+        size_t valid = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t b{0}; b < n; b += LANES) {
+            valid += __builtin_popcount(sdkg::BatchValidator::validate(boards.data() + b, std::min(LANES, n - b)).consistent);
+        }
+        report("vector<SBoard>:          ", seconds_since(start), sizeof(sdkg::SBoard), valid);
+
+        valid = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t b{0}; b < n; b += LANES) {
+            for (size_t ahead{b + LANES}; ahead < std::min(b + 2 * LANES, n); ahead++) pool.prefetch(ahead);
+            valid += __builtin_popcount(sdkg::BatchValidator::validate(pool.data(b), std::min(LANES, n - b)).consistent);
+        }
+        report("BoardPool, in place:     ", seconds_since(start), N_CELLS, valid);
+    }
+
+    /// The baseline of the queue benchmark: a deque bounded like the MpmcQueue, behind a mutex.
+    template <typename T, size_t Capacity>
+    class LockedQueue {
+        private:
+            std::mutex m_mutex;
+            std::deque<T> m_values;
+
+        public:
+            bool try_push( const T &value ) {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if (m_values.size() == Capacity) return false;
+                m_values.push_back(value);
+                return true;
+            }
+
+            bool try_pop( T &value ) {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                if (m_values.empty()) return false;
+                value = m_values.front();
+                m_values.pop_front();
+                return true;
+            }
+    };
+
+    /// Puzzles passed from `threads / 2` producers to as many consumers through the queue, per second.
+    template <typename Queue>
+    double run_queue( size_t n, unsigned threads ) {
+        Queue queue;
+        unsigned producers = std::max(1u, threads / 2), consumers = std::max(1u, threads - producers);
+        std::atomic<size_t> consumed{ 0 };
+        std::atomic<uint64_t> checksum{ 0 };
+        vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned p{0}; p < producers; p++) {
+            workers.emplace_back([&queue, n, p, producers]() {
+                sdkg::ReadyPuzzle puzzle{};
+                for (size_t k{p}; k < n; k += producers) {
+                    puzzle.cells[0] = (int8_t) (k % 9 + 1);
+                    while (not queue.try_push(puzzle)) std::this_thread::yield();
+                }
+            });
+        }
+        for (unsigned c{0}; c < consumers; c++) {
+            workers.emplace_back([&queue, &consumed, &checksum, n]() {
+                sdkg::ReadyPuzzle puzzle;
+                uint64_t sum = 0;
+                while (consumed.load(std::memory_order_relaxed) < n) {
+                    if (not queue.try_pop(puzzle)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    sum += (uint64_t) puzzle.cells[0];
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                }
+                checksum.fetch_add(sum);
+            });
+        }
+        for (std::thread &worker : workers) worker.join();
+        double seconds = seconds_since(start);
+        if (checksum.load() == 0 and n != 0) std::cerr << "queue lost every puzzle!\n";
+        return (double) n / seconds;
+    }
+
+    void bench_queue( size_t n, unsigned max_threads ) {
+        constexpr size_t CAPACITY{ sdkg::PuzzleFeed::CAPACITY };
+        std::cout << n << " puzzles of " << sizeof(sdkg::ReadyPuzzle) << " bytes, capacity " << CAPACITY
+                  << ", " << std::thread::hardware_concurrency() << " cores\n"
+                  << "  threads    MpmcQueue       mutex + deque\n";
+        for (unsigned threads{2}; threads <= max_threads; threads *= 2) {
+            double lock_free = run_queue<MpmcQueue<sdkg::ReadyPuzzle, CAPACITY>>(n, threads);
+            double locked = run_queue<LockedQueue<sdkg::ReadyPuzzle, CAPACITY>>(n, threads);
+            std::cout << "  " << std::setw(7) << threads << std::fixed << std::setprecision(2)
+                      << std::setw(10) << lock_free / 1e6 << " M/s" << std::setw(15) << locked / 1e6 << " M/s  (x"
+                      << lock_free / locked << ")\n" << std::defaultfloat;
+        }
+    }
+
+    /// Nanoseconds per call of `call(k)`, which returns whether the input was accepted.
+    template <typename Call>
+    double ns_per_call( size_t n, size_t &accepted, Call call ) {
+        accepted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t k{0}; k < n; k++) accepted += call(k);
+        return seconds_since(start) * 1e9 / (double) n;
+    }
+
+    void bench_errors( size_t n ) {
+        using Manager = sdkg::SBoardManager;
+        Manager sbm;    // no board read: every index is bad
+        const vector<string> good_tokens{ "1", "5", "9", "7" }, bad_tokens{ "x", "10", "-3", "" };
+        std::cout << n << " calls each, ns per call (accepted calls)\n"
+                  << "                            throwing           returned error\n";
+        auto report = []( const char *name, double thrown, size_t thrown_ok, double returned, size_t returned_ok ) {
+            std::cout << "  " << name << std::fixed << std::setprecision(1) << std::setw(8) << thrown << " (" << thrown_ok
+                      << ")" << std::setw(12) << returned << " (" << returned_ok << ")\n" << std::defaultfloat;
+        };
+        // digits drawn at run time, so the checks are not folded away
+        std::mt19937 rng{ 7 };
+        vector<short> good_digits(1024), bad_digits(1024);
+        for (short &d : good_digits) d = (short) (rng() % 9 + 1);
+        for (short &d : bad_digits) d = (short) (rng() % 2 ? rng() % 90 + 10 : -(short) (rng() % 10));
+        size_t a = 0, b = 0;
+        double t = 0, r = 0;
+
+        for (const char *input : { "good", "bad" }) {
+            bool good = string{input} == "good";
+            const vector<string> &tokens = good ? good_tokens : bad_tokens;
+            const vector<short> &digits = good ? good_digits : bad_digits;
+            std::cout << input << " input:\n";
+            t = ns_per_call(n, a, [&sbm, &digits]( size_t k ) {
+                try {
+                    return sbm.is_valid_sudoku_digit(digits[k % digits.size()]);
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            });
+            r = ns_per_call(n, b, [&digits]( size_t k ) {
+                return Manager::check_sudoku_digit(digits[k % digits.size()]).has_value();
+            });
+            report("digit check:          ", t, a, r, b);
+
+            // how commands were parsed: stoi, then the digit check, both throwing
+            t = ns_per_call(n, a, [&sbm, &tokens]( size_t k ) {
+                try {
+                    return sbm.is_valid_sudoku_digit((short) std::stoi(tokens[k % tokens.size()]));
+                } catch (const std::exception &e) {
+                    return false;
+                }
+            });
+            r = ns_per_call(n, b, [&tokens]( size_t k ) {
+                return Manager::parse_sudoku_digit(tokens[k % tokens.size()]).has_value();
+            });
+            report("token parse:          ", t, a, r, b);
+        }
+
+        std::cout << "bad board index:\n";
+        t = ns_per_call(n, a, [&sbm]( size_t k ) {
+            try {
+                sbm.set_player_board((int) k);
+                return true;
+            } catch (const std::exception &e) {
+                return false;
+            }
+        });
+        r = ns_per_call(n, b, [&sbm]( size_t k ) { return sbm.try_set_player_board((int) k).has_value(); });
+        report("board selection:      ", t, a, r, b);
+    }
+
+    /// How tcolor formatted a span before the escape table, the baseline of the color benchmark.
+    string tcolor_ostringstream( const string &msg, short color, short modifier=Color::REGULAR ) {
+        std::ostringstream oss;
+        oss << "\33[" << modifier << ";" << color << "m" << msg << "\33[0m";
+        return oss.str();
+    }
+
+    void bench_color( size_t n ) {
+        const string digits[]{ "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+        auto report = [n]( const char *name, std::chrono::steady_clock::time_point start, size_t bytes ) {
+            double seconds = seconds_since(start);
+            std::cout << "  " << name << std::fixed << std::setprecision(1) << std::setw(8) << seconds * 1e9 / (double) n
+                      << " ns/span, " << bytes << " bytes\n" << std::defaultfloat;
+        };
+        std::cout << n << " spans of one digit\n";
+
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (size_t k{0}; k < n; k++) bytes += tcolor_ostringstream(digits[k % 9], Color::color_list[k % 14]).size();
+        report("ostringstream:     ", start, bytes);
+
+        start = std::chrono::steady_clock::now();
+        bytes = 0;
+        for (size_t k{0}; k < n; k++) bytes += Color::tcolor(digits[k % 9], Color::color_list[k % 14]).size();
+        report("tcolor (table):    ", start, bytes);
+
+        // a board's worth of spans at a time, as display_player_board writes them
+        char buffer[81 * (1 + Color::MAX_SPAN_OVERHEAD)];
+        volatile char sink = 0;
+        start = std::chrono::steady_clock::now();
+        bytes = 0;
+        for (size_t k{0}; k < n; k += 81) {
+            size_t size = 0;
+            for (size_t s{k}; s < std::min(k + 81, n); s++) size += Color::append(buffer + size, digits[s % 9], Color::color_list[s % 14]);
+            bytes += size;
+            sink = sink + buffer[size / 2];     // keeps the buffer alive
+        }
+        report("append to buffer:  ", start, bytes);
+
+        bool was_enabled = Color::enabled();
+        Color::set_enabled(false);
+        start = std::chrono::steady_clock::now();
+        bytes = 0;
+        for (size_t k{0}; k < n; k += 81) {
+            size_t size = 0;
+            for (size_t s{k}; s < std::min(k + 81, n); s++) size += Color::append(buffer + size, digits[s % 9], Color::color_list[s % 14]);
+            bytes += size;
+            sink = sink + buffer[size / 2];
+        }
+        report("append, no colors: ", start, bytes);
+        Color::set_enabled(was_enabled);
+    }
+
+    /// Runs the exact solver, giving up after `timeout` seconds.
+    sdkg::LargeBacktracker::status_e run_exact( const sdkg::LargeBoard &puzzle, double timeout, size_t &nodes, double &seconds ) {
+        std::atomic<bool> stop{ false };
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        std::thread timer([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (not done.wait_for(lock, std::chrono::duration<double>(timeout), [&]() { return finished; })) stop = true;
+        });
+        auto start = std::chrono::steady_clock::now();
+        sdkg::LargeBacktracker exact{ puzzle, 0, &stop };
+        sdkg::LargeBacktracker::status_e status = exact.solve();
+        seconds = seconds_since(start);
+        nodes = exact.nodes();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        done.notify_all();
+        timer.join();
+        return status;
+    }
+
+    void bench_anneal( short max_box, unsigned threads, double timeout ) {
+        constexpr double KEEP{ 0.45 };   // around the hardest ratio of givens for both kinds of solvers
+        const char *STATUS[]{ "solved", "unsolvable", "gave up" };
+        std::cout << "givens: " << KEEP * 100 << "% of the locations, timeout " << timeout << " s per solver\n";
+        for (short box{3}; box <= max_box; box++) {
+            sdkg::LargeBoard puzzle = sdkg::LargeBoard::random_solution(box, 11 + box).make_puzzle(KEEP, 5 + box);
+            std::cout << puzzle.size() << "x" << puzzle.size() << ":\n";
+
+            size_t nodes = 0;
+            double seconds = 0;
+            sdkg::LargeBacktracker::status_e status = run_exact(puzzle, timeout, nodes, seconds);
+            std::cout << "  exact:     " << STATUS[status] << " in " << seconds << " s, " << nodes << " nodes\n";
+
+            sdkg::AnnealingSolver::Options opt;
+            opt.threads = threads;
+            opt.time_limit = timeout;
+            sdkg::AnnealingSolver::Result r = sdkg::AnnealingSolver(puzzle, opt).solve();
+            std::cout << "  annealing: " << (r.solved ? "solved" : "gave up (cost " + std::to_string(r.cost) + ")")
+                      << " in " << r.seconds << " s, " << r.moves << " moves, " << r.restarts << " restarts\n";
+        }
+    }
+
+    /// Minimal puzzles: the givens of a random solution removed in random order while the solution stays unique.
+    vector<sdkg::SBoard> make_minimal_puzzles( size_t n ) {
+        vector<sdkg::SBoard> puzzles;
+        std::mt19937 rng{ 3 };
+        vector<short> order(sdkg::BoardGeometry::N_CELLS);
+        for (size_t p{0}; p < n; p++) {
+            sdkg::LargeBoard solution = sdkg::LargeBoard::random_solution(3, 100 + p);
+            sdkg::SBoard sb;
+            for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+                for (short j{0}; j < sdkg::Config::SB_SIZE; j++) sb.set_loc(i, j, solution.at(i, j));
+            }
+            for (short k{0}; k < sdkg::BoardGeometry::N_CELLS; k++) order[k] = k;
+            std::shuffle(order.begin(), order.end(), rng);
+            for (short cell : order) {
+                short line = sdkg::GEOMETRY.line[cell], column = sdkg::GEOMETRY.column[cell], digit = sb.at(line, column);
+                sb.set_loc(line, column, 0);
+                if (sdkg::SudokuSolver{ sb }.count_solutions(2) != 1) sb.set_loc(line, column, digit);
+            }
+            puzzles.push_back(sb);
+        }
+        return puzzles;
+    }
+
+    void bench_cp( size_t n ) {
+        // well-known hard puzzles: AI Escargot, Easter Monster
+        const char *HARD[]{
+            "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+            "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+        };
+        vector<sdkg::SBoard> puzzles;
+        for (const char *text : HARD) {
+            std::istringstream in{ text };
+            sdkg::SBoard sb;
+            sdkg::read_board(in, sb);
+            puzzles.push_back(sb);
+        }
+        vector<sdkg::SBoard> minimal = make_minimal_puzzles(n);
+        puzzles.insert(puzzles.end(), minimal.begin(), minimal.end());
+
+        // proving uniqueness (a count up to 2) explores the whole tree, so it shows the pruning best
+        size_t bt_nodes = 0, cp_nodes = 0, cp_failures = 0, mismatches = 0;
+        double bt_s = 0, cp_s = 0;
+        for (size_t p{0}; p < puzzles.size(); p++) {
+            auto start = std::chrono::steady_clock::now();
+            sdkg::SudokuSolver bt{ puzzles[p] };
+            size_t bt_count = bt.count_solutions(2);
+            double bt_p = seconds_since(start);
+            start = std::chrono::steady_clock::now();
+            sdkg::CpSolver cp{ puzzles[p] };
+            size_t cp_count = cp.count_solutions(2);
+            double cp_p = seconds_since(start);
+            sdkg::SBoard bt_solution, cp_solution;
+            sdkg::SudokuSolver{ puzzles[p] }.solve(bt_solution);
+            sdkg::CpSolver{ puzzles[p] }.solve(cp_solution);
+            bool same = true;
+            for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+                for (short j{0}; j < sdkg::Config::SB_SIZE; j++) same = same and bt_solution.at(i, j) == cp_solution.at(i, j);
+            }
+            if (bt_count != cp_count or not same) mismatches++;
+            if (p < std::size(HARD)) {
+                std::cout << "hard #" << p << ": backtracking " << bt.stats().nodes << " nodes, " << bt_p * 1e3 << " ms; cp "
+                          << cp.stats().nodes << " nodes, " << cp.stats().prunings << " prunings, " << cp_p * 1e3 << " ms\n";
+                continue;
+            }
+            bt_nodes += bt.stats().nodes;
+            bt_s += bt_p;
+            cp_nodes += cp.stats().nodes;
+            cp_failures += cp.stats().failures;
+            cp_s += cp_p;
+        }
+        std::cout << n << " minimal puzzles, uniqueness proof per puzzle:\n"
+                  << "  backtracking: " << (double) bt_nodes / (double) n << " nodes, " << bt_s / (double) n * 1e6 << " us\n"
+                  << "  cp:           " << (double) cp_nodes / (double) n << " nodes, " << (double) cp_failures / (double) n
+                  << " failures, " << cp_s / (double) n * 1e6 << " us\n"
+                  << "puzzles where the solvers disagree: " << mismatches << "\n";
+    }
+
+    /// A random solved board under the rules: the first solution of the empty board, digits relabeled
+    /// (relabeling keeps every rule set valid).
+    template < typename Rules >
+    sdkg::SBoard random_solution( const Rules &rules, std::mt19937 &rng ) {
+        sdkg::SBoard first, solution;
+        sdkg::BasicSudokuSolver<Rules>{ sdkg::SBoard{}, rules }.solve(first);
+        short digits[10]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        std::shuffle(digits + 1, digits + 10, rng);
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) solution.set_loc(i, j, digits[first.at(i, j)]);
+        }
+        return solution;
+    }
+
+    /// Removes the givens of a solution in random order, down to `givens`, while its solution stays unique under the rules.
+    template < typename Rules >
+    sdkg::SBoard unique_puzzle( sdkg::SBoard sb, const Rules &rules, std::mt19937 &rng, short givens ) {
+        vector<short> order(sdkg::BoardGeometry::N_CELLS);
+        for (short k{0}; k < sdkg::BoardGeometry::N_CELLS; k++) order[k] = k;
+        std::shuffle(order.begin(), order.end(), rng);
+        short left = sdkg::BoardGeometry::N_CELLS;
+        for (short cell : order) {
+            if (left <= givens) break;
+            short line = sdkg::GEOMETRY.line[cell], column = sdkg::GEOMETRY.column[cell], digit = sb.at(line, column);
+            sb.set_loc(line, column, 0);
+            if (sdkg::BasicSudokuSolver<Rules>{ sb, rules }.count_solutions(2) != 1) sb.set_loc(line, column, digit);
+            else left--;
+        }
+        return sb;
+    }
+
+    /// Cages of 1 to 4 orthogonally connected locations of a solution, holding distinct digits.
+    sdkg::KillerRules random_cages( const sdkg::SBoard &solution, std::mt19937 &rng ) {
+        vector<sdkg::KillerRules::Cage> cages;
+        vector<bool> caged(sdkg::BoardGeometry::N_CELLS, false);
+        auto value_at = [&solution]( short cell ) { return solution.at(sdkg::GEOMETRY.line[cell], sdkg::GEOMETRY.column[cell]); };
+        for (short start{0}; start < sdkg::BoardGeometry::N_CELLS; start++) {
+            if (caged[start]) continue;
+            sdkg::KillerRules::Cage cage{ value_at(start), { start } };
+            caged[start] = true;
+            unsigned used = 1u << value_at(start);
+            auto size = (size_t) (1 + rng() % 4);
+            while (cage.cells.size() < size) {
+                vector<short> next;
+                for (short cell : cage.cells) {
+                    short l = sdkg::GEOMETRY.line[cell], c = sdkg::GEOMETRY.column[cell];
+                    short around[]{ (short) (l > 0 ? cell - 9 : -1), (short) (l < 8 ? cell + 9 : -1),
+                                    (short) (c > 0 ? cell - 1 : -1), (short) (c < 8 ? cell + 1 : -1) };
+                    for (short n : around) {
+                        if (n >= 0 and not caged[n] and not (used & (1u << value_at(n)))) next.push_back(n);
+                    }
+                }
+                if (next.empty()) break;
+                short cell = next[rng() % next.size()];
+                caged[cell] = true;
+                used |= 1u << value_at(cell);
+                cage.sum = (short) (cage.sum + value_at(cell));
+                cage.cells.push_back(cell);
+            }
+            cages.push_back(cage);
+        }
+        return sdkg::KillerRules{ cages };
+    }
+
+    /// Solves and proves unique every puzzle, printing the average time and nodes.
+    template < typename Rules >
+    void run_variant( const vector<std::pair<Rules, sdkg::SBoard>> &games ) {
+        double solve_s = 0, count_s = 0;
+        size_t nodes = 0, failed = 0;
+        for (const auto &[rules, puzzle] : games) {
+            sdkg::SBoard solution;
+            auto start = std::chrono::steady_clock::now();
+            sdkg::BasicSudokuSolver<Rules> solver{ puzzle, rules };
+            bool solved = solver.solve(solution);
+            solve_s += seconds_since(start);
+            nodes += solver.stats().nodes;
+            start = std::chrono::steady_clock::now();
+            size_t count = sdkg::BasicSudokuSolver<Rules>{ puzzle, rules }.count_solutions(2);
+            count_s += seconds_since(start);
+            if (not solved or count != 1 or not sdkg::is_solved(solution, rules)) failed++;
+        }
+        auto n = (double) games.size();
+        std::cout << "  " << Rules::NAME << ": solve " << solve_s / n * 1e6 << " us (" << (double) nodes / n << " nodes), "
+                  << "uniqueness " << count_s / n * 1e6 << " us" << (failed != 0 ? ", FAILED: " + std::to_string(failed) : "") << "\n";
+    }
+
+    /// Puzzles of a rule set that does not depend on the solution.
+    template < typename Rules >
+    vector<std::pair<Rules, sdkg::SBoard>> make_games( const Rules &rules, size_t n, std::mt19937 &rng, short givens ) {
+        vector<std::pair<Rules, sdkg::SBoard>> games;
+        for (size_t p{0}; p < n; p++) games.emplace_back(rules, unique_puzzle(random_solution(rules, rng), rules, rng, givens));
+        return games;
+    }
+
+    void bench_variants( size_t n ) {
+        // irregular regions, all of them orthogonally connected
+        constexpr const char *JIGSAW{ "000111222001111122001332225033344425033444555334475558664677588666677788667778888" };
+        // as many givens for every rule set, minimal puzzles of the variants have far fewer than classic ones
+        constexpr short GIVENS{ 26 };
+        std::mt19937 rng{ 9 };
+        std::cout << n << " puzzles with a unique solution and " << GIVENS << " givens per rule set, time per puzzle:\n";
+        run_variant(make_games(sdkg::ClassicRules{}, n, rng, GIVENS));
+        run_variant(make_games(sdkg::DiagonalRules{}, n, rng, GIVENS));
+        run_variant(make_games(sdkg::AntiKnightRules{}, n, rng, GIVENS));
+        run_variant(make_games(sdkg::JigsawRules{ JIGSAW }, n, rng, GIVENS));
+        vector<std::pair<sdkg::KillerRules, sdkg::SBoard>> killer;
+        for (size_t p{0}; p < n; p++) {
+            sdkg::SBoard solution = random_solution(sdkg::ClassicRules{}, rng);
+            sdkg::KillerRules rules = random_cages(solution, rng);
+            killer.emplace_back(rules, unique_puzzle(solution, rules, rng, GIVENS));
+        }
+        run_variant(killer);
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    if (argc < 2) usage();
+    string bench{ argv[1] };
+    size_t n = 0;
+    unsigned threads = 0;
+    double timeout = 20;
+    for (int i{2}; i < argc; i++) {
+        if (string{argv[i]} == "-n" and i + 1 < argc and is_numeric(argv[i + 1])) n = std::stoul(argv[++i]);
+        else if (string{argv[i]} == "-t" and i + 1 < argc and is_numeric(argv[i + 1])) threads = (unsigned) std::stoul(argv[++i]);
+        else if (string{argv[i]} == "--timeout" and i + 1 < argc and is_numeric(argv[i + 1])) timeout = std::stod(argv[++i]);
+        else usage();
+    }
+
+    if (bench == "validate") bench_validate(n != 0 ? n : 1 << 20);
+    else if (bench == "anneal") bench_anneal((short) std::min<size_t>(n != 0 ? n : 5, sdkg::LargeBoard::MAX_BOX), threads, timeout);
+    else if (bench == "cp") bench_cp(n != 0 ? n : 200);
+    else if (bench == "variants") bench_variants(n != 0 ? n : 100);
+    else if (bench == "pool") bench_pool(n != 0 ? n : 1 << 20);
+    else if (bench == "color") bench_color(n != 0 ? n : 1 << 20);
+    else if (bench == "errors") bench_errors(n != 0 ? n : 1 << 20);
+    else if (bench == "queue") bench_queue(n != 0 ? n : 1 << 20, threads != 0 ? threads : 64);
+    else usage();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file cnf_main.cpp
+ *
+ * @description
+ * Exports boards as DIMACS CNF for external SAT solvers, and cross-checks
+ * the models they return against the clues and our CP solver.
+ *
+ *   sudoku_cnf [-b <index>] <puzzle_file>                  CNF of one board to stdout.
+ *   sudoku_cnf -o <prefix> <puzzle_file>                   CNF of every board to <prefix><index>.cnf.
+ *   sudoku_cnf [-b <index>] --check <model> <puzzle_file>  Checks a SAT solver's model of a board.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <fstream>
+#include <iostream>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+#include "../core/board_archive.h"
+#include "../core/board_io.h"
+#include "../core/cp_solver.h"
+#include "../core/dimacs.h"
+#include "../core/sudoku_solver.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    void usage() {
+        std::cout << "Usage: sudoku_cnf [-b <index>] [-o <prefix>] [--check <model_file>] <puzzle_file>\n"
+                  << "    -b <num>             Board to export or check. Default = 0.\n"
+                  << "    -o <prefix>          Export every board, to <prefix><index>.cnf.\n"
+                  << "    --check <model_file> Check the model a SAT solver found for board -b.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    /// The clues of a board: hidden values (negatives) are only one of the solutions.
+    sdkg::SBoard clues_of( const sdkg::SBoard &sb ) {
+        sdkg::SBoard clues;
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                if (sb.at(i, j) > 0) clues.set_loc(i, j, sb.at(i, j));
+            }
+        }
+        return clues;
+    }
+
+    /// Checks a model: a solved board, keeping the clues, and the solution our CP solver finds if it is unique.
+    int check_model( const sdkg::SBoard &clues, const string &model_path ) {
+        std::ifstream in{ model_path };
+        if (not in) {
+            std::cerr << "sudoku_cnf: " << model_path << " could not be opened!\n";
+            return EXIT_FAILURE;
+        }
+        sdkg::CpSolver cp{ clues };
+        sdkg::SBoard model;
+        if (not sdkg::read_dimacs_model(in, model)) {
+            bool solvable = cp.count_solutions(1) > 0;
+            std::cout << "no model" << (solvable ? ", but the CP solver found a solution: MISMATCH\n" : ", CP solver agrees\n");
+            return solvable ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+        // a full board the exact solver accepts as givens breaks no rule
+        if (not sdkg::SudokuSolver{ model }.is_consistent()) {
+            std::cout << "model breaks the rules: MISMATCH\n";
+            return EXIT_FAILURE;
+        }
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                if (clues.at(i, j) > 0 and clues.at(i, j) != model.at(i, j)) {
+                    std::cout << "model changes the clue at (" << i + 1 << ", " << j + 1 << "): MISMATCH\n";
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        size_t solutions = cp.count_solutions(2);
+        sdkg::SBoard solution;
+        sdkg::CpSolver{ clues }.solve(solution);
+        bool same = true;
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) same = same and solution.at(i, j) == model.at(i, j);
+        }
+        if (solutions > 1) std::cout << "model is a valid solution (the board has several)\n";
+        else if (same) std::cout << "model is the unique solution, CP solver agrees\n";
+        else {
+            std::cout << "model differs from the unique solution of the CP solver: MISMATCH\n";
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    size_t index = 0;
+    string path, prefix, model_path;
+    for (int i{1}; i < argc; i++) {
+        string arg{ argv[i] };
+        if (arg == "-b") {
+            if (i + 1 >= argc or not is_numeric(argv[i + 1])) usage();
+            index = std::stoul(argv[++i]);
+        }
+        else if (arg == "-o" and i + 1 < argc) prefix = argv[++i];
+        else if (arg == "--check" and i + 1 < argc) model_path = argv[++i];
+        else if (arg == "-h" or arg == "--help") usage();
+        else path = arg;
+    }
+    if (path.empty()) usage();
+
+    vector<sdkg::SBoard> boards;
+    try {
+        if (sdkg::BoardArchive::is_archive(path)) {
+            boards = sdkg::BoardArchive(path).read_all();
+        } else {
+            std::ifstream in{ path };
+            if (not in) throw std::runtime_error("File could not be opened!\n");
+            sdkg::SBoard sb;
+            while (sdkg::read_board(in, sb)) boards.push_back(sb);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "sudoku_cnf: " << e.what();
+        return EXIT_FAILURE;
+    }
+
+    if (not prefix.empty()) {
+        for (size_t b{0}; b < boards.size(); b++) {
+            std::ofstream out{ prefix + std::to_string(b) + ".cnf" };
+            sdkg::write_dimacs(out, clues_of(boards[b]));
+            if (not out) {
+                std::cerr << "sudoku_cnf: could not write " << prefix << b << ".cnf\n";
+                return EXIT_FAILURE;
+            }
+        }
+        std::cerr << boards.size() << " boards exported\n";
+        return EXIT_SUCCESS;
+    }
+    if (index >= boards.size()) {
+        std::cerr << "sudoku_cnf: the file has " << boards.size() << " boards\n";
+        return EXIT_FAILURE;
+    }
+    if (not model_path.empty()) return check_model(clues_of(boards[index]), model_path);
+    sdkg::write_dimacs(std::cout, clues_of(boards[index]));
+    return EXIT_SUCCESS;
+}
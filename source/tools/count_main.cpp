@@ -0,0 +1,119 @@
+/**
+ * @file count_main.cpp
+ *
+ * @description
+ * Puzzle QA: counts the solutions of every board of a puzzle file (text or
+ * archive), in parallel, up to an optional limit and time budget per board.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "../core/board_archive.h"
+#include "../core/board_io.h"
+#include "../core/solution_enumerator.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    void usage() {
+        std::cout << "Usage: sudoku_count [-l <limit>] [-t <threads>] [--timeout <seconds>] [--print] <puzzle_file>\n"
+                  << "    -l <num>         Stop counting a board at <num> solutions. Default = 0 (no limit).\n"
+                  << "    -t <num>         Worker threads. Default = one per core.\n"
+                  << "    --timeout <num>  Cancel a board's count after <num> seconds.\n"
+                  << "    --print          Print every solution found.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) usage();
+        return std::stoul(argv[++i]);
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    size_t limit = 0, timeout = 0;
+    unsigned threads = 0;
+    bool print = false;
+    string path;
+    for (int i{1}; i < argc; i++) {
+        string arg{ argv[i] };
+        if (arg == "-l") limit = read_number(argc, argv, i);
+        else if (arg == "-t") threads = (unsigned) read_number(argc, argv, i);
+        else if (arg == "--timeout") timeout = read_number(argc, argv, i);
+        else if (arg == "--print") print = true;
+        else if (arg == "-h" or arg == "--help") usage();
+        else path = arg;
+    }
+    if (path.empty()) usage();
+
+    vector<sdkg::SBoard> boards;
+    try {
+        if (sdkg::BoardArchive::is_archive(path)) {
+            boards = sdkg::BoardArchive(path).read_all();
+        } else {
+            std::ifstream in{ path };
+            if (not in) throw std::runtime_error("File could not be opened!\n");
+            sdkg::SBoard sb;
+            while (sdkg::read_board(in, sb)) boards.push_back(sb);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "sudoku_count: " << e.what();
+        return EXIT_FAILURE;
+    }
+
+    size_t non_unique = 0;
+    for (size_t b{0}; b < boards.size(); b++) {
+        // the hidden values (negatives) are just one of the solutions, count over the clues only
+        sdkg::SBoard clues;
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                if (boards[b].at(i, j) > 0) clues.set_loc(i, j, boards[b].at(i, j));
+            }
+        }
+        sdkg::SolutionEnumerator enumerator{ clues, limit, threads };
+
+        // watchdog that cancels the count when the time budget runs out
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool done = false;
+        std::thread watchdog;
+        if (timeout > 0) {
+            watchdog = std::thread([&]() {
+                std::unique_lock<std::mutex> lock{mutex};
+                if (not done_cv.wait_for(lock, std::chrono::seconds(timeout), [&done]() { return done; })) {
+                    enumerator.cancel();
+                }
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        sdkg::SolutionEnumerator::Result result = print
+            ? enumerator.enumerate([](const sdkg::SBoard &solution) { sdkg::write_board(std::cout, solution); })
+            : enumerator.count();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (watchdog.joinable()) {
+            { std::lock_guard<std::mutex> lock{mutex}; done = true; }
+            done_cv.notify_all();
+            watchdog.join();
+        }
+
+        if (result.count > 1) non_unique++;
+        std::cout << "board " << b << ": " << result.count << " solution(s)"
+                  << (result.limit_reached ? " [limit reached]" : "")
+                  << (result.cancelled ? " [cancelled]" : "")
+                  << " in " << elapsed.count() << " s\n";
+    }
+    std::cout << boards.size() << " boards, " << non_unique << " with more than one solution\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file fuzz_main.cpp
+ *
+ * @description
+ * Fuzz target for the code that reads untrusted input: the text board
+ * parser, the puzzle archive decoder and the match commands. It follows the
+ * libFuzzer interface, so with clang it is built as a libFuzzer binary
+ * (cmake -DSUDOKU_LIBFUZZER=ON -DCMAKE_CXX_COMPILER=clang++); otherwise it
+ * gets a small main that replays the inputs (files or directories, e.g. a
+ * libFuzzer corpus or crash file) given on the command line.
+ *
+ * The first byte of an input selects what the rest of it feeds:
+ *  + 0: the text parser; every board read must survive a write/read roundtrip.
+ *  + 1: the archive decoder; anything but std::runtime_error is a bug.
+ *  + 2: a match, one command per line; the original locations must never change
+ *       and every location must decode to a known code.
+ * A broken invariant aborts, which is what the fuzzer reports as a crash.
+ */
+
+#include <cstdint>
+#include <cstdlib> // EXIT_SUCCESS
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <unistd.h> // getpid
+
+#include "../core/board_archive.h"
+#include "../core/board_io.h"
+#include "../core/player.h"
+#include "../core/sudoku_gm.h"
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    void check( bool ok, const char *what ) {
+        if (ok) return;
+        std::cerr << "Invariant broken: " << what << "\n";
+        std::abort();
+    }
+
+    bool same_board( const sdkg::SBoard &a, const sdkg::SBoard &b ) {
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                if (a.at(i, j) != b.at(i, j)) return false;
+            }
+        }
+        return true;
+    }
+
+    /// Scratch file of this process, so parallel fuzzing jobs do not step on each other.
+    string scratch_path( const string &name ) {
+        return (fs::temp_directory_path() / ("sudoku_fuzz_" + std::to_string(::getpid()) + "_" + name)).string();
+    }
+
+    void fuzz_text( const uint8_t *data, size_t size ) {
+        std::istringstream in{ string{ (const char *) data, size } };
+        sdkg::SBoard sb;
+        char text[sdkg::MAX_BOARD_TEXT];
+        sdkg::read_status_e status;
+        while ((status = sdkg::try_read_board(in, sb)) != sdkg::END_OF_INPUT) {
+            if (status != sdkg::BOARD_READ) continue;
+            std::istringstream again{ string{ text, sdkg::format_board(sb, text) } };
+            sdkg::SBoard copy;
+            check(sdkg::try_read_board(again, copy) == sdkg::BOARD_READ, "a formatted board reads back");
+            check(same_board(sb, copy), "a formatted board reads back unchanged");
+        }
+    }
+
+    void fuzz_archive( const uint8_t *data, size_t size ) {
+        static const string path{ scratch_path("archive.sdka") };
+        {
+            std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+            file.write((const char *) data, (std::streamsize) size);
+        }
+        try {
+            sdkg::BoardArchive archive{ path };
+            vector<sdkg::SBoard> boards = archive.read_all(1);
+            check(boards.size() == archive.size(), "read_all decodes every board");
+            if (not boards.empty()) check(same_board(archive.board(boards.size() - 1), boards.back()),
+                                          "board() agrees with read_all()");
+        } catch (const std::runtime_error &) {
+            // rejected as corrupted, which is the expected outcome for most inputs
+        }
+    }
+
+    /// Plays the lines of a script as match commands, checking the board between them.
+    class ScriptPlayer : public sdkg::Player {
+        private:
+            vector<string> m_script;
+            size_t m_next = 0;
+            sdkg::SBoard m_originals;   //!< Original values at the start of the match, 0 elsewhere.
+
+            void check_board( const sdkg::SBoardManager &sbm ) const {
+                for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+                    for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                        std::pair<sdkg::SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(i, j);
+                        check(loc.first >= sdkg::SBoardManager::EMPTY and loc.first <= sdkg::SBoardManager::INVALID,
+                              "every location decodes to a known code");
+                        check(loc.second >= 0 and loc.second <= sdkg::Config::SUDOKU_BIGGEST_NUM,
+                              "every location decodes to a digit or 0");
+                        bool original = loc.first == sdkg::SBoardManager::ORIGINAL;
+                        check(original == (m_originals.at(i, j) != 0), "original locations stay original");
+                        if (original) check(loc.second == m_originals.at(i, j), "original values never change");
+                    }
+                }
+            }
+
+        protected:
+            void on_new_match( const sdkg::SBoardManager &sbm ) override {
+                for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+                    for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                        std::pair<sdkg::SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(i, j);
+                        m_originals.set_loc(i, j, loc.first == sdkg::SBoardManager::ORIGINAL ? loc.second : 0);
+                    }
+                }
+            }
+
+            string next_move( const sdkg::SBoardManager &sbm ) override {
+                check_board(sbm);
+                return m_script[m_next++ % m_script.size()];
+            }
+
+        public:
+            explicit ScriptPlayer( vector<string> script )
+                : Player(1, 0, script.size()), m_script{ std::move(script) } {/*empty*/}
+    };
+
+    void fuzz_match( const uint8_t *data, size_t size ) {
+        // a solved board whose hidden locations carry their solution (negative values)
+        static const string path = []() {
+            const string solution{ "534678912672195348198342567859761423426853791713924856961537284287419635345286179" };
+            string name{ scratch_path("match.txt") };
+            std::ofstream file{ name };
+            for (size_t k{0}; k < solution.size(); k++) {
+                file << ((k * 7) % 3 == 0 ? "" : "-") << solution[k] << ((k + 1) % 9 == 0 ? "\n" : " ");
+            }
+            return name;
+        }();
+
+        vector<string> script;
+        std::istringstream in{ string{ (const char *) data, size } };
+        for (string line; std::getline(in, line); ) script.push_back(line);
+        ScriptPlayer player{ std::move(script) };
+
+        std::streambuf *cout_buf = std::cout.rdbuf(nullptr);
+        sdkg::SudokuGame game;
+        game.set_player(&player);
+        string prog{ "sudoku" };
+        vector<char *> args{ &prog[0], const_cast<char *>(path.c_str()) };
+        if (game.initialize((int) args.size(), args.data())) {
+            while (not game.game_over()) {
+                game.process_events();
+                game.update();
+            }
+        }
+        std::cout.rdbuf(cout_buf);
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t *data, size_t size ) {
+    if (size == 0) return 0;
+    switch (data[0] % 3) {
+        case 0: fuzz_text(data + 1, size - 1); break;
+        case 1: fuzz_archive(data + 1, size - 1); break;
+        default: fuzz_match(data + 1, size - 1); break;
+    }
+    return 0;
+}
+
+#ifndef SUDOKU_LIBFUZZER
+namespace {
+
+    bool run_file( const fs::path &path ) {
+        std::ifstream file{ path, std::ios::binary };
+        if (not file) {
+            std::cerr << "Could not read \"" << path.string() << "\"\n";
+            return false;
+        }
+        string bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        LLVMFuzzerTestOneInput((const uint8_t *) bytes.data(), bytes.size());
+        return true;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    if (argc < 2) {
+        std::cout << "Usage: sudoku_fuzz <input file or corpus directory>...\n"
+                  << "    Replays fuzzer inputs; build with -DSUDOKU_LIBFUZZER=ON (clang) to fuzz.\n";
+        return EXIT_SUCCESS;
+    }
+    size_t runs = 0;
+    bool ok = true;
+    for (int i{1}; i < argc; i++) {
+        fs::path path{ argv[i] };
+        if (fs::is_directory(path)) {
+            for (const fs::directory_entry &entry : fs::recursive_directory_iterator(path)) {
+                if (not entry.is_regular_file()) continue;
+                ok = run_file(entry.path()) and ok;
+                runs++;
+            }
+        } else {
+            ok = run_file(path) and ok;
+            runs++;
+        }
+    }
+    std::cout << "Replayed " << runs << " input(s).\n";
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif
@@ -0,0 +1,495 @@
+/**
+ * @file load_main.cpp
+ *
+ * @description
+ * Load generator for the interactive command loop: drives N games with the
+ * scripted players' command mix (p, r, u, c and the menus) at a set rate and
+ * records the end-to-end latency of every command, from the moment it was
+ * due to the moment the game is waiting for the next line, its screen
+ * rendered. Latencies go to HdrHistograms, reported per command kind as
+ * p50/p90/p99/p99.9/max and, for all commands, written as an .hgrm
+ * percentile distribution, so runs before and after a renderer or board
+ * change can be compared.
+ *
+ * Games run in-process (the game loop of main.cpp, screens rendered into a
+ * byte counting sink) or, with --processes, as `sudoku` child processes
+ * driven over pipes: a command is done when the child's output ends with a
+ * prompt. A child is mirrored by an in-process game that is never rendered,
+ * fed the same lines, which tells the players the prompt and the board.
+ *
+ * With a rate, every game sends on a fixed schedule and latencies are
+ * measured from the scheduled times: a command stuck behind a slow one is
+ * charged its wait (no coordinated omission). The service time, from the
+ * actual send, is reported too.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+using std::string;
+#include <string_view>
+#include <thread>
+#include <vector>
+using std::vector;
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../core/player.h"
+#include "../core/sudoku_gm.h"
+#include "../lib/hdr_histogram.h"
+
+namespace {
+
+    using steady_clock = std::chrono::steady_clock;
+
+    /// Load test options read from the command line.
+    struct LoadOptions {
+        vector<string> input_filenames;                //!< Puzzle files shared by every game, ../data/input.txt if none.
+        string strategy{ "human" };                    //!< Player strategy: random, solver or human.
+        size_t games = 8;
+        size_t threads = 0;                            //!< In-process driver threads, 0 for one per core.
+        double rate = 0;                               //!< Commands per second per game, 0 for back to back.
+        double seconds = 10;                           //!< Run length.
+        size_t max_commands = 0;                       //!< Commands per game, 0 for no limit.
+        unsigned seed = 42;                            //!< Base seed, each game uses seed + game index.
+        bool processes = false;                        //!< Run `sudoku` child processes instead of in-process games.
+        string exe;                                    //!< Game binary of --processes, next to this tool by default.
+        bool color = true;                             //!< In-process screens with escape codes, as on a terminal.
+        string hgrm_filename;                          //!< Percentile distribution of all commands, empty for none.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_load [-n <games>] [-t <threads>] [-r <rate>] [-d <seconds>] [-c <commands>]\n"
+                  << "                   [-s random|solver|human] [--seed <num>] [--processes] [--exe <path>]\n"
+                  << "                   [--no-color] [--hgrm <path>] [--help] <input_puzzle_file>...\n"
+                  << "  Options:\n"
+                  << "    -n <games>      Games driven at once. Default = 8.\n"
+                  << "    -t <threads>    Driver threads of the in-process games. Default = # of cores.\n"
+                  << "    -r <rate>       Commands per second per game. Default = 0, back to back.\n"
+                  << "    -d <seconds>    Run length. Default = 10.\n"
+                  << "    -c <commands>   Stop every game after that many commands.\n"
+                  << "    --processes     Run `sudoku` processes over pipes, one driver thread each.\n"
+                  << "    --exe <path>    Game binary of --processes. Default = sudoku next to sudoku_load.\n"
+                  << "    --no-color      Render the in-process screens without escape codes.\n"
+                  << "    --hgrm <path>   Write the latency percentile distribution (HdrHistogram format, us).\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    double read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        char *end = nullptr;
+        double value = std::strtod(argv[i + 1], &end);
+        if (end == argv[i + 1] or *end != '\0' or value < 0) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        i++;
+        return value;
+    }
+
+    LoadOptions read_cli_options( int argc, char **argv ) {
+        LoadOptions opt;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "-n") opt.games = (size_t) read_number(argc, argv, i);
+            else if (arg == "-t") opt.threads = (size_t) read_number(argc, argv, i);
+            else if (arg == "-r") opt.rate = read_number(argc, argv, i);
+            else if (arg == "-d") opt.seconds = read_number(argc, argv, i);
+            else if (arg == "-c") opt.max_commands = (size_t) read_number(argc, argv, i);
+            else if (arg == "--seed") opt.seed = (unsigned) read_number(argc, argv, i);
+            else if (arg == "-s" and i + 1 < argc) opt.strategy = argv[++i];
+            else if (arg == "--processes") opt.processes = true;
+            else if (arg == "--exe" and i + 1 < argc) opt.exe = argv[++i];
+            else if (arg == "--no-color") opt.color = false;
+            else if (arg == "--hgrm" and i + 1 < argc) opt.hgrm_filename = argv[++i];
+            else if (arg == "-h" or arg == "--help") usage();
+            else opt.input_filenames.push_back(arg);
+        }
+        if (opt.strategy != "random" and opt.strategy != "solver" and opt.strategy != "human") usage();
+        if (opt.games == 0) opt.games = 1;
+        if (opt.threads == 0) opt.threads = std::max(1u, std::thread::hardware_concurrency());
+        opt.threads = std::min(opt.threads, opt.games);
+        if (opt.exe.empty()) {
+            string self{ argv[0] };
+            size_t slash = self.rfind('/');
+            opt.exe = (slash == string::npos ? string{"."} : self.substr(0, slash)) + "/sudoku";
+        }
+        return opt;
+    }
+
+    std::unique_ptr<sdkg::Player> make_player( const LoadOptions &opt, unsigned seed ) {
+        // a load test plays until the clock stops it, never running out of matches
+        constexpr size_t MATCHES{ 1000000000 };
+        if (opt.strategy == "random") return std::make_unique<sdkg::RandomPlayer>(MATCHES, seed);
+        if (opt.strategy == "solver") return std::make_unique<sdkg::SolverPlayer>(MATCHES, seed);
+        return std::make_unique<sdkg::HumanLikePlayer>(MATCHES, seed);
+    }
+
+    /// Kinds of commands the latencies are broken down by.
+    enum kind_e : size_t { PLACE = 0, REMOVE, UNDO, CHECK, MENU, N_KINDS };
+    constexpr const char * KIND_NAMES[N_KINDS]{ "place", "remove", "undo", "check", "menu" };
+
+    /// Match commands by their first letter; empty lines (back to the menu) and menu answers are menu navigation.
+    kind_e kind_of( sdkg::Player::prompt_e prompt, const string &line ) {
+        if (prompt != sdkg::Player::prompt_e::COMMAND) return MENU;
+        size_t first = line.find_first_not_of(' ');
+        if (first == string::npos) return MENU;
+        switch (line[first]) {
+            case 'p': return PLACE;
+            case 'r': return REMOVE;
+            case 'u': return UNDO;
+            case 'c': return CHECK;
+            default: return MENU;
+        }
+    }
+
+    /// Screens of the in-process games: counted, then dropped.
+    class CountingSink : public std::streambuf {
+        private:
+            std::atomic<uint64_t> m_bytes{ 0 };
+
+        protected:
+            // no put area: every write lands here, from any driver thread
+            std::streamsize xsputn( const char *, std::streamsize n ) override {
+                m_bytes.fetch_add((uint64_t) n, std::memory_order_relaxed);
+                return n;
+            }
+            int_type overflow( int_type ch ) override {
+                m_bytes.fetch_add(1, std::memory_order_relaxed);
+                return traits_type::not_eof(ch);
+            }
+
+        public:
+            uint64_t bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+    };
+
+    /// A game to drive: a prompt to answer, then one line at a time until the game waits again.
+    class Target {
+        public:
+            virtual ~Target() = default;
+            // The prompt the game waits on, false if it is over.
+            virtual bool prompt( sdkg::Player::prompt_e &prompt ) const = 0;
+            // The board the player answers from.
+            virtual const sdkg::SBoardManager & board() const = 0;
+            // Sends a line and returns once its outcome was rendered; false if the game is gone.
+            virtual bool send( const string &line ) = 0;
+            // Bytes of screens output so far (in-process games share the sink, see CountingSink).
+            virtual uint64_t output_bytes() const { return 0; }
+    };
+
+    /// Runs the game loop of main.cpp, without idle (which would block), until the game waits for a line.
+    void run_until_waiting( sdkg::SudokuGame &game, bool render ) {
+        do {
+            game.process_events();
+            game.update();
+            if (render) game.render();
+        } while (not game.is_waiting_input() and not game.game_over());
+    }
+
+    class InProcessTarget : public Target {
+        private:
+            std::ostream m_out;         //!< The game's own stream, on the shared sink.
+            sdkg::SudokuGame m_game;
+
+        public:
+            InProcessTarget( vector<char *> &args, const sdkg::SudokuGame &loaded, CountingSink &sink ) : m_out{ &sink } {
+                m_game.set_output(m_out);
+                m_game.initialize((int) args.size(), args.data(), &loaded);
+                run_until_waiting(m_game, true);
+            }
+
+            bool prompt( sdkg::Player::prompt_e &prompt ) const override { return m_game.pending_prompt(prompt); }
+            const sdkg::SBoardManager & board() const override { return m_game.board_manager(); }
+
+            bool send( const string &line ) override {
+                if (not m_game.post_command(string{ line })) return false;
+                run_until_waiting(m_game, true);
+                return true;
+            }
+    };
+
+    /// A `sudoku` child process, mirrored by an in-process game that is never rendered.
+    class ProcessTarget : public Target {
+        private:
+            std::ostream m_discard{ nullptr };
+            sdkg::SudokuGame m_shadow;
+            pid_t m_pid = -1;
+            int m_to_child = -1;
+            int m_from_child = -1;
+            uint64_t m_bytes = 0;
+            string m_tail;              //!< Last bytes read, to spot the prompt.
+
+            /// Reads the child's output up to a prompt, the end of a screen (stdout is flushed before waiting).
+            bool read_screen() {
+                static constexpr std::string_view PROMPTS[]{
+                    "Press < enter > to continue > ", "Select option [1, 4] > ",
+                    "Select an option [ y / N ] > ", "Enter a command > " };
+                char buffer[8192];
+                for (;;) {
+                    ssize_t n = read(m_from_child, buffer, sizeof buffer);
+                    if (n < 0 and errno == EINTR) continue;
+                    if (n <= 0) return false;
+                    m_bytes += (uint64_t) n;
+                    m_tail.append(buffer, (size_t) n);
+                    if (m_tail.size() > 64) m_tail.erase(0, m_tail.size() - 64);
+                    for (std::string_view prompt : PROMPTS) {
+                        if (m_tail.size() >= prompt.size() and
+                            std::string_view{ m_tail }.substr(m_tail.size() - prompt.size()) == prompt) {
+                            m_tail.clear();
+                            return true;
+                        }
+                    }
+                }
+            }
+
+        public:
+            ProcessTarget( const string &exe, vector<char *> &args, const sdkg::SudokuGame &loaded ) {
+                m_shadow.set_output(m_discard);
+                m_shadow.initialize((int) args.size(), args.data(), &loaded);
+                run_until_waiting(m_shadow, false);
+
+                int in[2], out[2];
+                if (pipe(in) != 0) return;
+                if (pipe(out) != 0) {
+                    close(in[0]);
+                    close(in[1]);
+                    return;
+                }
+                vector<char *> child_args{ args };
+                string exe_arg{ exe };
+                child_args[0] = &exe_arg[0];
+                child_args.push_back(nullptr);
+                m_pid = fork();
+                if (m_pid == 0) {
+                    dup2(in[0], STDIN_FILENO);
+                    dup2(out[1], STDOUT_FILENO);
+                    close(in[0]); close(in[1]); close(out[0]); close(out[1]);
+                    execv(exe_arg.c_str(), child_args.data());
+                    _exit(127);
+                }
+                close(in[0]);
+                close(out[1]);
+                m_to_child = in[1];
+                m_from_child = out[0];
+                fcntl(m_to_child, F_SETFD, FD_CLOEXEC);
+                fcntl(m_from_child, F_SETFD, FD_CLOEXEC);
+                if (m_pid < 0 or not read_screen()) stop();
+            }
+
+            ~ProcessTarget() override { stop(); }
+
+            /// Closes the child's input (it quits when its queue is empty) and reaps it.
+            void stop() {
+                if (m_to_child >= 0) close(m_to_child);
+                if (m_from_child >= 0) close(m_from_child);
+                m_to_child = m_from_child = -1;
+                if (m_pid > 0) waitpid(m_pid, nullptr, 0);
+                m_pid = -1;
+            }
+
+            bool prompt( sdkg::Player::prompt_e &prompt ) const override {
+                return m_pid > 0 and m_shadow.pending_prompt(prompt);
+            }
+            const sdkg::SBoardManager & board() const override { return m_shadow.board_manager(); }
+            uint64_t output_bytes() const override { return m_bytes; }
+
+            bool send( const string &line ) override {
+                if (m_pid <= 0) return false;
+                string text{ line + "\n" };
+                for (size_t sent = 0; sent < text.size(); ) {
+                    ssize_t n = write(m_to_child, text.data() + sent, text.size() - sent);
+                    if (n < 0 and errno == EINTR) continue;
+                    if (n <= 0) {
+                        stop();
+                        return false;
+                    }
+                    sent += (size_t) n;
+                }
+                if (not read_screen()) {
+                    stop();
+                    return false;
+                }
+                // the mirror follows once the round trip is measured
+                m_shadow.post_command(string{ line });
+                run_until_waiting(m_shadow, false);
+                return true;
+            }
+    };
+
+    /// A target, its player and its schedule.
+    struct Client {
+        std::unique_ptr<Target> target;
+        std::unique_ptr<sdkg::Player> player;
+        steady_clock::time_point due;               //!< When the next command is scheduled.
+        size_t commands = 0;
+        bool done = false;
+    };
+
+    /// Latencies recorded by one driver thread.
+    struct Recorder {
+        HdrHistogram latency[N_KINDS];          //!< From the scheduled time.
+        HdrHistogram all;
+        HdrHistogram service;                   //!< From the actual send.
+        size_t failed = 0;                      //!< Games that ended or broke before the run did.
+
+        void merge( const Recorder &other ) {
+            for (size_t k{0}; k < N_KINDS; k++) latency[k].merge(other.latency[k]);
+            all.merge(other.all);
+            service.merge(other.service);
+            failed += other.failed;
+        }
+    };
+
+    /// Waits until `due`: sleeps most of the way and yields the rest, a sleep overshoots by tens of us
+    /// that would count as latency.
+    void wait_until( steady_clock::time_point due ) {
+        static constexpr std::chrono::microseconds SPIN{ 200 };
+        if (due - steady_clock::now() > SPIN) std::this_thread::sleep_until(due - SPIN);
+        while (steady_clock::now() < due) std::this_thread::yield();
+    }
+
+    /// Driver thread: sends the due commands of its clients until the run ends.
+    void drive( vector<Client *> clients, const LoadOptions &opt, steady_clock::time_point end, Recorder &recorder ) {
+        auto interval = std::chrono::duration_cast<steady_clock::duration>(
+                std::chrono::duration<double>(opt.rate > 0 ? 1.0 / opt.rate : 0.0));
+        for (;;) {
+            // the client due first; back to back clients are always due
+            Client *next = nullptr;
+            for (Client *client : clients) {
+                if (not client->done and (next == nullptr or client->due < next->due)) next = client;
+            }
+            if (next == nullptr) return;
+            if (next->due >= end) return;
+            wait_until(next->due);
+
+            sdkg::Player::prompt_e prompt;
+            if (not next->target->prompt(prompt)) {
+                next->done = true;
+                recorder.failed++;
+                continue;
+            }
+            string line = next->player->answer(prompt, next->target->board());
+            auto sent = steady_clock::now();
+            if (not next->target->send(line)) {
+                next->done = true;
+                recorder.failed++;
+                continue;
+            }
+            auto now = steady_clock::now();
+            auto scheduled = opt.rate > 0 ? next->due : sent;
+            recorder.latency[kind_of(prompt, line)].record(now - scheduled);
+            recorder.all.record(now - scheduled);
+            recorder.service.record(now - sent);
+
+            next->due = opt.rate > 0 ? next->due + interval : now;
+            if (++next->commands == opt.max_commands) next->done = true;
+        }
+    }
+
+    void print_row( const char *name, const HdrHistogram &h ) {
+        char line[160];
+        std::snprintf(line, sizeof line, "%-10s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", name,
+                      (unsigned long long) h.count(), (double) h.value_at_percentile(50) / 1e3,
+                      (double) h.value_at_percentile(90) / 1e3, (double) h.value_at_percentile(99) / 1e3,
+                      (double) h.value_at_percentile(99.9) / 1e3, (double) h.max() / 1e3);
+        std::cout << line;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    LoadOptions opt = read_cli_options(argc, argv);
+    std::signal(SIGPIPE, SIG_IGN);  // a child that died is noticed by the failed write
+
+    // In-process games write their screens to streams of their own on this sink: counted and dropped.
+    CountingSink sink;
+    Color::set_enabled(opt.color and not opt.processes);
+
+    // The puzzle files are read once; every game (or mirror) plays from the same boards.
+    string prog{ "sudoku" };
+    vector<char *> args{ &prog[0] };
+    for (const string &path : opt.input_filenames) args.push_back(const_cast<char *>(path.c_str()));
+    std::ostream discard{ nullptr };
+    sdkg::SudokuGame prototype;
+    prototype.set_output(discard);
+    if (not prototype.initialize((int) args.size(), args.data())) {
+        std::cerr << "Could not load the puzzle files\n";
+        return EXIT_FAILURE;
+    }
+
+    vector<Client> clients(opt.games);
+    for (size_t g{0}; g < opt.games; g++) {
+        Client &client = clients[g];
+        if (opt.processes) client.target = std::make_unique<ProcessTarget>(opt.exe, args, prototype);
+        else client.target = std::make_unique<InProcessTarget>(args, prototype, sink);
+        client.player = make_player(opt, opt.seed + (unsigned) g);
+    }
+    uint64_t start_bytes = sink.bytes();
+    for (const Client &client : clients) start_bytes += client.target->output_bytes();
+
+    // processes block on their pipes: one thread each; in-process games share the threads
+    size_t n_threads = opt.processes ? opt.games : opt.threads;
+    vector<Recorder> recorders(n_threads);
+    vector<std::thread> drivers;
+    auto start = steady_clock::now();
+    auto end = start + std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(opt.seconds));
+    for (size_t g{0}; g < opt.games; g++) {
+        // spread the first commands over one interval, so the games do not send in lockstep
+        double offset = opt.rate > 0 ? (double) g / (double) opt.games / opt.rate : 0.0;
+        clients[g].due = start + std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(offset));
+    }
+    for (size_t t{0}; t < n_threads; t++) {
+        vector<Client *> mine;
+        for (size_t g{t}; g < opt.games; g += n_threads) mine.push_back(&clients[g]);
+        drivers.emplace_back(drive, std::move(mine), std::cref(opt), end, std::ref(recorders[t]));
+    }
+    for (std::thread &driver : drivers) driver.join();
+    std::chrono::duration<double> elapsed = steady_clock::now() - start;
+
+    uint64_t bytes = sink.bytes();
+    for (const Client &client : clients) bytes += client.target->output_bytes();
+    bytes -= start_bytes;
+    clients.clear();    // children quit and are reaped
+
+    Recorder total;
+    for (const Recorder &r : recorders) total.merge(r);
+    double commands = (double) total.all.count();
+    std::cout << "Games:             " << opt.games << (opt.processes ? " processes" : " in-process") << " ("
+              << n_threads << " threads, " << opt.strategy << ", ";
+    if (opt.rate > 0) std::cout << opt.rate << " commands/s each)\n";
+    else std::cout << "back to back)\n";
+    std::cout << "Commands:          " << total.all.count() << " ("
+              << (elapsed.count() > 0 ? commands / elapsed.count() : 0.0) << " per second)\n"
+              << "Output per command: " << (commands > 0 ? (double) bytes / commands : 0.0) << " B\n";
+    if (total.failed) std::cout << "Games lost:        " << total.failed << "\n";
+    std::cout << "Elapsed:           " << elapsed.count() << " s\n\n"
+              << "Latency (us)            n        p50        p90        p99      p99.9        max\n";
+    for (size_t k{0}; k < N_KINDS; k++) {
+        if (total.latency[k].count() != 0) print_row(KIND_NAMES[k], total.latency[k]);
+    }
+    print_row("all", total.all);
+    print_row("service", total.service);
+
+    if (not opt.hgrm_filename.empty()) {
+        std::ofstream out{ opt.hgrm_filename };
+        total.all.write_percentiles(out);
+        out.close();
+        if (not out) {
+            std::cerr << "Could not write \"" << opt.hgrm_filename << "\"\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return total.all.count() != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
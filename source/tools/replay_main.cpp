@@ -0,0 +1,244 @@
+/**
+ * @file replay_main.cpp
+ *
+ * @description
+ * Session replayer: plays session logs (sudoku --record) back through the
+ * game, headless and at full speed, and checks every session ends in the
+ * state it was recorded in. Given directories, it replays every log in
+ * them (and the logs matching glob patterns), so a whole set of recorded
+ * sessions serves as a regression test.
+ *
+ * A replay fails when the game asks for another kind of line than the
+ * recorded one (the sessions diverged), goes through other player boards
+ * than the recorded ones (their digest differs), or ends on another board
+ * or with another player board. Logs of sessions that did not end (a crash) are
+ * replayed up to their last line but cannot be checked.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "../core/session_log.h"
+#include "../core/sudoku_gm.h"
+#include "../utils/is_numeric.h"
+#include "../utils/expand_paths.h"
+#include "../utils/split.h"
+
+namespace {
+
+    /// Replay options read from the command line.
+    struct ReplayOptions {
+        vector<string> logs;            //!< Log files and directories of logs.
+        string puzzles;                 //!< Puzzle file replacing the recorded one, empty to keep it.
+        size_t threads = 1;
+        bool verbose = false;           //!< Print the outcome of every log, not only the failures.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_replay [-t <threads>] [--puzzles <file>] [-v] [--help] <log file or directory>...\n"
+                  << "    Replays session logs recorded with `sudoku --record <path>` and checks their final state.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    ReplayOptions read_cli_options( int argc, char **argv ) {
+        ReplayOptions opt;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "-t" and i + 1 < argc and is_numeric(argv[i + 1])) opt.threads = std::stoul(argv[++i]);
+            else if (arg == "--puzzles" and i + 1 < argc) opt.puzzles = argv[++i];
+            else if (arg == "-v") opt.verbose = true;
+            else if (arg == "-h" or arg == "--help") usage();
+            else opt.logs.push_back(arg);
+        }
+        if (opt.logs.empty()) usage();
+        if (opt.threads == 0) opt.threads = 1;
+        return opt;
+    }
+
+    enum class outcome_e { VERIFIED, UNFINISHED, FAILED };
+
+    struct Result {
+        outcome_e outcome;
+        string message;
+        size_t lines = 0;               //!< Lines replayed.
+        uint64_t recorded_us = 0;       //!< How long the session took when it was recorded.
+    };
+
+    /// Puzzle files loaded once and shared by the replays that use them.
+    class PuzzleCache {
+        private:
+            std::mutex m_mutex;
+            std::map<string, std::unique_ptr<sdkg::SudokuGame>> m_loaded;
+            std::ostream m_discard{ nullptr };      //!< Output of the loading games, used under the lock.
+
+        public:
+            // Returns a game that loaded `args`' puzzle file, nullptr if it could not be loaded.
+            const sdkg::SudokuGame * get( const string &key, vector<char *> &args ) {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                std::unique_ptr<sdkg::SudokuGame> &game = m_loaded[key];
+                if (game == nullptr) {
+                    game = std::make_unique<sdkg::SudokuGame>();
+                    game->set_output(m_discard);
+                    game->initialize((int) args.size(), args.data());   // over if it failed
+                }
+                return game->game_over() ? nullptr : game.get();
+            }
+    };
+
+    bool same_board( const sdkg::SBoard &a, const sdkg::SBoard &b ) {
+        for (short i{0}; i < sdkg::Config::SB_SIZE; i++) {
+            for (short j{0}; j < sdkg::Config::SB_SIZE; j++) {
+                if (a.at(i, j) != b.at(i, j)) return false;
+            }
+        }
+        return true;
+    }
+
+    Result replay( const string &path, const ReplayOptions &opt, PuzzleCache &puzzles ) {
+        Result result{ outcome_e::FAILED, {} };
+        sdkg::SessionLog::Recording rec;
+        try {
+            rec = sdkg::SessionLog::read(path);
+        } catch (const std::exception &e) {
+            result.message = e.what();
+            return result;
+        }
+        for (const sdkg::SessionLog::Entry &entry : rec.entries) result.recorded_us += entry.delay_us;
+
+        // the game is started with the recorded options
+        string prog{ "sudoku" }, checks_opt{ "-c" }, checks{ std::to_string(rec.header.total_checks) }, unique_opt{ "-u" };
+        string level_opt{ "-d" }, level{ rec.header.difficulty >= 0 ? sdkg::DifficultyBuckets::name((sdkg::difficulty_e) rec.header.difficulty) : "" };
+        string puzzle_file{ opt.puzzles.empty() ? rec.header.input_filename : opt.puzzles };
+        vector<string> puzzle_paths = sdkg::split(puzzle_file, '\n');     // one path per line
+        vector<char *> args{ &prog[0], &checks_opt[0], &checks[0] };
+        if (rec.header.check_uniqueness) args.push_back(&unique_opt[0]);
+        if (rec.header.difficulty >= 0) args.insert(args.end(), { &level_opt[0], &level[0] });
+        for (string &path : puzzle_paths) args.push_back(&path[0]);
+
+        const sdkg::SudokuGame *loaded = puzzles.get(puzzle_file + (rec.header.check_uniqueness ? " -u" : ""), args);
+        if (loaded == nullptr) {
+            result.message = "puzzle file \"" + puzzle_file + "\" could not be loaded\n";
+            return result;
+        }
+        if (loaded->board_manager().get_num_valid_boards() != rec.header.num_boards) {
+            result.message = "puzzle file \"" + puzzle_file + "\" has " +
+                             std::to_string(loaded->board_manager().get_num_valid_boards()) + " valid boards, " +
+                             std::to_string(rec.header.num_boards) + " when recorded\n";
+            return result;
+        }
+
+        // screens are of no interest here, and a stream of its own keeps the game off the other threads' state
+        std::ostream discard{ nullptr };
+        sdkg::SudokuGame game;
+        game.set_output(discard);
+        game.initialize((int) args.size(), args.data(), loaded);
+        // new matches get the puzzles the recorded session got from its puzzle source, if it had one
+        size_t next_puzzle = 0;
+        game.set_puzzle_source([&rec, &next_puzzle]( sdkg::ReadyPuzzle &puzzle ) {
+            if (next_puzzle == rec.puzzles.size() or not rec.puzzles[next_puzzle].fed) {
+                next_puzzle = std::min(next_puzzle + 1, rec.puzzles.size());
+                return false;
+            }
+            puzzle = rec.puzzles[next_puzzle++].puzzle;
+            return true;
+        });
+        uint64_t digest = sdkg::SessionLog::DIGEST_SEED;
+        while (not game.game_over()) {
+            game.process_events();
+            sdkg::Player::prompt_e prompt;
+            if (game.pending_prompt(prompt)) {
+                if (result.lines == rec.entries.size()) {
+                    game.close_input();
+                    continue;
+                }
+                const sdkg::SessionLog::Entry &entry = rec.entries[result.lines];
+                if (entry.prompt != prompt) {
+                    result.message = "diverged at line " + std::to_string(result.lines + 1) + ": the game asks for prompt " +
+                                     std::to_string((int) prompt) + ", prompt " + std::to_string((int) entry.prompt) + " was recorded\n";
+                    return result;
+                }
+                // the game reads the line on the board it has now, as when it was recorded
+                digest = sdkg::SessionLog::fold(digest, (uint32_t) game.board_index(), game.board_manager().get_player_board());
+                // the queue drops blank confirmations, which mean 'no' when a scripted player gives them
+                bool blank = entry.line.find_first_not_of(" \t\r") == string::npos;
+                game.post_command(prompt == sdkg::Player::prompt_e::CONFIRM and blank ? string{ "n" } : string{ entry.line });
+                result.lines++;
+                continue;
+            }
+            game.update();
+        }
+
+        if (result.lines != rec.entries.size()) {
+            result.message = "the game ended after " + std::to_string(result.lines) + " of " +
+                             std::to_string(rec.entries.size()) + " lines\n";
+        } else if (not rec.finished) {
+            result.outcome = outcome_e::UNFINISHED;
+            result.message = "replayed, but the recorded session never ended: nothing to check\n";
+        } else if (digest != rec.digest) {
+            result.message = "went through other player boards than the recorded ones\n";
+        } else if (game.board_index() != (int) rec.board_idx) {
+            result.message = "ended on board " + std::to_string(game.board_index()) + ", board " +
+                             std::to_string(rec.board_idx) + " was recorded\n";
+        } else if (not same_board(game.board_manager().get_player_board(), rec.player_board)) {
+            result.message = "ended with another player board than the recorded one\n";
+        } else {
+            result.outcome = outcome_e::VERIFIED;
+        }
+        return result;
+    }
+
+}
+
+int main( int argc, char ** argv )
+{
+    ReplayOptions opt = read_cli_options(argc, argv);
+    // the files given, every regular file under the directories given, and the files matching the patterns
+    vector<string> logs = sdkg::expand_paths(opt.logs);
+    vector<Result> results(logs.size());
+    PuzzleCache puzzles;
+    std::atomic<size_t> next{ 0 };
+
+    // Games discard their output, see replay (no need to color it).
+    Color::set_enabled(false);
+    auto start = std::chrono::steady_clock::now();
+    vector<std::thread> workers;
+    for (size_t t{0}; t < std::min(opt.threads, logs.size()); t++) {
+        workers.emplace_back([&]() {
+            for (size_t k; (k = next++) < logs.size(); ) results[k] = replay(logs[k], opt, puzzles);
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t verified = 0, unfinished = 0, failed = 0, lines = 0;
+    double recorded = 0;
+    for (size_t k{0}; k < logs.size(); k++) {
+        const Result &r = results[k];
+        lines += r.lines;
+        recorded += r.recorded_us / 1e6;
+        if (r.outcome == outcome_e::VERIFIED) verified++;
+        else if (r.outcome == outcome_e::UNFINISHED) unfinished++;
+        else failed++;
+        if (r.outcome == outcome_e::FAILED) std::cerr << logs[k] << ": FAILED, " << r.message;
+        else if (opt.verbose) std::cout << logs[k] << ": " << (r.outcome == outcome_e::VERIFIED ? "ok\n" : r.message);
+    }
+    std::cout << "Logs replayed:     " << logs.size() << " (" << verified << " verified, " << unfinished
+              << " unfinished, " << failed << " failed)\n"
+              << "Lines replayed:    " << lines << "\n"
+              << "Lines per second:  " << (elapsed.count() > 0 ? lines / elapsed.count() : 0.0) << "\n"
+              << "Recorded time:     " << recorded << " s\n"
+              << "Elapsed:           " << elapsed.count() << " s\n";
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
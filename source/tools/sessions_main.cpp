@@ -0,0 +1,187 @@
+/**
+ * @file sessions_main.cpp
+ *
+ * @description
+ * Session load test: runs thousands of concurrent games on a few threads
+ * with the coroutine SessionScheduler. Every session is fed by a scripted
+ * player that answers each prompt after a "think time", the way a remote
+ * client would, so most sessions are idle at any moment; the report shows
+ * what an idle session costs (memory) and how fast the scheduler resumes
+ * the ready ones.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <sys/resource.h> // getrusage
+
+#include "../core/metrics.h"
+#include "../core/player.h"
+#include "../core/puzzle_feed.h"
+#include "../core/session_scheduler.h"
+#include "../core/sudoku_gm.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    /// Load test options read from the command line.
+    struct SessionsOptions {
+        vector<string> input_filenames;                //!< Puzzle files shared by every session, ../data/input.txt if none.
+        string strategy{ "human" };                    //!< Player strategy: random, solver or human.
+        size_t sessions = 1000;                        //!< # of concurrent sessions, one match each.
+        size_t threads = 0;                            //!< Worker threads, 0 for one per core.
+        size_t max_moves = 1000;                       //!< Move limit per match.
+        size_t think_ms = 0;                           //!< Mean delay before a player answers a prompt.
+        unsigned seed = 42;                            //!< Base seed, each session uses seed + session index.
+        size_t generators = 0;                         //!< Threads feeding every session new puzzles, 0 for none.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_sessions [-n <sessions>] [-t <threads>] [-s random|solver|human]\n"
+                  << "                       [-m <max_moves>] [--think <ms>] [--seed <num>]\n"
+                  << "                       [-g <threads>] [--help] <input_puzzle_file>...\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        return std::stoul(argv[++i]);
+    }
+
+    SessionsOptions read_cli_options( int argc, char **argv ) {
+        SessionsOptions opt;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "-n") opt.sessions = read_number(argc, argv, i);
+            else if (arg == "-t") opt.threads = read_number(argc, argv, i);
+            else if (arg == "-m") opt.max_moves = read_number(argc, argv, i);
+            else if (arg == "--think") opt.think_ms = read_number(argc, argv, i);
+            else if (arg == "-g") opt.generators = read_number(argc, argv, i);
+            else if (arg == "--seed") opt.seed = (unsigned) read_number(argc, argv, i);
+            else if (arg == "-s" and i + 1 < argc) opt.strategy = argv[++i];
+            else if (arg == "-h" or arg == "--help") usage();
+            else opt.input_filenames.push_back(arg);
+        }
+        if (opt.strategy != "random" and opt.strategy != "solver" and opt.strategy != "human") usage();
+        return opt;
+    }
+
+    std::unique_ptr<sdkg::Player> make_player( const SessionsOptions &opt, unsigned seed ) {
+        if (opt.strategy == "random") return std::make_unique<sdkg::RandomPlayer>(1, seed, opt.max_moves);
+        if (opt.strategy == "solver") return std::make_unique<sdkg::SolverPlayer>(1, seed, opt.max_moves);
+        return std::make_unique<sdkg::HumanLikePlayer>(1, seed, opt.max_moves);
+    }
+
+    /// A session and the player feeding it.
+    struct Client {
+        std::unique_ptr<sdkg::Session> session;
+        std::unique_ptr<sdkg::Player> player;
+        std::minstd_rand rng;               //!< Think time jitter.
+    };
+
+    /// Peak resident set size of the process, in KiB.
+    long peak_rss_kib() {
+        struct rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    SessionsOptions opt = read_cli_options(argc, argv);
+
+    // Games print their screens to cout, we are only interested in the summary (no need to color them).
+    std::streambuf *cout_buf = std::cout.rdbuf(nullptr);
+    Color::set_enabled(false);
+
+    // The puzzle file is read once; every session plays from the same boards and solutions.
+    string prog{ "sudoku" };
+    vector<char *> args{ &prog[0] };
+    for (const string &path : opt.input_filenames) args.push_back(const_cast<char *>(path.c_str()));
+    sdkg::SudokuGame prototype;
+    if (not prototype.initialize((int) args.size(), args.data())) {
+        std::cout.rdbuf(cout_buf);
+        std::cerr << "Could not load the puzzle files\n";
+        return EXIT_FAILURE;
+    }
+    long base_rss = peak_rss_kib();
+
+    // One feed for all the sessions, each takes its puzzle from it (or plays the first board if it is empty).
+    std::unique_ptr<sdkg::PuzzleFeed> feed;
+    if (opt.generators > 0) {
+        feed = std::make_unique<sdkg::PuzzleFeed>(prototype.board_manager().get_boards(), vector<uint32_t>{},
+                                                  (unsigned) opt.generators, opt.seed);
+    }
+
+    sdkg::SessionScheduler scheduler{ (unsigned) opt.threads };
+    vector<Client> clients(opt.sessions);
+    for (size_t s{0}; s < opt.sessions; s++) {
+        Client &client = clients[s];
+        client.session = std::make_unique<sdkg::Session>(scheduler);
+        client.player = make_player(opt, opt.seed + (unsigned) s);
+        client.rng.seed(opt.seed + (unsigned) s);
+        client.session->game().initialize((int) args.size(), args.data(), &prototype);
+        if (feed != nullptr) {
+            client.session->game().set_puzzle_source([&feed]( sdkg::ReadyPuzzle &puzzle ) {
+                return feed->try_take(puzzle);
+            });
+        }
+        client.session->on_waiting([&client, &scheduler, &opt]( sdkg::Session &session, sdkg::Player::prompt_e prompt ) {
+            // think time in [think/2, 3*think/2), so the sessions drift apart
+            std::chrono::milliseconds think{ opt.think_ms / 2 + (opt.think_ms ? client.rng() % opt.think_ms : 0) };
+            scheduler.call_after(think, [&client, &session, prompt]() {
+                session.post(client.player->answer(prompt, session.game().board_manager()));
+            });
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (Client &client : clients) scheduler.spawn(sdkg::run_session(*client.session));
+    size_t frame_bytes = sdkg::SessionTask::frame_bytes();
+    scheduler.run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout.rdbuf(cout_buf);
+
+    sdkg::Player::Stats total;
+    for (const Client &client : clients) {
+        const sdkg::Player::Stats &r = client.player->stats();
+        total.matches += r.matches;
+        total.wins += r.wins;
+        total.abandoned += r.abandoned;
+        total.moves += r.moves;
+    }
+    size_t n = std::max<size_t>(1, opt.sessions);
+    std::cout << "Sessions:          " << opt.sessions << " (" << scheduler.threads() << " threads, "
+              << opt.strategy << ", think " << opt.think_ms << " ms)\n"
+              << "Matches completed: " << total.matches << "\n"
+              << "Matches abandoned: " << total.abandoned << "\n"
+              << "Win rate:          " << (total.matches ? 100.0 * total.wins / total.matches : 0.0) << "%\n"
+              << "Moves per second:  " << (elapsed.count() > 0 ? total.moves / elapsed.count() : 0.0) << "\n"
+              << "Resumes:           " << scheduler.resumes() << "\n"
+              << "Session size:      " << sizeof(sdkg::Session) << " B + " << frame_bytes / n << " B frame\n"
+              << "Peak RSS:          " << peak_rss_kib() / 1024 << " MiB (" << base_rss / 1024
+              << " MiB before the sessions)\n"
+              << "Elapsed:           " << elapsed.count() << " s\n";
+    if (feed != nullptr) {
+        sdkg::PuzzleFeed::Stats fs = feed->stats();
+        std::cout << "Puzzle feed:       " << fs.served << " served, " << fs.misses << " misses, "
+                  << fs.stalls << " stalls, mean fill " << fs.mean_fill << "/" << sdkg::PuzzleFeed::CAPACITY << "\n";
+    }
+
+    sdkg::Metrics::Snapshot metrics = sdkg::Metrics::snapshot();
+    const LatencyHistogram::Snapshot &latency = metrics.histograms[sdkg::Metrics::COMMAND_LATENCY];
+    std::cout << "Command latency:   p50 <= " << latency.quantile(0.50) * 1e6 << " us, p99 <= "
+              << latency.quantile(0.99) * 1e6 << " us\n";
+
+    return EXIT_SUCCESS;
+}
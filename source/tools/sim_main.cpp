@@ -0,0 +1,153 @@
+/**
+ * @file sim_main.cpp
+ *
+ * @description
+ * Simulation driver: plays many Sudoku matches with scripted players, in
+ * parallel, through the regular game loop (menus, place/remove/undo/check
+ * commands and board checks), and reports win rates and throughput.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "../core/sudoku_gm.h"
+#include "../core/player.h"
+#include "../core/metrics.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    /// Simulation options read from the command line.
+    struct SimOptions {
+        vector<string> input_filenames;                //!< Puzzle files given to every game, ../data/input.txt if none.
+        string strategy{ "human" };                    //!< Player strategy: random, solver or human.
+        size_t matches = 100;                          //!< Total # of matches to play.
+        size_t threads = std::thread::hardware_concurrency();
+        size_t max_moves = 1000;                       //!< Move limit per match.
+        unsigned seed = 42;                            //!< Base seed, each thread uses seed + thread index.
+        string metrics_file;                           //!< Prometheus file written at the end, empty for none.
+        string record_dir;                             //!< Directory receiving a session log per game, empty for none.
+        string difficulty;                             //!< Level of the puzzles served, empty for every level.
+        string generators;                             //!< Puzzle generator threads of every game, empty for none.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_sim [-n <matches>] [-t <threads>] [-s random|solver|human] [-d <level>]\n"
+                  << "                  [-m <max_moves>] [--seed <num>] [--metrics-file <path>] [--record <dir>]\n"
+                  << "                  [-g <threads>] [--help] <input_puzzle_file>...\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        return std::stoul(argv[++i]);
+    }
+
+    SimOptions read_cli_options( int argc, char **argv ) {
+        SimOptions opt;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "-n") opt.matches = read_number(argc, argv, i);
+            else if (arg == "-t") opt.threads = read_number(argc, argv, i);
+            else if (arg == "-m") opt.max_moves = read_number(argc, argv, i);
+            else if (arg == "--seed") opt.seed = (unsigned) read_number(argc, argv, i);
+            else if (arg == "-s" and i + 1 < argc) opt.strategy = argv[++i];
+            else if (arg == "--metrics-file" and i + 1 < argc) opt.metrics_file = argv[++i];
+            else if (arg == "--record" and i + 1 < argc) opt.record_dir = argv[++i];
+            else if (arg == "-d" and i + 1 < argc) opt.difficulty = argv[++i];
+            else if (arg == "-g" and i + 1 < argc) opt.generators = argv[++i];
+            else if (arg == "-h" or arg == "--help") usage();
+            else opt.input_filenames.push_back(arg);
+        }
+        if (opt.threads == 0) opt.threads = 1;
+        if (opt.strategy != "random" and opt.strategy != "solver" and opt.strategy != "human") usage();
+        return opt;
+    }
+
+    std::unique_ptr<sdkg::Player> make_player( const SimOptions &opt, size_t matches, unsigned seed ) {
+        if (opt.strategy == "random") return std::make_unique<sdkg::RandomPlayer>(matches, seed, opt.max_moves);
+        if (opt.strategy == "solver") return std::make_unique<sdkg::SolverPlayer>(matches, seed, opt.max_moves);
+        return std::make_unique<sdkg::HumanLikePlayer>(matches, seed, opt.max_moves);
+    }
+
+    /// Runs one game instance until its player quits.
+    sdkg::Player::Stats run_game( const SimOptions &opt, size_t matches, unsigned seed ) {
+        std::unique_ptr<sdkg::Player> player = make_player(opt, matches, seed);
+        // screens are of no interest here, and a stream of its own keeps the game off the other threads' state
+        std::ostream discard{ nullptr };
+        sdkg::SudokuGame game;
+        game.set_player(player.get());
+        game.set_output(discard);
+
+        string prog{ "sudoku" }, record_opt{ "--record" }, level_opt{ "-d" }, level{ opt.difficulty };
+        string feed_opt{ "-g" }, generators{ opt.generators };
+        string record_file{ opt.record_dir + "/sim_" + std::to_string(seed) + ".sdkl" };
+        vector<char *> args{ &prog[0] };
+        for (const string &path : opt.input_filenames) args.push_back(const_cast<char *>(path.c_str()));
+        if (not opt.record_dir.empty()) args.insert(args.end(), { &record_opt[0], &record_file[0] });
+        if (not opt.difficulty.empty()) args.insert(args.end(), { &level_opt[0], &level[0] });
+        if (not opt.generators.empty()) args.insert(args.end(), { &feed_opt[0], &generators[0] });
+        if (not game.initialize((int) args.size(), args.data())) return player->stats();
+        while (not game.game_over()) {
+            game.process_events();
+            game.update();
+        }
+        return player->stats();
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    SimOptions opt = read_cli_options(argc, argv);
+    vector<sdkg::Player::Stats> results(opt.threads);
+    vector<std::thread> workers;
+
+    // Games discard their output, see run_game (no need to color it).
+    Color::set_enabled(false);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t{0}; t < opt.threads; t++) {
+        size_t matches = opt.matches / opt.threads + (t < opt.matches % opt.threads ? 1 : 0);
+        workers.emplace_back([&opt, &results, t, matches]() {
+            results[t] = run_game(opt, matches, opt.seed + (unsigned) t);
+        });
+    }
+    for (std::thread &worker : workers) worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    sdkg::Player::Stats total;
+    for (const sdkg::Player::Stats &r : results) {
+        total.matches += r.matches;
+        total.wins += r.wins;
+        total.abandoned += r.abandoned;
+        total.moves += r.moves;
+    }
+    size_t played = total.matches + total.abandoned;
+    std::cout << "Strategy:          " << opt.strategy << " (" << opt.threads << " threads)\n"
+              << "Matches completed: " << total.matches << "\n"
+              << "Matches abandoned: " << total.abandoned << "\n"
+              << "Win rate:          " << (total.matches ? 100.0 * total.wins / total.matches : 0.0) << "%\n"
+              << "Moves per match:   " << (played ? (double) total.moves / played : 0.0) << "\n"
+              << "Moves per second:  " << (elapsed.count() > 0 ? total.moves / elapsed.count() : 0.0) << "\n"
+              << "Elapsed:           " << elapsed.count() << " s\n";
+
+    sdkg::Metrics::Snapshot metrics = sdkg::Metrics::snapshot();
+    const LatencyHistogram::Snapshot &latency = metrics.histograms[sdkg::Metrics::COMMAND_LATENCY];
+    std::cout << "Command latency:   p50 <= " << latency.quantile(0.50) * 1e6 << " us, p99 <= "
+              << latency.quantile(0.99) * 1e6 << " us\n";
+    if (not opt.metrics_file.empty() and not sdkg::Metrics::export_file(opt.metrics_file)) {
+        std::cerr << "Could not write metrics file \"" << opt.metrics_file << "\"\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file stats_main.cpp
+ *
+ * @description
+ * Corpus analytics: streams puzzle files through worker threads and reports
+ * clue counts, digit frequencies, givens per unit, symmetry classes, solver
+ * effort and duplicate rates (see core/corpus_stats.h), as a summary and as
+ * CSV or JSON files.
+ *
+ * The main thread reads batches of boards into a fixed set of buffers; every
+ * worker counts the batches it takes into its own CorpusStats, and the stats
+ * of the workers are merged at the end. Memory use does not depend on the
+ * input size.
+ */
+
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+using std::string;
+#include <thread>
+#include <vector>
+using std::vector;
+
+#include "../core/board_io.h"
+#include "../core/corpus_stats.h"
+#include "../utils/is_numeric.h"
+#include "../utils/expand_paths.h"
+
+namespace {
+
+    constexpr size_t BATCH_SIZE{ 4096 };        //!< Boards read per batch.
+
+    /// Analytics options read from the command line.
+    struct StatsOptions {
+        vector<string> input_filenames;         //!< Files, directories and glob patterns, "-" for the standard input.
+        size_t threads = std::thread::hardware_concurrency();
+        bool solve = true;                      //!< Measure the solver effort (uniqueness check).
+        string csv_filename;                    //!< Empty for none.
+        string json_filename;                   //!< Empty for none.
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_stats [-t <threads>] [--no-solve] [--csv <path>] [--json <path>]\n"
+                  << "                    <input_puzzle_file | directory | pattern | -> ...\n"
+                  << "  Options:\n"
+                  << "    -t <num>        Worker threads. Default = # of cores.\n"
+                  << "    --no-solve      Skip the solver effort and uniqueness check (much faster).\n"
+                  << "    --csv <path>    Write every histogram as metric,key,value lines.\n"
+                  << "    --json <path>   Write every histogram as a JSON object.\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) {
+            std::cerr << "Option " << argv[i] << " expects a number.\n";
+            exit( EXIT_FAILURE );
+        }
+        return std::stoul(argv[++i]);
+    }
+
+    StatsOptions read_cli_options( int argc, char **argv ) {
+        StatsOptions opt;
+        for (int i{1}; i < argc; i++) {
+            string arg{ argv[i] };
+            if (arg == "-t") opt.threads = read_number(argc, argv, i);
+            else if (arg == "--no-solve") opt.solve = false;
+            else if (arg == "--csv" and i + 1 < argc) opt.csv_filename = argv[++i];
+            else if (arg == "--json" and i + 1 < argc) opt.json_filename = argv[++i];
+            else if (arg == "-h" or arg == "--help") usage();
+            else opt.input_filenames.push_back(arg);
+        }
+        if (opt.input_filenames.empty()) usage();
+        // "-" is no file, it stays where it is among the others
+        vector<string> files;
+        for (const string &path : opt.input_filenames) {
+            if (path == "-") files.push_back(path);
+            else for (string &file : sdkg::expand_paths({ path })) files.push_back(std::move(file));
+        }
+        opt.input_filenames = std::move(files);
+        if (opt.threads == 0) opt.threads = 1;
+        return opt;
+    }
+
+    /// Boards read together, handed to a worker.
+    struct Batch {
+        vector<sdkg::SBoard> boards;
+        size_t n_boards = 0;
+        size_t malformed = 0;
+    };
+
+    /// Fixed set of batches going from the reader to the workers and back.
+    class BatchQueue {
+        private:
+            vector<Batch> m_batches;
+            std::deque<Batch *> m_free;
+            std::deque<Batch *> m_ready;
+            std::mutex m_mutex;
+            std::condition_variable m_changed;
+            bool m_input_done = false;
+
+        public:
+            explicit BatchQueue( size_t n_batches ) : m_batches(n_batches) {
+                for (Batch &b : m_batches) {
+                    b.boards.resize(BATCH_SIZE);
+                    m_free.push_back(&b);
+                }
+            }
+
+            /// Reader: a batch to fill, waiting for the workers to give one back.
+            Batch & take_free() {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this]() { return not m_free.empty(); });
+                Batch *b = m_free.front();
+                m_free.pop_front();
+                return *b;
+            }
+
+            void push_ready( Batch &b ) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_ready.push_back(&b);
+                m_changed.notify_all();
+            }
+
+            void input_done() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_input_done = true;
+                m_changed.notify_all();
+            }
+
+            /// Workers: the next batch read, or nullptr once the input is over.
+            Batch * take_ready() {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this]() { return not m_ready.empty() or m_input_done; });
+                if (m_ready.empty()) return nullptr;
+                Batch *b = m_ready.front();
+                m_ready.pop_front();
+                return b;
+            }
+
+            void give_back( Batch &b ) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free.push_back(&b);
+                m_changed.notify_all();
+            }
+    };
+
+    /// Main thread: streams a whole input into the queue.
+    void read_input( std::istream &in, BatchQueue &queue ) {
+        bool more = true;
+        while (more) {
+            Batch &b = queue.take_free();
+            b.n_boards = b.malformed = 0;
+            while (b.n_boards < b.boards.size()) {
+                sdkg::read_status_e status = sdkg::try_read_board(in, b.boards[b.n_boards]);
+                if (status == sdkg::END_OF_INPUT) {
+                    more = false;
+                    break;
+                }
+                if (status == sdkg::BOARD_MALFORMED) b.malformed++;
+                else b.n_boards++;
+            }
+            queue.push_ready(b);
+        }
+    }
+
+    bool write_file( const string &path, const sdkg::CorpusStats &stats, bool json ) {
+        std::ofstream out{ path };
+        if (json) stats.write_json(out);
+        else stats.write_csv(out);
+        out.close();
+        if (out) return true;
+        std::cerr << "Could not write \"" << path << "\"\n";
+        return false;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    StatsOptions opt = read_cli_options(argc, argv);
+    BatchQueue queue{ 2 * opt.threads + 2 };
+    vector<std::unique_ptr<sdkg::CorpusStats>> parts;
+    vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t{0}; t < opt.threads; t++) {
+        parts.push_back(std::make_unique<sdkg::CorpusStats>(opt.solve));
+        workers.emplace_back([&queue, &part = *parts.back()]() {
+            while (Batch *b = queue.take_ready()) {
+                for (size_t k{0}; k < b->n_boards; k++) part.add(b->boards[k]);
+                for (size_t k{0}; k < b->malformed; k++) part.add_malformed();
+                queue.give_back(*b);
+            }
+        });
+    }
+    bool read_all = true;
+    for (const string &path : opt.input_filenames) {
+        if (path == "-") {
+            read_input(std::cin, queue);
+            continue;
+        }
+        std::ifstream in{ path };
+        if (not in) {
+            std::cerr << "Could not open \"" << path << "\"\n";
+            read_all = false;
+            continue;
+        }
+        read_input(in, queue);
+    }
+    queue.input_done();
+    for (std::thread &worker : workers) worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    sdkg::CorpusStats total{ opt.solve };
+    for (const auto &part : parts) total.merge(*part);
+
+    std::cout << "Boards:            " << total.boards() << " (" << total.malformed() << " malformed)\n"
+              << "Clues per board:   " << total.mean_clues() << " on average\n"
+              << "Duplicate rate:    " << 100 * total.duplicate_rate(false) << "% (" << 100 * total.duplicate_rate(true)
+              << "% up to digit relabeling)\n";
+    if (opt.solve) {
+        std::cout << "Solutions:         " << total.solutions(sdkg::CorpusStats::UNIQUE) << " unique, "
+                  << total.solutions(sdkg::CorpusStats::SEVERAL) << " several, "
+                  << total.solutions(sdkg::CorpusStats::NO_SOLUTION) << " none\n"
+                  << "Guesses per board: " << total.mean_guesses() << " on average, " << total.max_guesses() << " at most\n";
+    }
+    std::cout << "Boards per second: " << (elapsed.count() > 0 ? (double) total.boards() / elapsed.count() : 0.0)
+              << " (" << opt.threads << " threads)\n"
+              << "Elapsed:           " << elapsed.count() << " s\n";
+
+    bool written = true;
+    if (not opt.csv_filename.empty()) written = write_file(opt.csv_filename, total, false) and written;
+    if (not opt.json_filename.empty()) written = write_file(opt.json_filename, total, true) and written;
+    return read_all and written ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,354 @@
+/**
+ * @file stress_main.cpp
+ *
+ * @description
+ * Randomized property checks of the board logic, meant to run unattended for
+ * hours. Every iteration draws its own seed from the run seed and checks one
+ * property, round robin:
+ *  + solver: solutions are valid and keep the clues, and the backtracker and
+ *    the CP solver agree on the # of solutions (up to 2);
+ *  + text io: a board written and read back is unchanged;
+ *  + garbage: the parser and the file reader never throw on random text;
+ *  + transform: transformed solutions stay solved, transformed puzzles keep
+ *    their # of solutions;
+ *  + undo: through a real match, undoing a place or remove restores the exact
+ *    board the player had before, and the running location counts match it.
+ * A failure prints the iteration, which `--replay` runs again on its own.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib> // EXIT_SUCCESS
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <unistd.h> // getpid
+
+#include "../core/board_io.h"
+#include "../core/board_transform.h"
+#include "../core/cp_solver.h"
+#include "../core/player.h"
+#include "../core/sudoku_gm.h"
+#include "../core/sudoku_solver.h"
+#include "../utils/is_numeric.h"
+
+namespace {
+
+    namespace fs = std::filesystem;
+    using sdkg::SBoard;
+    using sdkg::SBoardManager;
+    constexpr short SIZE{ sdkg::Config::SB_SIZE };
+
+    /// Thrown by a property that does not hold.
+    struct PropertyFailure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    void check( bool ok, const string &what ) {
+        if (not ok) throw PropertyFailure(what);
+    }
+
+    bool same_board( const SBoard &a, const SBoard &b ) {
+        for (short i{0}; i < SIZE; i++) {
+            for (short j{0}; j < SIZE; j++) {
+                if (a.at(i, j) != b.at(i, j)) return false;
+            }
+        }
+        return true;
+    }
+
+    string scratch_path( const string &name ) {
+        return (fs::temp_directory_path() / ("sudoku_stress_" + std::to_string(::getpid()) + "_" + name)).string();
+    }
+
+    /// A random solved board: a transformed variant of a fixed solution.
+    SBoard random_solution( std::mt19937_64 &rng ) {
+        static const SBoard base = []() {
+            SBoard empty, solution;
+            sdkg::SudokuSolver(empty).solve(solution);
+            return solution;
+        }();
+        SBoard solution;
+        sdkg::BoardTransform::random(rng(), sdkg::BoardTransform::ALL).apply(base, solution);
+        return solution;
+    }
+
+    /// Keeps `clues` random locations of a solution as clues, the others are hidden (negative) or empty.
+    SBoard random_puzzle( std::mt19937_64 &rng, const SBoard &solution, short clues, bool hidden ) {
+        vector<short> cells(sdkg::BoardGeometry::N_CELLS);
+        for (short k{0}; k < (short) cells.size(); k++) cells[k] = k;
+        std::shuffle(cells.begin(), cells.end(), rng);
+        SBoard puzzle;
+        for (short k{0}; k < (short) cells.size(); k++) {
+            short line = sdkg::GEOMETRY.line[cells[k]], column = sdkg::GEOMETRY.column[cells[k]];
+            short digit = solution.at(line, column);
+            puzzle.set_loc(line, column, k < clues ? digit : (hidden ? (short) -digit : 0));
+        }
+        return puzzle;
+    }
+
+    short random_short( std::mt19937_64 &rng, short low, short high ) {
+        return std::uniform_int_distribution<short>(low, high)(rng);
+    }
+
+    //=== Properties.
+
+    void solver_property( std::mt19937_64 &rng ) {
+        SBoard solution = random_solution(rng);
+        SBoard puzzle = random_puzzle(rng, solution, random_short(rng, 22, 60), false);
+        bool broken = rng() % 4 == 0;
+        if (broken) {
+            // a clue changed to another digit: usually no solution, sometimes another one
+            short line = random_short(rng, 0, SIZE - 1), column = random_short(rng, 0, SIZE - 1);
+            puzzle.set_loc(line, column, (short) (1 + (std::abs(solution.at(line, column)) + random_short(rng, 0, 7)) % 9));
+        }
+
+        SBoard found;
+        bool solved = sdkg::SudokuSolver(puzzle).solve(found);
+        check(solved or broken, "the backtracker solves a puzzle cut from a solution");
+        if (solved) {
+            check(sdkg::is_solved(found, sdkg::ClassicRules{}), "the backtracker's solution is valid");
+            for (short i{0}; i < SIZE; i++) {
+                for (short j{0}; j < SIZE; j++) {
+                    if (puzzle.at(i, j) > 0) check(found.at(i, j) == puzzle.at(i, j), "the backtracker keeps the clues");
+                }
+            }
+        }
+        SBoard cp_found;
+        sdkg::CpSolver cp{ puzzle };
+        bool cp_solved = cp.solve(cp_found);
+        check(cp_solved == solved, "the CP solver and the backtracker agree on solvability");
+        if (cp_solved) check(sdkg::is_solved(cp_found, sdkg::ClassicRules{}), "the CP solver's solution is valid");
+
+        size_t count = sdkg::SudokuSolver(puzzle).count_solutions(2);
+        check(count == sdkg::CpSolver(puzzle).count_solutions(2), "both solvers count the same solutions");
+        check((count > 0) == solved, "a solvable puzzle has solutions");
+        if (count == 1 and not broken) check(same_board(found, solution), "a unique solution is the original one");
+    }
+
+    void io_property( std::mt19937_64 &rng ) {
+        SBoard sb;
+        for (short i{0}; i < SIZE; i++) {
+            for (short j{0}; j < SIZE; j++) sb.set_loc(i, j, random_short(rng, -9, 9));
+        }
+        char text[sdkg::MAX_BOARD_TEXT];
+        std::istringstream in{ string{ text, sdkg::format_board(sb, text) } + "\n\n" };
+        SBoard back;
+        check(sdkg::try_read_board(in, back) == sdkg::BOARD_READ, "a formatted board reads back");
+        check(same_board(sb, back), "a formatted board reads back unchanged");
+        check(sdkg::try_read_board(in, back) == sdkg::END_OF_INPUT, "nothing is read after the last board");
+
+        // the one-line format, digits only
+        string line;
+        for (short i{0}; i < SIZE; i++) {
+            for (short j{0}; j < SIZE; j++) line += std::abs(sb.at(i, j)) == 0 ? '.' : (char) ('0' + std::abs(sb.at(i, j)));
+        }
+        std::istringstream one{ line + "\n" };
+        check(sdkg::try_read_board(one, back) == sdkg::BOARD_READ, "a one-line board reads");
+        for (short i{0}; i < SIZE; i++) {
+            for (short j{0}; j < SIZE; j++) check(back.at(i, j) == std::abs(sb.at(i, j)), "a one-line board reads unchanged");
+        }
+    }
+
+    void garbage_property( std::mt19937_64 &rng ) {
+        // mostly the alphabet of the format, so the parser gets deep into boards before failing
+        static const string ALPHABET{ "0123456789-+. \t\r\n\n\n" };
+        string text;
+        auto length = (size_t) random_short(rng, 0, 2000);
+        for (size_t k{0}; k < length; k++) {
+            text += rng() % 16 == 0 ? (char) (rng() % 256) : ALPHABET[rng() % ALPHABET.size()];
+        }
+        try {
+            std::istringstream in{ text };
+            SBoard sb;
+            size_t reads = 0;
+            while (sdkg::try_read_board(in, sb) != sdkg::END_OF_INPUT) {
+                check(++reads <= length, "the parser always consumes input");
+            }
+
+            static const string path{ scratch_path("garbage.txt") };
+            std::ofstream{ path, std::ios::trunc } << text;
+            SBoardManager sbm;
+            sbm.read_input_file(path);
+        } catch (const PropertyFailure &) {
+            throw;
+        } catch (const std::exception &e) {
+            throw PropertyFailure(string{ "reading random text threw: " } + e.what());
+        }
+    }
+
+    void transform_property( std::mt19937_64 &rng ) {
+        SBoard solution = random_solution(rng);
+        SBoard puzzle = random_puzzle(rng, solution, random_short(rng, 22, 40), false);
+        sdkg::BoardTransform transform = sdkg::BoardTransform::random(rng(), sdkg::BoardTransform::ALL);
+        SBoard moved_solution, moved_puzzle;
+        transform.apply(solution, moved_solution);
+        transform.apply(puzzle, moved_puzzle);
+        check(sdkg::is_solved(moved_solution, sdkg::ClassicRules{}), "a transformed solution is solved");
+        check(sdkg::SudokuSolver(puzzle).count_solutions(2) == sdkg::SudokuSolver(moved_puzzle).count_solutions(2),
+              "a transformed puzzle keeps its # of solutions");
+    }
+
+    /// Plays random places and removes, undoing about half of them, and checks undo restores the board exactly.
+    class UndoCheckPlayer : public sdkg::Player {
+        private:
+            enum class phase_e { PLAY, VERIFY_PLAY, VERIFY_UNDO };
+            phase_e m_phase = phase_e::PLAY;
+            short m_codes[SIZE][SIZE]{};    //!< Raw board before the last play.
+            short m_line = 0, m_column = 0, m_digit = 0;
+            string m_failure;
+
+            void fail( const string &what ) {
+                if (m_failure.empty()) m_failure = what;
+            }
+
+        protected:
+            void on_new_match( const SBoardManager & ) override { m_phase = phase_e::PLAY; }
+
+            string next_move( const SBoardManager &sbm ) override {
+                if (m_phase == phase_e::VERIFY_PLAY) {
+                    std::pair<SBoardManager::loc_type_e, short> loc = sbm.decode_player_board_loc(m_line, m_column);
+                    if (m_digit != 0 and loc.second != m_digit) fail("a placed digit is on the board");
+                    if (m_digit == 0 and loc.first != SBoardManager::EMPTY) fail("a removed location is empty");
+                    if (m_rng() % 2 == 0) {
+                        m_phase = phase_e::VERIFY_UNDO;
+                        return "u";
+                    }
+                    m_phase = phase_e::PLAY;    // the play stays, later undos are checked on top of it
+                } else if (m_phase == phase_e::VERIFY_UNDO) {
+                    for (short i{0}; i < SIZE; i++) {
+                        for (short j{0}; j < SIZE; j++) {
+                            if (sbm.get_player_board_code(i, j) != m_codes[i][j]) fail("undo restores the exact board");
+                        }
+                    }
+                    m_phase = phase_e::PLAY;
+                }
+
+                short counts[5]{};
+                for (short i{0}; i < SIZE; i++) {
+                    for (short j{0}; j < SIZE; j++) {
+                        m_codes[i][j] = sbm.get_player_board_code(i, j);
+                        counts[sbm.decode_player_board_loc(i, j).first]++;
+                    }
+                }
+                for (SBoardManager::loc_type_e type : { SBoardManager::EMPTY, SBoardManager::ORIGINAL, SBoardManager::CORRECT,
+                                                        SBoardManager::INCORRECT, SBoardManager::INVALID }) {
+                    if (sbm.count_locs(type) != counts[type]) fail("the running location counts match the board");
+                }
+                do {
+                    m_line = (short) (m_rng() % SIZE);
+                    m_column = (short) (m_rng() % SIZE);
+                } while (sbm.decode_player_board_loc(m_line, m_column).first == SBoardManager::ORIGINAL);
+                m_phase = phase_e::VERIFY_PLAY;
+                if (sbm.decode_player_board_loc(m_line, m_column).first != SBoardManager::EMPTY and m_rng() % 3 == 0) {
+                    m_digit = 0;
+                    return remove_cmd(m_line, m_column);
+                }
+                m_digit = (short) (1 + m_rng() % 9);
+                return place_cmd(m_line, m_column, m_digit);
+            }
+
+        public:
+            UndoCheckPlayer( unsigned seed, size_t max_moves ) : Player(1, seed, max_moves) {/*empty*/}
+
+            inline const string & failure() const { return m_failure; }
+    };
+
+    void undo_property( std::mt19937_64 &rng ) {
+        SBoard solution = random_solution(rng);
+        SBoard puzzle = random_puzzle(rng, solution, random_short(rng, 25, 70), true);
+        static const string path{ scratch_path("match.txt") };
+        {
+            std::ofstream file{ path, std::ios::trunc };
+            sdkg::write_board(file, puzzle);
+        }
+
+        UndoCheckPlayer player{ (unsigned) rng(), (size_t) random_short(rng, 10, 300) };
+        std::streambuf *cout_buf = std::cout.rdbuf(nullptr);
+        sdkg::SudokuGame game;
+        game.set_player(&player);
+        string prog{ "sudoku" };
+        vector<char *> args{ &prog[0], const_cast<char *>(path.c_str()) };
+        bool started = game.initialize((int) args.size(), args.data());
+        while (started and not game.game_over()) {
+            game.process_events();
+            game.update();
+        }
+        std::cout.rdbuf(cout_buf);
+        check(started, "the game loads a valid puzzle file");
+        check(player.failure().empty(), player.failure());
+    }
+
+    struct Property {
+        const char *name;
+        void (*run)( std::mt19937_64 & );
+        size_t passed = 0;
+    };
+
+    void usage() {
+        std::cout << "Usage: sudoku_stress [--seconds <num>] [--seed <num>] [--replay <iteration>]\n"
+                  << "    --seconds <num>  Stop after <num> seconds, 0 runs until a failure. Default = 60.\n"
+                  << "    --seed <num>     Seed of the run, every iteration derives its own. Default = 1.\n"
+                  << "    --replay <num>   Run only the given iteration of the run (after a failure).\n";
+        exit( EXIT_SUCCESS );
+    }
+
+    size_t read_number( int argc, char **argv, int &i ) {
+        if (i + 1 >= argc or not is_numeric(argv[i + 1])) usage();
+        return std::stoul(argv[++i]);
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    size_t seconds = 60, seed = 1, replay = 0;
+    bool replaying = false;
+    for (int i{1}; i < argc; i++) {
+        string arg{ argv[i] };
+        if (arg == "--seconds") seconds = read_number(argc, argv, i);
+        else if (arg == "--seed") seed = read_number(argc, argv, i);
+        else if (arg == "--replay") { replay = read_number(argc, argv, i); replaying = true; }
+        else usage();
+    }
+
+    vector<Property> properties{
+        { "solver", solver_property }, { "text io", io_property }, { "garbage", garbage_property },
+        { "transform", transform_property }, { "undo", undo_property },
+    };
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    for (size_t iter{replaying ? replay : 0}; ; iter++) {
+        Property &property = properties[iter % properties.size()];
+        std::mt19937_64 rng{ sdkg::BoardTransform::variant_seed(seed, iter, 0) };
+        try {
+            property.run(rng);
+            property.passed++;
+        } catch (const std::exception &e) {
+            std::cerr << "Property \"" << property.name << "\" failed at iteration " << iter << ": " << e.what() << "\n"
+                      << "Run it again with: sudoku_stress --seed " << seed << " --replay " << iter << "\n";
+            return EXIT_FAILURE;
+        }
+        if (replaying) break;
+
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - start;
+        bool done = seconds != 0 and elapsed.count() >= (double) seconds;
+        if (done or now - last_report >= std::chrono::seconds(10)) {
+            std::cout << "[" << (size_t) elapsed.count() << " s] " << iter + 1 << " iterations:";
+            for (const Property &p : properties) std::cout << " " << p.name << " " << p.passed;
+            std::cout << std::endl;
+            last_report = now;
+        }
+        if (done) break;
+    }
+    std::cout << "All properties held.\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <glob.h>
+#include "expand_paths.h"
+
+namespace sdkg {
+
+    namespace {
+        namespace fs = std::filesystem;
+
+        bool is_pattern( const string &path ) {
+            return path.find_first_of("*?[") != string::npos;
+        }
+
+        /// Every regular file under a directory, sorted; unreadable subdirectories are skipped.
+        void list_directory( const string &path, vector<string> &files ) {
+            vector<string> found;
+            std::error_code error;
+            fs::recursive_directory_iterator it{ path, fs::directory_options::skip_permission_denied, error }, end;
+            for (; not error and it != end; it.increment(error)) {
+                if (it->is_regular_file(error)) found.push_back(it->path().string());
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        }
+    }
+
+    vector<string> expand_paths(const vector<string> &paths) {
+        vector<string> files;
+        for (const string &path : paths) {
+            std::error_code error;
+            if (fs::is_directory(path, error)) {
+                list_directory(path, files);
+            } else if (is_pattern(path)) {
+                glob_t matches{};
+                if (glob(path.c_str(), 0, nullptr, &matches) == 0) {
+                    // glob sorts the matches; a matching directory stands for the files under it
+                    for (size_t k{0}; k < matches.gl_pathc; k++) {
+                        string match{ matches.gl_pathv[k] };
+                        if (fs::is_directory(match, error)) list_directory(match, files);
+                        else files.push_back(std::move(match));
+                    }
+                } else {
+                    files.push_back(path);
+                }
+                globfree(&matches);
+            } else {
+                files.push_back(path);
+            }
+        }
+        return files;
+    }
+}
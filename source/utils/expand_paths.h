@@ -0,0 +1,21 @@
+#ifndef SUDOKUGAME_EXPAND_PATHS_H
+#define SUDOKUGAME_EXPAND_PATHS_H
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+
+namespace sdkg {
+    /// Expands command line paths into the files they name.
+    /*!
+     * A directory gives every regular file under it (recursively, sorted by path), a pattern with
+     * `*`, `?` or `[` gives the paths it matches (sorted, see glob(3)), anything else is kept as is.
+     * Paths matching nothing are kept as given too, so that opening them reports them.
+     * The order of the arguments is kept: the result only depends on them and on the files.
+     * @param paths Files, directories and glob patterns.
+     * @return The files, in a stable order.
+     */
+    vector<string> expand_paths( const vector<string> &paths );
+}
+
+#endif //SUDOKUGAME_EXPAND_PATHS_H